@@ -0,0 +1,92 @@
+/*The hash functions available to SymTable objects. SymHash_fast 
+follows the structure of the xxHash family: it folds the key in 8-byte 
+words through multiply/rotate rounds, and finishes with an avalanche 
+step so that the low bits of the code, which a power-of-two table 
+uses, are as well mixed as the high ones.*/
+
+#include <assert.h>
+#include <string.h>
+#include "symhash.h"
+
+/*The 64-bit primes of xxHash64*/
+static const unsigned long long PRIME1 = 0x9E3779B185EBCA87ULL;
+static const unsigned long long PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const unsigned long long PRIME3 = 0x165667B19E3779F9ULL;
+static const unsigned long long PRIME4 = 0x85EBCA77C2B2AE63ULL;
+
+/*--------------------------------------------------------------------*/
+
+/* Return ullValue, which is assumed to be 64 bits wide, rotated left
+   by iCount bits, where 0 < iCount < 64. */
+static unsigned long long SymHash_rotate(unsigned long long ullValue,
+   int iCount)
+{
+   return (ullValue << iCount) | (ullValue >> (64 - iCount));
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_fast(const char *pcKey, size_t uLength)
+{
+   unsigned long long ullHash;
+   unsigned long long ullWord;
+   const unsigned char *pucNext = (const unsigned char*)pcKey;
+   size_t uRemaining = uLength;
+   size_t u;
+
+   assert(pcKey != NULL);
+
+   ullHash = PRIME4 + (unsigned long long)uLength * PRIME1;
+
+   /* memcpy makes the unaligned loads portable; compilers turn each
+   one into a single load instruction. */
+   while (uRemaining >= 8) {
+      memcpy(&ullWord, pucNext, 8);
+      ullWord *= PRIME2;
+      ullWord = SymHash_rotate(ullWord, 31) * PRIME1;
+      ullHash ^= ullWord;
+      ullHash = SymHash_rotate(ullHash, 27) * PRIME1 + PRIME4;
+      pucNext += 8;
+      uRemaining -= 8;
+   }
+
+   if (uRemaining > 0) {
+      ullWord = 0;
+      for (u = 0; u < uRemaining; u++)
+         ullWord |= (unsigned long long)pucNext[u] << (8 * u);
+      ullWord *= PRIME3;
+      ullHash ^= SymHash_rotate(ullWord, 31) * PRIME1;
+      ullHash = SymHash_rotate(ullHash, 23) * PRIME2 + PRIME3;
+   }
+
+   return SymHash_word(ullHash);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_compat(const char *pcKey, size_t uLength)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; u < uLength; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_word(unsigned long long ullWord)
+{
+   ullWord ^= ullWord >> 33;
+   ullWord *= PRIME2;
+   ullWord ^= ullWord >> 29;
+   ullWord *= PRIME3;
+   ullWord ^= ullWord >> 32;
+
+   return (size_t)ullWord;
+}
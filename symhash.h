@@ -0,0 +1,30 @@
+/*A hash function maps a key to a size_t hash code, so that a hash 
+table can pick a bucket for the key. These are the hash functions that
+a SymTable can be created with (see SymTable_newWithHash). Each takes 
+the key pcKey and its length uLength, not counting the terminating 
+'\0', and must return the same code for equal keys.*/
+
+#include <stddef.h>
+
+#ifndef SYMHASH_INCLUDED
+#define SYMHASH_INCLUDED
+
+/*SymHash_fast returns a hash code for the uLength characters at pcKey,
+consuming 8 bytes per step and mixing the result so that all bits of 
+the code depend on every byte of the key. It is the default hash 
+function of a SymTable.*/
+size_t SymHash_fast(const char *pcKey, size_t uLength);
+
+/*SymHash_compat returns the hash code of the assignment specification
+for the uLength characters at pcKey: a byte-at-a-time multiplicative 
+hash with multiplier 65599.*/
+size_t SymHash_compat(const char *pcKey, size_t uLength);
+
+/*SymHash_word returns a hash code for the integer ullWord, for tables
+whose keys are integers or addresses rather than strings (see
+symtableint.h and symtableptr.h). It is the final avalanche step of
+SymHash_fast, so every bit of the code depends on every bit of
+ullWord.*/
+size_t SymHash_word(unsigned long long ullWord);
+
+#endif
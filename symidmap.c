@@ -0,0 +1,181 @@
+/*A SymIdMap stores the value of ID i in slot i of an array that grows
+to fit the largest ID put.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include "symidmap.h"
+
+/*The number of slots of the first array that a SymIdMap allocates*/
+enum {INITIAL_SLOT_COUNT = 16};
+
+/*The value of every slot without a binding. Values are client
+pointers, none of which can equal the address of cAbsent*/
+static char cAbsent;
+static void *const pvAbsent = &cAbsent;
+
+/* A SymIdMap is an array of values indexed by ID. */
+struct SymIdMap
+{
+   /*The value of each ID below numSlots, or pvAbsent*/
+   void **ppvValues;
+
+   /*The number of slots in ppvValues, 0 or a power of two*/
+   size_t numSlots;
+
+   /*The number of bindings within the map*/
+   size_t bindingCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymIdMap_T SymIdMap_new(void)
+{
+   SymIdMap_T oSymIdMap;
+
+   oSymIdMap = (SymIdMap_T)malloc(sizeof(struct SymIdMap));
+   if (oSymIdMap == NULL) return NULL;
+
+   oSymIdMap->ppvValues = NULL;
+   oSymIdMap->numSlots = 0;
+   oSymIdMap->bindingCount = 0;
+   return oSymIdMap;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymIdMap_free(SymIdMap_T oSymIdMap)
+{
+   assert(oSymIdMap != NULL);
+
+   free(oSymIdMap->ppvValues);
+   free(oSymIdMap);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIdMap_getLength(SymIdMap_T oSymIdMap)
+{
+   assert(oSymIdMap != NULL);
+
+   return oSymIdMap->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Grow the array of oSymIdMap to have a slot for uId. Return 1 (TRUE)
+   on success, or 0 (FALSE) if insufficient memory is available. */
+static int SymIdMap_reserve(SymIdMap_T oSymIdMap, size_t uId)
+{
+   void **ppvNewValues;
+   size_t uNewCount;
+   size_t uSlot;
+
+   assert(oSymIdMap != NULL);
+
+   uNewCount = oSymIdMap->numSlots;
+   if (uNewCount == 0) uNewCount = INITIAL_SLOT_COUNT;
+   while (uNewCount <= uId) {
+      if (uNewCount > ((size_t)-1 / 2) / sizeof(void*)) return 0;
+      uNewCount *= 2;
+   }
+
+   ppvNewValues = (void**)realloc(oSymIdMap->ppvValues,
+      uNewCount * sizeof(void*));
+   if (ppvNewValues == NULL) return 0;
+
+   for (uSlot = oSymIdMap->numSlots; uSlot < uNewCount; uSlot++)
+      ppvNewValues[uSlot] = pvAbsent;
+   oSymIdMap->ppvValues = ppvNewValues;
+   oSymIdMap->numSlots = uNewCount;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymIdMap_put(SymIdMap_T oSymIdMap, size_t uId, const void *pvValue)
+{
+   assert(oSymIdMap != NULL);
+
+   if (uId >= oSymIdMap->numSlots && !SymIdMap_reserve(oSymIdMap, uId))
+      return 0;
+   if (oSymIdMap->ppvValues[uId] != pvAbsent) return 0;
+
+   oSymIdMap->ppvValues[uId] = (void*)pvValue;
+   oSymIdMap->bindingCount++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_replace(SymIdMap_T oSymIdMap, size_t uId,
+     const void *pvValue)
+{
+   void *oldVal;
+
+   assert(oSymIdMap != NULL);
+
+   if (uId >= oSymIdMap->numSlots) return NULL;
+   oldVal = oSymIdMap->ppvValues[uId];
+   if (oldVal == pvAbsent) return NULL;
+
+   oSymIdMap->ppvValues[uId] = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymIdMap_contains(SymIdMap_T oSymIdMap, size_t uId)
+{
+   assert(oSymIdMap != NULL);
+
+   return uId < oSymIdMap->numSlots
+      && oSymIdMap->ppvValues[uId] != pvAbsent;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_get(SymIdMap_T oSymIdMap, size_t uId)
+{
+   void *pvValue;
+
+   assert(oSymIdMap != NULL);
+
+   if (uId >= oSymIdMap->numSlots) return NULL;
+   pvValue = oSymIdMap->ppvValues[uId];
+   return pvValue == pvAbsent ? NULL : pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_remove(SymIdMap_T oSymIdMap, size_t uId)
+{
+   void *oldVal;
+
+   assert(oSymIdMap != NULL);
+
+   if (uId >= oSymIdMap->numSlots) return NULL;
+   oldVal = oSymIdMap->ppvValues[uId];
+   if (oldVal == pvAbsent) return NULL;
+
+   oSymIdMap->ppvValues[uId] = pvAbsent;
+   oSymIdMap->bindingCount--;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymIdMap_map(SymIdMap_T oSymIdMap,
+     void (*pfApply)(size_t uId, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   size_t uSlot;
+
+   assert(oSymIdMap != NULL);
+   assert(pfApply != NULL);
+
+   for (uSlot = 0; uSlot < oSymIdMap->numSlots; uSlot++) {
+      if (oSymIdMap->ppvValues[uSlot] != pvAbsent)
+         (*pfApply)(uSlot, oSymIdMap->ppvValues[uSlot],
+            (void*)pvExtra);
+   }
+}
@@ -0,0 +1,57 @@
+/*A SymIdMap is a collection of bindings whose keys are IDs: small
+integers such as those that a SymIntern gives strings (see
+symintern.h). It keeps the values in an array indexed by ID, so that
+finding a binding is a single array access and never compares keys.
+Its memory grows with the largest ID put, so the IDs should be dense. A
+table keyed by the identity of canonical copies uses their IDs, from
+SymIntern_id, as its keys.*/
+
+#include <stddef.h>
+
+#ifndef SYMIDMAP_INCLUDED
+#define SYMIDMAP_INCLUDED
+
+/* A SymIdMap_T is a pointer to a SymIdMap ADT*/
+typedef struct SymIdMap *SymIdMap_T;
+
+/*SymIdMap_new returns a new SymIdMap object that contains no bindings,
+or NULL if insufficient memory is available.*/
+SymIdMap_T SymIdMap_new(void);
+
+/*SymIdMap_free frees all memory occupied by oSymIdMap.*/
+void SymIdMap_free(SymIdMap_T oSymIdMap);
+
+/*SymIdMap_getLength returns the number of bindings in oSymIdMap.*/
+size_t SymIdMap_getLength(SymIdMap_T oSymIdMap);
+
+/*If oSymIdMap does not contain a binding with ID uId, then
+SymIdMap_put adds a binding consisting of uId and pvValue and returns
+1 (TRUE). Otherwise, or if insufficient memory is available, it leaves
+oSymIdMap unchanged and returns 0 (FALSE).*/
+int SymIdMap_put(SymIdMap_T oSymIdMap, size_t uId, const void *pvValue);
+
+/*SymIdMap_replace replaces the value of the binding of oSymIdMap with
+ID uId by pvValue and returns the old value, or returns NULL if there
+is no such binding.*/
+void *SymIdMap_replace(SymIdMap_T oSymIdMap, size_t uId,
+     const void *pvValue);
+
+/*SymIdMap_contains returns 1 (TRUE) if oSymIdMap contains a binding
+with ID uId, and 0 (FALSE) if not.*/
+int SymIdMap_contains(SymIdMap_T oSymIdMap, size_t uId);
+
+/*SymIdMap_get returns the value of the binding of oSymIdMap with ID
+uId, or NULL if there is none.*/
+void *SymIdMap_get(SymIdMap_T oSymIdMap, size_t uId);
+
+/*SymIdMap_remove removes the binding of oSymIdMap with ID uId and
+returns its value, or returns NULL if there is none.*/
+void *SymIdMap_remove(SymIdMap_T oSymIdMap, size_t uId);
+
+/*SymIdMap_map calls (*pfApply)(uId, pvValue, pvExtra) for each
+uId/pvValue binding of oSymIdMap, in increasing order of ID.*/
+void SymIdMap_map(SymIdMap_T oSymIdMap,
+     void (*pfApply)(size_t uId, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+#endif
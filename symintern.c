@@ -0,0 +1,264 @@
+/*A SymIntern keeps one canonical copy of each distinct string in large
+blocks of its own, and finds the copy of a string with a hash table
+SymTable that borrows the copies as its keys (see
+SymTable_putBorrowed), so that no string is stored twice.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symintern.h"
+
+/*The first block of canonical copies holds MIN_BLOCK_SIZE bytes; each
+later block is twice as large as the one before, up to MAX_BLOCK_SIZE
+bytes. A copy too large for the next block gets a block of its own*/
+enum {MIN_BLOCK_SIZE = 1024, MAX_BLOCK_SIZE = 65536};
+
+/*The number of IDs that a new SymIntern has room for*/
+enum {INITIAL_ID_COUNT = 64};
+
+/* A SymInternBlock holds canonical copies. Each copy is preceded by
+its ID and takes a multiple of sizeof(size_t) bytes, so that the IDs
+stay aligned. */
+struct SymInternBlock
+{
+   /*The block allocated before this one*/
+   struct SymInternBlock *psNextBlock;
+
+   /*The number of bytes in acBytes*/
+   size_t uSize;
+
+   /*The IDs and copies*/
+   char acBytes[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymIntern pairs a table from each string to its canonical copy
+with an array from each ID to its canonical copy. */
+struct SymIntern
+{
+   /*The table whose keys are the canonical copies, each borrowed, and
+   whose values are the same copies*/
+   SymTable_T oTable;
+
+   /*The blocks of canonical copies, the one being filled first*/
+   struct SymInternBlock *psBlocks;
+
+   /*The number of bytes of psBlocks already handed out*/
+   size_t uBlockUsed;
+
+   /*The canonical copy of each ID below uCount*/
+   const char **ppcStrings;
+
+   /*The number of distinct strings, and the length of ppcStrings*/
+   size_t uCount;
+   size_t uCapacity;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymIntern_T SymIntern_new(void)
+{
+   SymIntern_T oSymIntern;
+
+   oSymIntern = (SymIntern_T)malloc(sizeof(struct SymIntern));
+   if (oSymIntern == NULL) return NULL;
+
+   oSymIntern->oTable = SymTable_new();
+   oSymIntern->ppcStrings = (const char**)
+      malloc(INITIAL_ID_COUNT * sizeof(const char*));
+   if (oSymIntern->oTable == NULL || oSymIntern->ppcStrings == NULL) {
+      if (oSymIntern->oTable != NULL)
+         SymTable_free(oSymIntern->oTable);
+      free(oSymIntern->ppcStrings);
+      free(oSymIntern);
+      return NULL;
+   }
+
+   oSymIntern->psBlocks = NULL;
+   oSymIntern->uBlockUsed = 0;
+   oSymIntern->uCount = 0;
+   oSymIntern->uCapacity = INITIAL_ID_COUNT;
+   return oSymIntern;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymIntern_free(SymIntern_T oSymIntern)
+{
+   struct SymInternBlock *psBlock;
+   struct SymInternBlock *psNextBlock;
+
+   assert(oSymIntern != NULL);
+
+   /* The table borrows its keys from the blocks, so free it first. */
+   SymTable_free(oSymIntern->oTable);
+
+   for (psBlock = oSymIntern->psBlocks; psBlock != NULL;
+        psBlock = psNextBlock) {
+      psNextBlock = psBlock->psNextBlock;
+      free(psBlock);
+   }
+
+   free(oSymIntern->ppcStrings);
+   free(oSymIntern);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIntern_getLength(SymIntern_T oSymIntern)
+{
+   assert(oSymIntern != NULL);
+
+   return oSymIntern->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return uSize bytes from the blocks of oSymIntern, where uSize is a
+   multiple of sizeof(size_t), or NULL if insufficient memory is
+   available. */
+static char *SymIntern_alloc(SymIntern_T oSymIntern, size_t uSize)
+{
+   struct SymInternBlock *psBlock;
+   size_t uBlockSize;
+
+   assert(oSymIntern != NULL);
+
+   if (oSymIntern->psBlocks != NULL
+       && oSymIntern->uBlockUsed + uSize
+            <= oSymIntern->psBlocks->uSize) {
+      oSymIntern->uBlockUsed += uSize;
+      return oSymIntern->psBlocks->acBytes
+         + (oSymIntern->uBlockUsed - uSize);
+   }
+
+   uBlockSize = MIN_BLOCK_SIZE;
+   if (oSymIntern->psBlocks != NULL) {
+      uBlockSize = 2 * oSymIntern->psBlocks->uSize;
+      if (uBlockSize > MAX_BLOCK_SIZE)
+         uBlockSize = MAX_BLOCK_SIZE;
+   }
+
+   /* A copy too large for the next block gets a block of its own,
+   behind the one being filled, which keeps its free space. */
+   if (uSize > uBlockSize) {
+      psBlock = (struct SymInternBlock*)
+         malloc(sizeof(struct SymInternBlock) + uSize);
+      if (psBlock == NULL) return NULL;
+      psBlock->uSize = uSize;
+      if (oSymIntern->psBlocks == NULL) {
+         psBlock->psNextBlock = NULL;
+         oSymIntern->psBlocks = psBlock;
+         oSymIntern->uBlockUsed = uSize;
+      }
+      else {
+         psBlock->psNextBlock = oSymIntern->psBlocks->psNextBlock;
+         oSymIntern->psBlocks->psNextBlock = psBlock;
+      }
+      return psBlock->acBytes;
+   }
+
+   psBlock = (struct SymInternBlock*)
+      malloc(sizeof(struct SymInternBlock) + uBlockSize);
+   if (psBlock == NULL) return NULL;
+   psBlock->uSize = uBlockSize;
+   psBlock->psNextBlock = oSymIntern->psBlocks;
+   oSymIntern->psBlocks = psBlock;
+   oSymIntern->uBlockUsed = uSize;
+   return psBlock->acBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *SymIntern_internN(SymIntern_T oSymIntern,
+     const char *pcString, size_t uLength)
+{
+   const char *pcCanonical;
+   const char **ppcNewStrings;
+   size_t uSize;
+   char *pcCopy;
+
+   assert(oSymIntern != NULL);
+   assert(pcString != NULL);
+
+   pcCanonical = (const char*)
+      SymTable_getN(oSymIntern->oTable, pcString, uLength);
+   if (pcCanonical != NULL) return pcCanonical;
+
+   if (oSymIntern->uCount == oSymIntern->uCapacity) {
+      ppcNewStrings = (const char**)realloc(oSymIntern->ppcStrings,
+         2 * oSymIntern->uCapacity * sizeof(const char*));
+      if (ppcNewStrings == NULL) return NULL;
+      oSymIntern->ppcStrings = ppcNewStrings;
+      oSymIntern->uCapacity *= 2;
+   }
+
+   uSize = sizeof(size_t) + uLength + 1;
+   uSize = (uSize + sizeof(size_t) - 1) / sizeof(size_t)
+      * sizeof(size_t);
+   pcCopy = SymIntern_alloc(oSymIntern, uSize);
+   if (pcCopy == NULL) return NULL;
+
+   memcpy(pcCopy, &oSymIntern->uCount, sizeof(size_t));
+   pcCopy += sizeof(size_t);
+   memcpy(pcCopy, pcString, uLength);
+   pcCopy[uLength] = '\0';
+
+   /* If the table runs out of memory, the copy's bytes go unused
+   until oSymIntern is freed. */
+   if (!SymTable_putBorrowed(oSymIntern->oTable, pcCopy, pcCopy))
+      return NULL;
+
+   oSymIntern->ppcStrings[oSymIntern->uCount] = pcCopy;
+   oSymIntern->uCount++;
+   return pcCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *SymIntern_intern(SymIntern_T oSymIntern,
+     const char *pcString)
+{
+   assert(pcString != NULL);
+
+   return SymIntern_internN(oSymIntern, pcString, strlen(pcString));
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *SymIntern_lookup(SymIntern_T oSymIntern,
+     const char *pcString)
+{
+   assert(oSymIntern != NULL);
+   assert(pcString != NULL);
+
+   return (const char*)SymTable_get(oSymIntern->oTable, pcString);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIntern_id(SymIntern_T oSymIntern, const char *pcCanonical)
+{
+   size_t uId;
+
+   assert(oSymIntern != NULL);
+   assert(pcCanonical != NULL);
+
+   memcpy(&uId, pcCanonical - sizeof(size_t), sizeof(size_t));
+   assert(uId < oSymIntern->uCount);
+   assert(oSymIntern->ppcStrings[uId] == pcCanonical);
+   (void)oSymIntern;
+   return uId;
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *SymIntern_string(SymIntern_T oSymIntern, size_t uId)
+{
+   assert(oSymIntern != NULL);
+
+   if (uId >= oSymIntern->uCount) return NULL;
+   return oSymIntern->ppcStrings[uId];
+}
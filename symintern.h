@@ -0,0 +1,59 @@
+/*A SymIntern is a set of interned strings. Interning a string returns
+the canonical copy of it, which is the same pointer for every string
+with the same characters, and a compact ID: the number of distinct
+strings interned before it. Components that share a SymIntern can
+therefore keep each identifier once, compare identifiers by pointer
+or ID instead of with strcmp, and key their own tables by ID (see
+symidmap.h). Canonical copies and IDs stay valid until the SymIntern
+is freed.*/
+
+#include <stddef.h>
+
+#ifndef SYMINTERN_INCLUDED
+#define SYMINTERN_INCLUDED
+
+/* A SymIntern_T is a pointer to a SymIntern ADT*/
+typedef struct SymIntern *SymIntern_T;
+
+/*SYMINTERN_NONE is the ID of no string.*/
+#define SYMINTERN_NONE ((size_t)-1)
+
+/*SymIntern_new returns a new SymIntern object that contains no
+strings, or NULL if insufficient memory is available.*/
+SymIntern_T SymIntern_new(void);
+
+/*SymIntern_free frees all memory occupied by oSymIntern, including
+every canonical copy that it returned.*/
+void SymIntern_free(SymIntern_T oSymIntern);
+
+/*SymIntern_getLength returns the number of distinct strings in
+oSymIntern, which is also the first ID not yet used.*/
+size_t SymIntern_getLength(SymIntern_T oSymIntern);
+
+/*SymIntern_intern returns the canonical copy of pcString in
+oSymIntern, first adding one if pcString was never interned. It
+returns NULL if insufficient memory is available.*/
+const char *SymIntern_intern(SymIntern_T oSymIntern,
+     const char *pcString);
+
+/*SymIntern_internN is SymIntern_intern for the string of the uLength
+characters at pcString, which need not be followed by '\0' and must
+not contain it. The canonical copy is followed by '\0'.*/
+const char *SymIntern_internN(SymIntern_T oSymIntern,
+     const char *pcString, size_t uLength);
+
+/*SymIntern_lookup returns the canonical copy of pcString in
+oSymIntern, or NULL if pcString was never interned. It adds nothing.*/
+const char *SymIntern_lookup(SymIntern_T oSymIntern,
+     const char *pcString);
+
+/*SymIntern_id returns the ID of pcCanonical, which must be a canonical
+copy that oSymIntern returned. It reads the ID stored beside the copy,
+so it costs no lookup.*/
+size_t SymIntern_id(SymIntern_T oSymIntern, const char *pcCanonical);
+
+/*SymIntern_string returns the canonical copy whose ID is uId, or NULL
+if no string of oSymIntern has that ID.*/
+const char *SymIntern_string(SymIntern_T oSymIntern, size_t uId);
+
+#endif
@@ -0,0 +1,204 @@
+/*The helpers shared by the parallel functions of every SymTable
+implementation.*/
+
+/* Request POSIX declarations, for threads. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "symparallel.h"
+
+/* A SymParallelThread runs one part of a SymParallel_run call. */
+struct SymParallelThread
+{
+   /*The thread running the part*/
+   pthread_t sThread;
+
+   /*1 if sThread was created, 0 if the part is left to the caller*/
+   int iStarted;
+
+   /*The work of the call, and the part of it to do*/
+   void (*pfWork)(void *pvArg, int iPart);
+   void *pvArg;
+   int iPart;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Run the part that pvThread, a SymParallelThread, describes. */
+static void *SymParallel_runThread(void *pvThread)
+{
+   struct SymParallelThread *psThread =
+      (struct SymParallelThread*)pvThread;
+
+   assert(psThread != NULL);
+
+   (*psThread->pfWork)(psThread->pvArg, psThread->iPart);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A SymParallelMapJob is a call of SymParallel_map or
+SymParallel_mapEach. */
+struct SymParallelMapJob
+{
+   /*The table being mapped*/
+   void *pvTable;
+
+   /*The function that applies pfApply to the bindings of a part*/
+   void (*pfPart)(void *pvTable, int iPart, int iPartCount,
+      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+      void *pvExtra);
+
+   /*The function applied to each binding*/
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+
+   /*The extra parameter of each part, or NULL if every part passes
+   pvExtra*/
+   void *const *ppvExtras;
+   void *pvExtra;
+
+   /*The number of parts*/
+   int iPartCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+void SymParallel_run(int iPartCount,
+     void (*pfWork)(void *pvArg, int iPart), void *pvArg)
+{
+   struct SymParallelThread *psThreads;
+   int iPart;
+
+   assert(iPartCount > 0);
+   assert(pfWork != NULL);
+
+   /* Without memory for the threads, every part runs here. */
+   psThreads = NULL;
+   if (iPartCount > 1)
+      psThreads = (struct SymParallelThread*)
+         malloc((size_t)(iPartCount - 1)
+            * sizeof(struct SymParallelThread));
+
+   for (iPart = 1; psThreads != NULL && iPart < iPartCount; iPart++) {
+      psThreads[iPart - 1].pfWork = pfWork;
+      psThreads[iPart - 1].pvArg = pvArg;
+      psThreads[iPart - 1].iPart = iPart;
+      psThreads[iPart - 1].iStarted =
+         pthread_create(&psThreads[iPart - 1].sThread, NULL,
+            SymParallel_runThread, &psThreads[iPart - 1]) == 0;
+   }
+
+   (*pfWork)(pvArg, 0);
+
+   for (iPart = 1; iPart < iPartCount; iPart++) {
+      if (psThreads == NULL || !psThreads[iPart - 1].iStarted)
+         (*pfWork)(pvArg, iPart);
+   }
+   for (iPart = 1; psThreads != NULL && iPart < iPartCount; iPart++) {
+      if (psThreads[iPart - 1].iStarted)
+         pthread_join(psThreads[iPart - 1].sThread, NULL);
+   }
+
+   free(psThreads);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymParallel_first(size_t uCount, int iPart, int iPartCount)
+{
+   size_t uPart = (size_t)iPart;
+   size_t uPartCount = (size_t)iPartCount;
+   size_t uRemainder;
+
+   assert(iPart >= 0);
+   assert(iPartCount > 0);
+   assert(iPart <= iPartCount);
+
+   /* The first uCount % iPartCount parts get one extra item each. */
+   uRemainder = uCount % uPartCount;
+   return uCount / uPartCount * uPart
+      + (uPart < uRemainder ? uPart : uRemainder);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run part iPart of pvJob, a SymParallelMapJob. */
+static void SymParallel_mapPart(void *pvJob, int iPart)
+{
+   struct SymParallelMapJob *psJob = (struct SymParallelMapJob*)pvJob;
+
+   assert(psJob != NULL);
+
+   (*psJob->pfPart)(psJob->pvTable, iPart, psJob->iPartCount,
+      psJob->pfApply, psJob->ppvExtras != NULL
+         ? psJob->ppvExtras[iPart] : psJob->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymParallel_map(void *pvTable,
+     void (*pfPart)(void *pvTable, int iPart, int iPartCount,
+          void (*pfApply)(const char *pcKey, void *pvValue,
+               void *pvExtra),
+          void *pvExtra),
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iPartCount)
+{
+   struct SymParallelMapJob sJob;
+
+   assert(pfPart != NULL);
+   assert(pfApply != NULL);
+   assert(iPartCount > 0);
+
+   sJob.pvTable = pvTable;
+   sJob.pfPart = pfPart;
+   sJob.pfApply = pfApply;
+   sJob.ppvExtras = NULL;
+   sJob.pvExtra = (void*)pvExtra;
+   sJob.iPartCount = iPartCount;
+   SymParallel_run(iPartCount, SymParallel_mapPart, &sJob);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymParallel_mapEach(void *pvTable,
+     void (*pfPart)(void *pvTable, int iPart, int iPartCount,
+          void (*pfApply)(const char *pcKey, void *pvValue,
+               void *pvExtra),
+          void *pvExtra),
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     void *const apvExtras[], int iPartCount)
+{
+   struct SymParallelMapJob sJob;
+
+   assert(pfPart != NULL);
+   assert(pfApply != NULL);
+   assert(apvExtras != NULL);
+   assert(iPartCount > 0);
+
+   sJob.pvTable = pvTable;
+   sJob.pfPart = pfPart;
+   sJob.pfApply = pfApply;
+   sJob.ppvExtras = apvExtras;
+   sJob.pvExtra = NULL;
+   sJob.iPartCount = iPartCount;
+   SymParallel_run(iPartCount, SymParallel_mapPart, &sJob);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymParallel_merge(void (*pfMerge)(void *pvAccumulator,
+          void *pvOther),
+     void *const apvAccumulators[], int iCount)
+{
+   int i;
+
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+
+   for (i = 1; i < iCount; i++)
+      (*pfMerge)(apvAccumulators[0], apvAccumulators[i]);
+}
@@ -0,0 +1,58 @@
+/*The parallel functions of a SymTable (see SymTable_mapParallel) split
+the bindings of a table into parts and give each part a thread of its
+own. These are the helpers that they share.*/
+
+#include <stddef.h>
+
+#ifndef SYMPARALLEL_INCLUDED
+#define SYMPARALLEL_INCLUDED
+
+/*SymParallel_run calls (*pfWork)(pvArg, iPart) for each iPart below 
+iPartCount, all at once, and returns once every call has returned. 
+Part 0 runs on the calling thread and every other part on a new 
+thread; a part whose thread cannot be created runs on the calling 
+thread after part 0.*/
+void SymParallel_run(int iPartCount,
+     void (*pfWork)(void *pvArg, int iPart), void *pvArg);
+
+/*SymParallel_first returns the index of the first of uCount items that
+belong to part iPart when they are split into iPartCount runs of
+consecutive items whose lengths differ by at most one. Part iPart
+ends where part iPart + 1 begins, and part iPartCount begins at 
+uCount.*/
+size_t SymParallel_first(size_t uCount, int iPart, int iPartCount);
+
+/*SymParallel_map does the work of SymTable_mapParallel for a table
+pvTable, which is split into iPartCount parts. Each implementation
+supplies only pfPart, which must call (*pfApply)(pcKey, pvValue,
+pvExtra) for each pcKey/pvValue binding of part iPart of the
+iPartCount parts of pvTable. SymParallel_map calls (*pfPart)(pvTable,
+iPart, iPartCount, pfApply, pvExtra) for each iPart below iPartCount,
+as SymParallel_run does.*/
+void SymParallel_map(void *pvTable,
+     void (*pfPart)(void *pvTable, int iPart, int iPartCount,
+          void (*pfApply)(const char *pcKey, void *pvValue,
+               void *pvExtra),
+          void *pvExtra),
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iPartCount);
+
+/*SymParallel_mapEach is SymParallel_map, except that part iPart passes
+apvExtras[iPart] to pfApply, as SymTable_mapReduce does with its
+accumulators.*/
+void SymParallel_mapEach(void *pvTable,
+     void (*pfPart)(void *pvTable, int iPart, int iPartCount,
+          void (*pfApply)(const char *pcKey, void *pvValue,
+               void *pvExtra),
+          void *pvExtra),
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     void *const apvExtras[], int iPartCount);
+
+/*SymParallel_merge calls (*pfMerge)(apvAccumulators[0],
+apvAccumulators[i]) for each i from 1 below iCount in turn, as
+SymTable_mapReduce does once its parts are done.*/
+void SymParallel_merge(void (*pfMerge)(void *pvAccumulator,
+          void *pvOther),
+     void *const apvAccumulators[], int iCount);
+
+#endif
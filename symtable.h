@@ -18,6 +18,32 @@ typedef struct SymTable *SymTable_T;
 or NULL if insufficient memory is available.*/
 SymTable_T SymTable_new(void);
 
+/*SymTable_newWithHash returns a new SymTable object that contains no 
+bindings and that hashes each key with (*pfHash)(pcKey, uLength), 
+where uLength is the length of pcKey, or NULL if insufficient memory 
+is available. SymTable_new uses SymHash_fast from symhash.h; 
+SymHash_compat there is the hash function of the assignment 
+specification. Implementations that do not hash keys ignore pfHash.*/
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength));
+
+/*The ways in which SymTable_setReorder can have a SymTable reorder
+its bindings*/
+enum {SYMTABLE_REORDER_NONE, SYMTABLE_REORDER_MOVE_TO_FRONT,
+     SYMTABLE_REORDER_TRANSPOSE};
+
+/*SymTable_setReorder sets how oSymTable reorders its bindings each
+time SymTable_get or SymTable_getN finds a key, so that keys that are
+looked up often come to be found after few comparisons. With
+SYMTABLE_REORDER_MOVE_TO_FRONT the binding found moves to the front of
+the search order; with SYMTABLE_REORDER_TRANSPOSE it trades places
+with the binding before it; with SYMTABLE_REORDER_NONE, the default,
+nothing moves. A get that reorders bindings changes the order in which
+SymTable_map and iterations visit them, so the client must not call
+it while an iteration is in progress. Implementations whose search
+order does not depend on the order of the bindings ignore iPolicy.*/
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy);
+
 /*SymTable_free frees all memory occupied by oSymTable.*/
 void SymTable_free(SymTable_T oSymTable);
 
@@ -33,6 +59,26 @@ return 0 (FALSE).*/
 int SymTable_put(SymTable_T oSymTable,
      const char *pcKey, const void *pvValue);
 
+/*SymTable_putBorrowed is SymTable_put, except that if it adds a 
+binding, oSymTable may use the characters at pcKey themselves as its 
+key instead of a copy of them. The client must then leave pcKey 
+unchanged and allocated until the binding is removed or oSymTable is 
+freed; oSymTable never frees pcKey. It suits keys that already outlive 
+the table, such as string literals and interned strings.*/
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue);
+
+/*SymTable_findOrInsert returns the address of the value of the 
+binding in oSymTable whose key is pcKey. If there is no such binding, 
+it first adds one consisting of key pcKey and a NULL value. It sets 
+*piInserted to 1 (TRUE) if it added a binding and 0 (FALSE) otherwise. 
+If insufficient memory is available, then the function leaves 
+oSymTable unchanged and returns NULL. The returned address remains 
+valid until the next call that adds or removes a binding of 
+oSymTable.*/
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted);
+
 /*SymTable_replace replaces and returns a pointer to the old value
 associated with the key pcKey in oSymTable, and inserts pvValue, 
 the new value pointer*/
@@ -53,6 +99,45 @@ key pcKey. If oSymTable does not contain pcKey, the function
 returns NULL*/
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/*The functions whose names end in N take a key as the uLength
+characters at pcKey, which need not be followed by '\0', so that a key
+can be looked up where it lies in a larger buffer. The key is the
+same as the string of those characters, and must not contain '\0'.
+Each behaves as the function of the same name without the N.*/
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue);
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted);
+void *SymTable_replaceN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue);
+int SymTable_containsN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength);
+void *SymTable_getN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength);
+void *SymTable_removeN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength);
+
+/*SymTable_getBatch sets apvValues[i] to the value associated with key
+apcKeys[i] within oSymTable, or to NULL if there is none, for each i
+below uCount. The result is that of calling SymTable_get for each key
+in turn, but implementations may overlap the lookups of different
+keys to hide memory latency.*/
+void SymTable_getBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[]);
+
+/*SymTable_putBatch calls SymTable_put(oSymTable, apcKeys[i],
+apvValues[i]) for each i below uCount, in order, and returns the number
+of bindings that it added. A key that is already in oSymTable, or that
+appears earlier in apcKeys, is not added.*/
+size_t SymTable_putBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *const apvValues[]);
+
+/*SymTable_removeBatch calls SymTable_remove(oSymTable, apcKeys[i]) for
+each i below uCount, in order, and sets apvValues[i] to the value that
+it returns.*/
+void SymTable_removeBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[]);
+
 /*SymTable_map applies the function *pfApply to each binding in 
 oSymTable, passing pvExtra as an extra parameter. That is, 
 the function calls (*pfApply)(pcKey, pvValue, pvExtra) 
@@ -61,4 +146,76 @@ void SymTable_map(SymTable_T oSymTable,
      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
      const void *pvExtra);
 
+/*SymTable_mapParallel applies *pfApply to each binding of oSymTable 
+as SymTable_map does, but splits the bindings among iThreadCount 
+threads, the calling thread among them, and returns once all are done. 
+pfApply may therefore run on several threads at once, all passing 
+pvExtra. pfApply must not add or remove bindings of oSymTable, and 
+other threads must not either, except in implementations that are safe 
+for concurrent use.*/
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount);
+
+/*SymTable_mapReduce splits the bindings of oSymTable among 
+iThreadCount threads as SymTable_mapParallel does, but thread i calls 
+(*pfApply)(pcKey, pvValue, apvAccumulators[i]), so that no accumulator 
+is shared between threads. Once every binding has been applied, it 
+calls (*pfMerge)(apvAccumulators[0], apvAccumulators[i]) for each i 
+from 1 below iThreadCount in turn, on the calling thread, to combine 
+the results into apvAccumulators[0]. The client must set up all 
+iThreadCount accumulators before the call, as for an empty table.*/
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount);
+
+/*A SymTable_Iter is a cursor over the bindings of a SymTable. While
+the iteration is in progress, pcKey and pvValue are the key and value
+of the current binding; once it is done, pcKey is NULL. The remaining
+fields belong to the implementation.*/
+typedef struct SymTableIter
+{
+     const char *pcKey;
+     void *pvValue;
+     SymTable_T oSymTable;
+     void *pvContainer;
+     void *pvPosition;
+     size_t uIndex;
+} SymTable_Iter;
+
+/*SymTable_iterBegin starts *psIter at the first binding of oSymTable,
+in no particular order. The client must not add or remove bindings of 
+oSymTable until the iteration is done or ended. Implementations that 
+are safe for concurrent use either hold other threads' changes back 
+until then or visit each binding that stays in oSymTable throughout 
+the iteration exactly once.*/
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter);
+
+/*SymTable_iterNext moves *psIter to the next binding, finishing the
+iteration if there is none.*/
+void SymTable_iterNext(SymTable_Iter *psIter);
+
+/*SymTable_iterEnd finishes the iteration *psIter early. An iteration 
+that is abandoned before SymTable_iterDone becomes true must be ended 
+this way; ending one that is already done does nothing.*/
+void SymTable_iterEnd(SymTable_Iter *psIter);
+
+/*SymTable_iterDone is nonzero once the iteration *psIter has visited
+every binding, and SymTable_iterKey and SymTable_iterValue are the key
+and value of its current binding. They are macros, so that a loop over
+a table makes no call other than SymTable_iterNext.*/
+#define SymTable_iterDone(psIter) ((psIter)->pcKey == NULL)
+#define SymTable_iterKey(psIter) ((psIter)->pcKey)
+#define SymTable_iterValue(psIter) ((psIter)->pvValue)
+
+/*SYMTABLE_FOREACH(oSymTable, psIter) runs the statement that follows
+it once per binding of oSymTable, with *psIter at that binding. A
+statement that leaves the loop with break, goto or return must call
+SymTable_iterEnd(psIter) first.*/
+#define SYMTABLE_FOREACH(oSymTable, psIter) \
+     for (SymTable_iterBegin((oSymTable), (psIter)); \
+          !SymTable_iterDone(psIter); SymTable_iterNext(psIter))
+
  #endif
\ No newline at end of file
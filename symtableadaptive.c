@@ -0,0 +1,792 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation adapts its layout to its size. A small table is a
+packed array of (hash, key, value) slots that is searched linearly; it
+allocates nothing until its first put and only as many slots as it
+needs after that. Once the array would need more than MAX_ARRAY_SLOTS
+slots, the same slots are rehashed into an open-addressing hash table
+with linear probing and Robin Hood displacement, as in the Robin Hood
+SymTable, and a table that drains far enough is packed back into an
+array.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+/*The number of slots that the first put allocates. An array doubles
+when it is full, and becomes a hash table once it would need more
+than MAX_ARRAY_SLOTS slots*/
+enum {MIN_ARRAY_SLOTS = 4, MAX_ARRAY_SLOTS = 16};
+
+/*A hash table expands once more than MAX_LOAD_NUM / MAX_LOAD_DEN of
+its slots are in use*/
+enum {MAX_LOAD_NUM = 4, MAX_LOAD_DEN = 5};
+
+/*Once removals leave fewer than 1 / SHRINK_LOAD_DEN of the slots of a
+hash table in use, it shrinks to the fewest slots that are at most
+SHRINK_TARGET_NUM / SHRINK_TARGET_DEN in use, which is an array if
+that is no more than MAX_ARRAY_SLOTS slots*/
+enum {SHRINK_LOAD_DEN = 8};
+enum {SHRINK_TARGET_NUM = 2, SHRINK_TARGET_DEN = 5};
+
+/*A stored hash of EMPTY_HASH marks an unused slot; SymTable_hash never
+returns it*/
+enum {EMPTY_HASH = 0};
+
+/*Set in the stored length of a key that the client lent with
+SymTable_putBorrowed, which the symbol table must not free*/
+static const size_t BORROWED_KEY = ~((size_t)-1 >> 1);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableSlot holds one binding, or none if its hash is
+EMPTY_HASH. The hash, key and value of a binding share a slot, so a
+lookup that finds a key reads nothing else to return its value. */
+struct SymTableSlot
+{
+   /*The full hash of the key, or EMPTY_HASH*/
+   size_t uHash;
+
+   /*The key, owned by the symbol table unless it is borrowed*/
+   const char *pcKey;
+
+   /*The length of the key, with BORROWED_KEY set if it is borrowed*/
+   size_t uLength;
+
+   /*The value*/
+   void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an array while numSlots is at most MAX_ARRAY_SLOTS:
+its bindings then fill psSlots[0] through psSlots[bindingCount - 1]
+in no particular order. Otherwise it is a Robin Hood hash table:
+every binding sits at or after its home slot (its hash masked by the
+slot count), and bindings that are further from home are never placed
+behind bindings that are closer to home. */
+struct SymTable
+{
+   /*The slots, or NULL if numSlots is 0*/
+   struct SymTableSlot *psSlots;
+
+   /*The number of slots, 0 or a power of two*/
+   size_t numSlots;
+
+   /*The number of bindings within the symbol table*/
+   size_t bindingCount;
+
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*How SymTable_getN reorders an array: one of the SYMTABLE_REORDER
+   values*/
+   int iReorder;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable is laid out as an array, or 0 (FALSE)
+   if it is a hash table. */
+static int SymTable_isArray(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->numSlots <= MAX_ARRAY_SLOTS;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of pcKey, which is uLength characters long, in
+   oSymTable. It is never EMPTY_HASH. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength)
+{
+   size_t uHash;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   if (uHash == EMPTY_HASH) uHash = 1;
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the key of psSlot, which must hold a binding, unless it is
+   borrowed. */
+static void SymTable_freeKey(struct SymTableSlot *psSlot)
+{
+   assert(psSlot != NULL);
+
+   if ((psSlot->uLength & BORROWED_KEY) == 0)
+      free((char*)psSlot->pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the key of psSlot, which must hold a binding, is
+   pcKey, which is uLength characters long, or 0 (FALSE) otherwise.
+   Keys of other lengths are rejected without reading them. */
+static int SymTable_keyEquals(const struct SymTableSlot *psSlot,
+   const char *pcKey, size_t uLength)
+{
+   assert(psSlot != NULL);
+   assert(pcKey != NULL);
+
+   return (psSlot->uLength & ~BORROWED_KEY) == uLength
+      && !memcmp(psSlot->pcKey, pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return how far slot uSlot of oSymTable, a hash table, is from the
+   home slot of its binding, which must exist. */
+static size_t SymTable_distance(SymTable_T oSymTable, size_t uSlot)
+{
+   size_t uMask = oSymTable->numSlots - 1;
+   return (uSlot - (oSymTable->psSlots[uSlot].uHash & uMask)) & uMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Place sSlot, whose key must not be in oSymTable, a hash table, into
+   the probe sequence of its home slot. Any binding that it evicts
+   moves on in turn, displacing bindings that are closer to home than
+   itself. There must be an empty slot. Return the slot where sSlot
+   ends up. */
+static size_t SymTable_placeAt(SymTable_T oSymTable,
+   struct SymTableSlot sSlot)
+{
+   size_t uMask = oSymTable->numSlots - 1;
+   size_t uSlot = sSlot.uHash & uMask;
+   size_t uDistance = 0;
+   size_t uSlotDistance;
+   size_t uPlaced = oSymTable->numSlots;
+   struct SymTableSlot sTemp;
+
+   while (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH) {
+      uSlotDistance = SymTable_distance(oSymTable, uSlot);
+      if (uSlotDistance < uDistance) {
+         sTemp = oSymTable->psSlots[uSlot];
+         oSymTable->psSlots[uSlot] = sSlot;
+         sSlot = sTemp;
+         uDistance = uSlotDistance;
+         if (uPlaced == oSymTable->numSlots) uPlaced = uSlot;
+      }
+      uSlot = (uSlot + 1) & uMask;
+      uDistance++;
+   }
+
+   oSymTable->psSlots[uSlot] = sSlot;
+   if (uPlaced == oSymTable->numSlots) uPlaced = uSlot;
+   return uPlaced;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the slot of oSymTable that holds the key pcKey, which is
+   uLength characters long, or oSymTable->numSlots if there is no such
+   slot. */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength)
+{
+   size_t uHash;
+   size_t uMask;
+   size_t uSlot;
+   size_t uDistance = 0;
+
+   /* A short scan that rejects keys by their length costs less than
+   hashing the key, so an array is searched without its hash. */
+   if (SymTable_isArray(oSymTable)) {
+      for (uSlot = 0; uSlot < oSymTable->bindingCount; uSlot++) {
+         if (SymTable_keyEquals(&oSymTable->psSlots[uSlot], pcKey,
+                uLength))
+            return uSlot;
+      }
+      return oSymTable->numSlots;
+   }
+
+   uHash = SymTable_hash(oSymTable, pcKey, uLength);
+   uMask = oSymTable->numSlots - 1;
+   uSlot = uHash & uMask;
+   while (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH
+          && SymTable_distance(oSymTable, uSlot) >= uDistance) {
+      if (oSymTable->psSlots[uSlot].uHash == uHash
+          && SymTable_keyEquals(&oSymTable->psSlots[uSlot], pcKey,
+                uLength))
+         return uSlot;
+      uSlot = (uSlot + 1) & uMask;
+      uDistance++;
+   }
+   return oSymTable->numSlots;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSymTable into uNewCount new slots, a power of
+   two with room for every binding, packing them into an array if
+   uNewCount is at most MAX_ARRAY_SLOTS and hashing them otherwise.
+   Return 1 (TRUE) on success, or 0 (FALSE), leaving oSymTable
+   unchanged, if insufficient memory is available. */
+static int SymTable_resize(SymTable_T oSymTable, size_t uNewCount)
+{
+   struct SymTableSlot *psOldSlots = oSymTable->psSlots;
+   size_t uOldCount = oSymTable->numSlots;
+   size_t uSlot;
+   size_t uPacked = 0;
+
+   assert(oSymTable != NULL);
+   assert(uNewCount >= oSymTable->bindingCount);
+
+   oSymTable->psSlots = (struct SymTableSlot*)
+      calloc(uNewCount, sizeof(struct SymTableSlot));
+   if (oSymTable->psSlots == NULL) {
+      oSymTable->psSlots = psOldSlots;
+      return 0;
+   }
+   oSymTable->numSlots = uNewCount;
+
+   for (uSlot = 0; uSlot < uOldCount; uSlot++) {
+      if (psOldSlots[uSlot].uHash == EMPTY_HASH) continue;
+      if (SymTable_isArray(oSymTable))
+         oSymTable->psSlots[uPacked++] = psOldSlots[uSlot];
+      else
+         (void)SymTable_placeAt(oSymTable, psOldSlots[uSlot]);
+   }
+
+   free(psOldSlots);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   SymTable_T oSymTable;
+
+   assert(pfHash != NULL);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   /* An empty table has no slots at all. */
+   oSymTable->psSlots = NULL;
+   oSymTable->numSlots = 0;
+   oSymTable->bindingCount = 0;
+   oSymTable->pfHash = pfHash;
+   oSymTable->iReorder = SYMTABLE_REORDER_NONE;
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Only an array reorders its bindings; the position of each binding
+   of a hash table is fixed by its hash. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+
+   oSymTable->iReorder = iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH)
+         SymTable_freeKey(&oSymTable->psSlots[uSlot]);
+   }
+
+   free(oSymTable->psSlots);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_findOrAdd is SymTable_findOrInsertN, except that if
+   iBorrow is 1 (TRUE), a binding that it adds borrows pcKey, which
+   must then be followed by '\0', instead of copying it. */
+static void **SymTable_findOrAdd(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int iBorrow, int *piInserted)
+{
+   struct SymTableSlot sSlot;
+   size_t uSlot;
+   size_t uOldCount;
+   char *pcKeyCopy;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength);
+   if (uSlot != oSymTable->numSlots) {
+      *piInserted = 0;
+      return &oSymTable->psSlots[uSlot].pvValue;
+   }
+
+   /* Make room first: a full array doubles, which turns it into a
+   hash table once it would pass MAX_ARRAY_SLOTS, and a hash table
+   doubles past its maximum load, keeping at least one slot empty even
+   if that fails. */
+   uOldCount = oSymTable->numSlots;
+   if (SymTable_isArray(oSymTable)) {
+      if (oSymTable->bindingCount == uOldCount
+          && !SymTable_resize(oSymTable,
+                uOldCount == 0 ? MIN_ARRAY_SLOTS : 2 * uOldCount))
+         return NULL;
+   }
+   else if ((oSymTable->bindingCount + 1) * MAX_LOAD_DEN
+              > uOldCount * MAX_LOAD_NUM) {
+      if ((uOldCount > ((size_t)-1 / 2) / sizeof(struct SymTableSlot)
+           || !SymTable_resize(oSymTable, 2 * uOldCount))
+          && oSymTable->bindingCount + 1 >= uOldCount)
+         return NULL;
+   }
+
+   if (iBorrow)
+      sSlot.pcKey = pcKey;
+   else {
+      pcKeyCopy = (char*)malloc(uLength + 1);
+      if (pcKeyCopy == NULL) return NULL;
+      memcpy(pcKeyCopy, pcKey, uLength);
+      pcKeyCopy[uLength] = '\0';
+      sSlot.pcKey = pcKeyCopy;
+   }
+   sSlot.uLength = iBorrow ? uLength | BORROWED_KEY : uLength;
+   sSlot.uHash = SymTable_hash(oSymTable, pcKey, uLength);
+   sSlot.pvValue = NULL;
+
+   if (SymTable_isArray(oSymTable)) {
+      uSlot = oSymTable->bindingCount;
+      oSymTable->psSlots[uSlot] = sSlot;
+   }
+   else
+      uSlot = SymTable_placeAt(oSymTable, sSlot);
+   oSymTable->bindingCount++;
+
+   *piInserted = 1;
+   return &oSymTable->psSlots[uSlot].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   return SymTable_findOrAdd(oSymTable, pcKey, uLength, 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), 1,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   size_t uSlot;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength);
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->psSlots[uSlot].pvValue;
+   oSymTable->psSlots[uSlot].pvValue = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding in slot uSlot of oSymTable, an array, by moving
+   the last binding into its place, and halve the array once at most a
+   quarter of it is in use. */
+static void SymTable_removeFromArray(SymTable_T oSymTable, size_t uSlot)
+{
+   size_t uLast;
+
+   assert(oSymTable != NULL);
+
+   uLast = oSymTable->bindingCount - 1;
+   oSymTable->psSlots[uSlot] = oSymTable->psSlots[uLast];
+   oSymTable->psSlots[uLast].uHash = EMPTY_HASH;
+   oSymTable->bindingCount--;
+
+   if (oSymTable->numSlots > MIN_ARRAY_SLOTS
+       && oSymTable->bindingCount * 4 <= oSymTable->numSlots)
+      (void)SymTable_resize(oSymTable, oSymTable->numSlots / 2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding in slot uSlot of oSymTable, a hash table, and
+   shrink the table, possibly into an array, once few enough slots
+   remain in use. */
+static void SymTable_removeFromHash(SymTable_T oSymTable, size_t uSlot)
+{
+   size_t uMask;
+   size_t uNext;
+   size_t uNewCount;
+
+   assert(oSymTable != NULL);
+
+   /* Shift the following displaced bindings back by one slot, so no
+   tombstone is needed. */
+   uMask = oSymTable->numSlots - 1;
+   uNext = (uSlot + 1) & uMask;
+   while (oSymTable->psSlots[uNext].uHash != EMPTY_HASH
+          && SymTable_distance(oSymTable, uNext) != 0) {
+      oSymTable->psSlots[uSlot] = oSymTable->psSlots[uNext];
+      uSlot = uNext;
+      uNext = (uNext + 1) & uMask;
+   }
+   oSymTable->psSlots[uSlot].uHash = EMPTY_HASH;
+
+   oSymTable->bindingCount--;
+
+   if (oSymTable->bindingCount * SHRINK_LOAD_DEN
+         < oSymTable->numSlots) {
+      uNewCount = MIN_ARRAY_SLOTS;
+      while (oSymTable->bindingCount * SHRINK_TARGET_DEN
+               > uNewCount * SHRINK_TARGET_NUM)
+         uNewCount *= 2;
+      (void)SymTable_resize(oSymTable, uNewCount);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   size_t uSlot;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength);
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->psSlots[uSlot].pvValue;
+   SymTable_freeKey(&oSymTable->psSlots[uSlot]);
+
+   if (SymTable_isArray(oSymTable))
+      SymTable_removeFromArray(oSymTable, uSlot);
+   else
+      SymTable_removeFromHash(oSymTable, uSlot);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableSlot sFound;
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength);
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   sFound = oSymTable->psSlots[uSlot];
+   if (uSlot == 0 || !SymTable_isArray(oSymTable))
+      return sFound.pvValue;
+
+   switch (oSymTable->iReorder) {
+      case SYMTABLE_REORDER_MOVE_TO_FRONT:
+         memmove(&oSymTable->psSlots[1], &oSymTable->psSlots[0],
+            uSlot * sizeof(struct SymTableSlot));
+         oSymTable->psSlots[0] = sFound;
+         break;
+      case SYMTABLE_REORDER_TRANSPOSE:
+         oSymTable->psSlots[uSlot] = oSymTable->psSlots[uSlot - 1];
+         oSymTable->psSlots[uSlot - 1] = sFound;
+         break;
+      default:
+         break;
+   }
+   return sFound.pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, uLength)
+      != oSymTable->numSlots;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding in a slot at or after uSlot, or
+   finish psIter if there is none. Unused slots of an array are empty,
+   so the same walk serves both layouts. */
+static void SymTable_iterFrom(SymTable_Iter *psIter, size_t uSlot)
+{
+   SymTable_T oSymTable;
+
+   assert(psIter != NULL);
+
+   oSymTable = psIter->oSymTable;
+   for (; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH) {
+         psIter->uIndex = uSlot;
+         psIter->pcKey = oSymTable->psSlots[uSlot].pcKey;
+         psIter->pvValue = oSymTable->psSlots[uSlot].pvValue;
+         return;
+      }
+   }
+   psIter->uIndex = oSymTable->numSlots;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvPosition = NULL;
+   SymTable_iterFrom(psIter, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pcKey != NULL);
+
+   SymTable_iterFrom(psIter, psIter->uIndex + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration of the slots holds nothing that must be released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH)
+         (*pfApply)(oSymTable->psSlots[uSlot].pcKey,
+            oSymTable->psSlots[uSlot].pvValue, (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable, which is a run of
+   consecutive slots. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   size_t uSlot;
+   size_t uEnd;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uEnd = SymParallel_first(oSymTable->numSlots, iPart + 1,
+      iPartCount);
+
+   for (uSlot = SymParallel_first(oSymTable->numSlots, iPart,
+           iPartCount);
+        uSlot < uEnd; uSlot++)
+   {
+      if (oSymTable->psSlots[uSlot].uHash != EMPTY_HASH)
+         (*pfApply)(oSymTable->psSlots[uSlot].pcKey,
+            oSymTable->psSlots[uSlot].pvValue, pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
@@ -0,0 +1,55 @@
+/*The batch functions of symtable.h for every SymTable implementation
+other than symtablehash.c, which overlaps the lookups of a batch. Here
+each key of a batch is handled by a separate call of SymTable_get,
+SymTable_put or SymTable_remove, one key after another, so with the
+implementations that allow concurrent access other threads may see
+part of a batch before the rest.*/
+
+#include <assert.h>
+#include <stddef.h>
+#include "symtable.h"
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[])
+{
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
+
+   for (i = 0; i < uCount; i++)
+      apvValues[i] = SymTable_get(oSymTable, apcKeys[i]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *const apvValues[])
+{
+   size_t uAdded = 0;
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
+
+   for (i = 0; i < uCount; i++)
+      uAdded +=
+         (size_t)SymTable_put(oSymTable, apcKeys[i], apvValues[i]);
+   return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_removeBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[])
+{
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
+
+   for (i = 0; i < uCount; i++)
+      apvValues[i] = SymTable_remove(oSymTable, apcKeys[i]);
+}
@@ -0,0 +1,328 @@
+/*SYMTABLE_DEFINE(name, KeyType, ValueType, hashfn, eqfn) defines a
+symbol table type name_T whose keys have type KeyType and whose values
+have type ValueType, and the functions that operate on it:
+
+   name_T name_new(void);
+   void name_free(name_T oTable);
+   size_t name_getLength(name_T oTable);
+   int name_put(name_T oTable, KeyType key, ValueType value);
+   ValueType *name_get(name_T oTable, KeyType key);
+   int name_contains(name_T oTable, KeyType key);
+   int name_replace(name_T oTable, KeyType key, ValueType value,
+      ValueType *pOldValue);
+   int name_remove(name_T oTable, KeyType key, ValueType *pOldValue);
+   void name_map(name_T oTable,
+      void (*pfApply)(KeyType key, ValueType *pValue, void *pvExtra),
+      const void *pvExtra);
+
+They behave as the SymTable functions of the same names (see
+symtable.h), except that values are stored inline in the table rather
+than as void pointers to the client's memory. name_get therefore
+returns the address of the value in the table, or NULL if there is no
+binding with key; the address remains valid until the next call that
+adds or removes a binding. name_replace and name_remove return 1 (TRUE)
+if there was a binding with key, and 0 (FALSE) if not, and store its
+old value in *pOldValue unless pOldValue is NULL.
+
+Keys are stored as they are given: a table with a pointer KeyType
+neither copies nor frees what its keys point to, so the client must
+keep it unchanged while the binding exists. hashfn(key) must return a
+size_t hash code for key, and eqfn(key1, key2) nonzero if and only if
+key1 and key2 are equal; equal keys must have equal hash codes. Both
+may be functions or function-like macros, and are called directly, so
+the compiler can inline them into each lookup.
+
+The table is an open-addressing hash table with linear probing and
+Robin Hood displacement, like the Robin Hood SymTable; SymTableInt and
+SymTablePtr (see symtableword.h) are generated tables too. Each slot
+holds the stored hash of its key (0 marks an empty slot), the key and
+the value side by side, so a successful lookup reads one slot and
+dereferences nothing else. Every function is static inline, so a
+translation unit may use SYMTABLE_DEFINE once per name.*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef SYMTABLEDEFINE_INCLUDED
+#define SYMTABLEDEFINE_INCLUDED
+
+/*The number of slots allocated by name_new. The slot count is always a
+power of two so that a hash can be reduced with a mask*/
+enum {SYMTABLE_INITIAL_SLOT_COUNT = 16};
+
+/*A table expands once more than SYMTABLE_MAX_LOAD_NUM /
+SYMTABLE_MAX_LOAD_DEN of its slots are in use*/
+enum {SYMTABLE_MAX_LOAD_NUM = 4, SYMTABLE_MAX_LOAD_DEN = 5};
+
+/*Once removals leave fewer than 1 / SYMTABLE_SHRINK_LOAD_DEN of its
+slots in use, a table shrinks to the fewest slots that are at most
+SYMTABLE_SHRINK_TARGET_NUM / SYMTABLE_SHRINK_TARGET_DEN in use*/
+enum {SYMTABLE_SHRINK_LOAD_DEN = 8};
+enum {SYMTABLE_SHRINK_TARGET_NUM = 2, SYMTABLE_SHRINK_TARGET_DEN = 5};
+
+#define SYMTABLE_DEFINE(name, KeyType, ValueType, hashfn, eqfn)        \
+typedef struct name *name##_T;                                         \
+struct name##Slot                                                      \
+{                                                                      \
+   size_t uHash;                                                       \
+   KeyType key;                                                        \
+   ValueType value;                                                    \
+};                                                                     \
+struct name                                                            \
+{                                                                      \
+   size_t numSlots;                                                    \
+   size_t bindingCount;                                                \
+   struct name##Slot *pSlots;                                          \
+};                                                                     \
+                                                                       \
+static inline size_t name##_hash(KeyType key)                          \
+{                                                                      \
+   size_t uHash = (size_t)(hashfn(key));                               \
+   if (uHash == 0) uHash = 1;                                          \
+   return uHash;                                                       \
+}                                                                      \
+                                                                       \
+static inline size_t name##_distance(name##_T oTable, size_t uSlot)    \
+{                                                                      \
+   size_t uMask = oTable->numSlots - 1;                                \
+   return (uSlot - (oTable->pSlots[uSlot].uHash & uMask)) & uMask;     \
+}                                                                      \
+                                                                       \
+/* Place sSlot, whose key must not be in oTable, into slot uSlot,      \
+   uDistance slots from its home slot, evicting bindings that are      \
+   closer to home. There must be an empty slot. */                     \
+static inline void name##_placeAt(name##_T oTable, size_t uSlot,       \
+   size_t uDistance, struct name##Slot sSlot)                          \
+{                                                                      \
+   size_t uMask = oTable->numSlots - 1;                                \
+   size_t uSlotDistance;                                               \
+   struct name##Slot sTemp;                                            \
+                                                                       \
+   while (oTable->pSlots[uSlot].uHash != 0) {                          \
+      uSlotDistance = name##_distance(oTable, uSlot);                  \
+      if (uSlotDistance < uDistance) {                                 \
+         sTemp = oTable->pSlots[uSlot];                                \
+         oTable->pSlots[uSlot] = sSlot;                                \
+         sSlot = sTemp;                                                \
+         uDistance = uSlotDistance;                                    \
+      }                                                                \
+      uSlot = (uSlot + 1) & uMask;                                     \
+      uDistance++;                                                     \
+   }                                                                   \
+   oTable->pSlots[uSlot] = sSlot;                                      \
+}                                                                      \
+                                                                       \
+/* Return the slot of oTable that holds key, or oTable->numSlots. */   \
+static inline size_t name##_find(name##_T oTable, KeyType key)         \
+{                                                                      \
+   size_t uHash = name##_hash(key);                                    \
+   size_t uMask = oTable->numSlots - 1;                                \
+   size_t uSlot = uHash & uMask;                                       \
+   size_t uDistance = 0;                                               \
+                                                                       \
+   while (oTable->pSlots[uSlot].uHash != 0                             \
+          && name##_distance(oTable, uSlot) >= uDistance) {            \
+      if (oTable->pSlots[uSlot].uHash == uHash                         \
+          && (eqfn(oTable->pSlots[uSlot].key, key)))                   \
+         return uSlot;                                                 \
+      uSlot = (uSlot + 1) & uMask;                                     \
+      uDistance++;                                                     \
+   }                                                                   \
+   return oTable->numSlots;                                            \
+}                                                                      \
+                                                                       \
+/* Move every binding of oTable into uNewCount new slots, leaving      \
+   oTable unchanged if insufficient memory is available. */            \
+static inline void name##_rehash(name##_T oTable, size_t uNewCount)    \
+{                                                                      \
+   struct name##Slot *pOldSlots = oTable->pSlots;                      \
+   size_t uOldCount = oTable->numSlots;                                \
+   size_t uSlot;                                                       \
+                                                                       \
+   oTable->pSlots = (struct name##Slot*)                               \
+      calloc(uNewCount, sizeof(struct name##Slot));                    \
+   if (oTable->pSlots == NULL) {                                       \
+      oTable->pSlots = pOldSlots;                                      \
+      return;                                                          \
+   }                                                                   \
+   oTable->numSlots = uNewCount;                                       \
+                                                                       \
+   for (uSlot = 0; uSlot < uOldCount; uSlot++) {                       \
+      if (pOldSlots[uSlot].uHash != 0)                                 \
+         name##_placeAt(oTable,                                        \
+            pOldSlots[uSlot].uHash & (uNewCount - 1), 0,               \
+            pOldSlots[uSlot]);                                         \
+   }                                                                   \
+   free(pOldSlots);                                                    \
+}                                                                      \
+                                                                       \
+static inline name##_T name##_new(void)                                \
+{                                                                      \
+   name##_T oTable;                                                    \
+                                                                       \
+   oTable = (name##_T)malloc(sizeof(struct name));                     \
+   if (oTable == NULL) return NULL;                                    \
+                                                                       \
+   oTable->pSlots = (struct name##Slot*)                               \
+      calloc(SYMTABLE_INITIAL_SLOT_COUNT, sizeof(struct name##Slot));  \
+   if (oTable->pSlots == NULL) {                                       \
+      free(oTable);                                                    \
+      return NULL;                                                     \
+   }                                                                   \
+   oTable->numSlots = SYMTABLE_INITIAL_SLOT_COUNT;                     \
+   oTable->bindingCount = 0;                                           \
+   return oTable;                                                      \
+}                                                                      \
+                                                                       \
+static inline void name##_free(name##_T oTable)                        \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   free(oTable->pSlots);                                               \
+   free(oTable);                                                       \
+}                                                                      \
+                                                                       \
+static inline size_t name##_getLength(name##_T oTable)                 \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   return oTable->bindingCount;                                        \
+}                                                                      \
+                                                                       \
+static inline int name##_put(name##_T oTable, KeyType key,             \
+   ValueType value)                                                    \
+{                                                                      \
+   struct name##Slot sSlot;                                            \
+   size_t uMask;                                                       \
+   size_t uSlot;                                                       \
+   size_t uDistance;                                                   \
+   size_t uOldCount;                                                   \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   sSlot.uHash = name##_hash(key);                                     \
+   sSlot.key = key;                                                    \
+   sSlot.value = value;                                                \
+                                                                       \
+   for (;;) {                                                          \
+      uMask = oTable->numSlots - 1;                                    \
+      uSlot = sSlot.uHash & uMask;                                     \
+      uDistance = 0;                                                   \
+      while (oTable->pSlots[uSlot].uHash != 0                          \
+             && name##_distance(oTable, uSlot) >= uDistance) {         \
+         if (oTable->pSlots[uSlot].uHash == sSlot.uHash                \
+             && (eqfn(oTable->pSlots[uSlot].key, key)))                \
+            return 0;                                                  \
+         uSlot = (uSlot + 1) & uMask;                                  \
+         uDistance++;                                                  \
+      }                                                                \
+                                                                       \
+      if ((oTable->bindingCount + 1) * SYMTABLE_MAX_LOAD_DEN           \
+            <= oTable->numSlots * SYMTABLE_MAX_LOAD_NUM)               \
+         break;                                                        \
+                                                                       \
+      uOldCount = oTable->numSlots;                                    \
+      if (uOldCount <= ((size_t)-1 / 2) / sizeof(struct name##Slot))   \
+         name##_rehash(oTable, 2 * uOldCount);                         \
+      if (oTable->numSlots == uOldCount) {                             \
+         if (oTable->bindingCount + 1 >= oTable->numSlots)             \
+            return 0;                                                  \
+         break;                                                        \
+      }                                                                \
+   }                                                                   \
+                                                                       \
+   name##_placeAt(oTable, uSlot, uDistance, sSlot);                    \
+   oTable->bindingCount++;                                             \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline ValueType *name##_get(name##_T oTable, KeyType key)      \
+{                                                                      \
+   size_t uSlot;                                                       \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   uSlot = name##_find(oTable, key);                                   \
+   if (uSlot == oTable->numSlots) return NULL;                         \
+   return &oTable->pSlots[uSlot].value;                                \
+}                                                                      \
+                                                                       \
+static inline int name##_contains(name##_T oTable, KeyType key)        \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   return name##_find(oTable, key) != oTable->numSlots;                \
+}                                                                      \
+                                                                       \
+static inline int name##_replace(name##_T oTable, KeyType key,         \
+   ValueType value, ValueType *pOldValue)                              \
+{                                                                      \
+   size_t uSlot;                                                       \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   uSlot = name##_find(oTable, key);                                   \
+   if (uSlot == oTable->numSlots) return 0;                            \
+                                                                       \
+   if (pOldValue != NULL) *pOldValue = oTable->pSlots[uSlot].value;    \
+   oTable->pSlots[uSlot].value = value;                                \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline int name##_remove(name##_T oTable, KeyType key,          \
+   ValueType *pOldValue)                                               \
+{                                                                      \
+   size_t uMask;                                                       \
+   size_t uSlot;                                                       \
+   size_t uNext;                                                       \
+   size_t uNewCount;                                                   \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   uSlot = name##_find(oTable, key);                                   \
+   if (uSlot == oTable->numSlots) return 0;                            \
+                                                                       \
+   if (pOldValue != NULL) *pOldValue = oTable->pSlots[uSlot].value;    \
+                                                                       \
+   uMask = oTable->numSlots - 1;                                       \
+   uNext = (uSlot + 1) & uMask;                                        \
+   while (oTable->pSlots[uNext].uHash != 0                             \
+          && name##_distance(oTable, uNext) != 0) {                    \
+      oTable->pSlots[uSlot] = oTable->pSlots[uNext];                   \
+      uSlot = uNext;                                                   \
+      uNext = (uNext + 1) & uMask;                                     \
+   }                                                                   \
+   oTable->pSlots[uSlot].uHash = 0;                                    \
+                                                                       \
+   oTable->bindingCount--;                                             \
+                                                                       \
+   if (oTable->numSlots > SYMTABLE_INITIAL_SLOT_COUNT                  \
+       && oTable->bindingCount * SYMTABLE_SHRINK_LOAD_DEN              \
+            < oTable->numSlots) {                                      \
+      uNewCount = SYMTABLE_INITIAL_SLOT_COUNT;                         \
+      while (oTable->bindingCount * SYMTABLE_SHRINK_TARGET_DEN         \
+               > uNewCount * SYMTABLE_SHRINK_TARGET_NUM)               \
+         uNewCount *= 2;                                               \
+      name##_rehash(oTable, uNewCount);                                \
+   }                                                                   \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline void name##_map(name##_T oTable,                         \
+   void (*pfApply)(KeyType key, ValueType *pValue, void *pvExtra),     \
+   const void *pvExtra)                                                \
+{                                                                      \
+   size_t uSlot;                                                       \
+                                                                       \
+   assert(oTable != NULL);                                             \
+   assert(pfApply != NULL);                                            \
+                                                                       \
+   for (uSlot = 0; uSlot < oTable->numSlots; uSlot++) {                \
+      if (oTable->pSlots[uSlot].uHash != 0)                            \
+         (*pfApply)(oTable->pSlots[uSlot].key,                         \
+            &oTable->pSlots[uSlot].value, (void*)pvExtra);             \
+   }                                                                   \
+}
+
+#endif
@@ -12,18 +12,95 @@ a symbol table.*/
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+/*SymTable_prefetch asks the processor to start loading the cache line
+at pvAddress, where the compiler supports it*/
+#if defined(__GNUC__)
+#define SymTable_prefetch(pvAddress) __builtin_prefetch(pvAddress)
+#else
+#define SymTable_prefetch(pvAddress) ((void)(pvAddress))
+#endif
+
+/*The number of buckets allocated by the first put. Bucket counts are
+always powers of two, so that a hash is reduced to a bucket with a mask
+rather than a division. Each expansion doubles the bucket count, so
+the table can keep growing for as long as memory allows*/
+enum {INITIAL_BUCKET_COUNT = 512};
+
+/*Once removals leave fewer than one binding per SHRINK_LOAD_DEN
+buckets, the table shrinks back to about two buckets per binding. The
+gap between that and the expansion threshold of one binding per bucket
+keeps put/remove churn near either threshold from resizing repeatedly*/
+enum {SHRINK_LOAD_DEN = 8};
+
+/*A resize does not move every binding at once. Instead, the old and
+new bucket arrays coexist, and each later put or remove migrates the
+bindings of up to MIGRATE_STEP old buckets, so that no single call pays
+for the whole table*/
+enum {MIGRATE_STEP = 16};
+
+/*The batch functions handle keys BATCH_STEP at a time: they hash every
+key of a step and prefetch what its lookup will touch before resolving
+any of them, so that the cache misses of different keys overlap*/
+enum {BATCH_STEP = 16};
+
+/*Bindings are carved out of slabs. The first slab of a table holds
+MIN_SLAB_BINDINGS bindings, and each later slab holds twice as many as
+the one before, up to MAX_SLAB_BINDINGS*/
+enum {MIN_SLAB_BINDINGS = 16, MAX_SLAB_BINDINGS = 4096};
+
+/*Key copies are bump-allocated from key blocks, which likewise start
+at MIN_KEY_BLOCK_SIZE bytes and double up to MAX_KEY_BLOCK_SIZE bytes*/
+enum {MIN_KEY_BLOCK_SIZE = 256, MAX_KEY_BLOCK_SIZE = 65536};
+
+/*A key copy is rounded up to KEY_UNIT << c bytes for the smallest size
+class c that fits it, so that the space of a removed key can be reused
+by any later key of the same class. Keys too large for every class are
+allocated on their own*/
+enum {KEY_UNIT = 8, KEY_CLASS_COUNT = 6};
+
+/*A key of fewer than INLINE_KEY_SIZE characters is stored in its
+binding rather than in a key block, padded with '\0' characters, so
+that checking a binding's key costs no extra cache miss and compares a
+few whole words instead of calling strcmp. INLINE_KEY_SIZE is a
+multiple of sizeof(size_t), and more than sizeof(char*)*/
+enum {INLINE_KEY_SIZE = 16};
+
+/*The values of the last byte of a SymTableKey*/
+enum {KEY_INLINE = 0, KEY_BLOCK = 1, KEY_FREE = 2, KEY_BORROWED = 3};
+
+/* A SymTableKey holds the key of a binding, or the padded copy of a
+key being looked up. Its last byte tells which form it takes:
+KEY_INLINE, which is the '\0' that ends or pads an inline key;
+KEY_BLOCK, if pcKey points to a copy in a key block; KEY_BORROWED, if
+pcKey points to the client's own key, which SymTable_putBorrowed
+stored; or KEY_FREE, if the binding is free. A short key thus never
+has the same words as a key of any other form. */
+union SymTableKey
+{
+   /*The characters of an inline key, padded with '\0' characters*/
+   char acKey[INLINE_KEY_SIZE];
+
+   /*The same bytes, as words to compare*/
+   size_t auWords[INLINE_KEY_SIZE / sizeof(size_t)];
 
-/*The size of the hash tables is given by prime numbers near powers of
-two, to allow for expansion with proper hashing*/
-static size_t abucketCount[] = 
-   {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521};
+   /*The copy of a key that is too long to be inline, or the borrowed
+   key*/
+   const char *pcKey;
+};
 
 /* Each key and value is stored in a SymTableBinding. SymTableBindings 
 are linked to form a list.  */
 struct SymTableBinding
 {
    /*The key associated with the binding, used to locate the value*/
-   const char *pcKey;
+   union SymTableKey uKey;
+
+   /*The full hash of the key, kept so that rehashing never rereads the
+   key and lookups can skip strcmp on bindings whose hash differs*/
+   size_t uHash;
 
    /*The pointer to the value associated with the binding*/
    void *pvValue;
@@ -34,92 +111,632 @@ struct SymTableBinding
 
 /*--------------------------------------------------------------------*/
 
-/* A SymTable is a "dummy" Binding that points to the first 
-SymTableBinding. */
+/* A SymTableSlab is a block of bindings allocated together. */
+struct SymTableSlab
+{
+   /*The slab allocated before this one*/
+   struct SymTableSlab *psNextSlab;
+
+   /*The number of bindings in asBindings*/
+   size_t uCapacity;
+
+   /*The bindings of the slab*/
+   struct SymTableBinding asBindings[];
+};
+
+/* A SymTableKeyBlock is a block of memory holding key copies. */
+struct SymTableKeyBlock
+{
+   /*The key block allocated before this one*/
+   struct SymTableKeyBlock *psNextBlock;
+
+   /*The number of bytes in acKeys*/
+   size_t uSize;
+
+   /*The key copies of the block*/
+   char acKeys[];
+};
+
+/* A SymTableFreeKey overlays the space of a removed key copy while it
+waits to be reused. */
+struct SymTableFreeKey
+{
+   /*The next free key copy of the same size class*/
+   struct SymTableFreeKey *psNextKey;
+};
+
+/* A SymTableLargeKey heads a key copy that is too large for every
+size class; the characters of the key follow it. */
+struct SymTableLargeKey
+{
+   /*The neighboring large keys, so that any one can be unlinked*/
+   struct SymTableLargeKey *psPrevKey;
+   struct SymTableLargeKey *psNextKey;
+};
+
+/* A SymTablePool owns the memory of every binding and key copy of a
+SymTable, so that freeing the table releases a few large blocks rather
+than each binding separately. */
+struct SymTablePool
+{
+   /*The slabs of the table, most recent first*/
+   struct SymTableSlab *psSlabs;
+
+   /*The number of bindings of psSlabs already handed out*/
+   size_t uSlabUsed;
+
+   /*Bindings released by SymTable_remove, awaiting reuse*/
+   struct SymTableBinding *psFreeBindings;
+
+   /*The key blocks of the table, most recent first*/
+   struct SymTableKeyBlock *psKeyBlocks;
+
+   /*The number of bytes of psKeyBlocks already handed out*/
+   size_t uKeyBlockUsed;
+
+   /*Removed key copies of each size class, awaiting reuse*/
+   struct SymTableFreeKey *apsFreeKeys[KEY_CLASS_COUNT];
+
+   /*The key copies too large for every size class*/
+   struct SymTableLargeKey *psLargeKeys;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an array of buckets, each of which points to the 
+first SymTableBinding of its list. A new SymTable has no buckets until
+its first binding is put. While a resize is in progress, bindings that
+have not been migrated yet remain in an array of old buckets. */
 struct SymTable
 {
-   /*The "level" of buckets is the index in the abucketCount array, 
-   which increments each time the hashtable expands*/
-   int bucketLevel;
+   /*The number of buckets, always 0 or a power of two, which grows
+   each time the hashtable expands*/
+   size_t numBuckets;
 
    /*The number of bindings within the symbol table*/
    size_t bucketCount;
 
-   /* The address of the first SymTableBinding. */
-   struct SymTableBinding *psFirstBucket;
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*The first SymTableBinding of each bucket, or NULL if the bucket is
+   empty*/
+   struct SymTableBinding **ppsBuckets;
+
+   /*The buckets being migrated away from while a resize is in
+   progress, or NULL*/
+   struct SymTableBinding **ppsOldBuckets;
+
+   /*The number of buckets in ppsOldBuckets*/
+   size_t numOldBuckets;
+
+   /*The old buckets below index migrateNum are already migrated*/
+   size_t migrateNum;
+
+   /*1 if the resize in progress copies bindings into sPool so that
+   sOldPool can be freed at the end (a shrink), 0 if it relinks them*/
+   int iCompacting;
+
+   /*The memory of the bindings and key copies*/
+   struct SymTablePool sPool;
+
+   /*While compacting, the memory of the bindings not yet migrated*/
+   struct SymTablePool sOldPool;
 };
 
 /*--------------------------------------------------------------------*/
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+/* Return the hash code of pcKey, which is uLength characters long, in
+   oSymTable. Mask it with the bucket count minus one to find the bucket
+   of pcKey. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return (*oSymTable->pfHash)(pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psPool own no memory. */
+static void SymTable_initPool(struct SymTablePool *psPool)
+{
+   int iClass;
+
+   assert(psPool != NULL);
+
+   psPool->psSlabs = NULL;
+   psPool->uSlabUsed = 0;
+   psPool->psFreeBindings = NULL;
+   psPool->psKeyBlocks = NULL;
+   psPool->uKeyBlockUsed = 0;
+   for (iClass = 0; iClass < KEY_CLASS_COUNT; iClass++)
+      psPool->apsFreeKeys[iClass] = NULL;
+   psPool->psLargeKeys = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory owned by psPool. */
+static void SymTable_freePool(struct SymTablePool *psPool)
+{
+   struct SymTableSlab *psSlab;
+   struct SymTableKeyBlock *psKeyBlock;
+   struct SymTableLargeKey *psLargeKey;
+
+   assert(psPool != NULL);
+
+   while (psPool->psSlabs != NULL) {
+      psSlab = psPool->psSlabs;
+      psPool->psSlabs = psSlab->psNextSlab;
+      free(psSlab);
+   }
+   while (psPool->psKeyBlocks != NULL) {
+      psKeyBlock = psPool->psKeyBlocks;
+      psPool->psKeyBlocks = psKeyBlock->psNextBlock;
+      free(psKeyBlock);
+   }
+   while (psPool->psLargeKeys != NULL) {
+      psLargeKey = psPool->psLargeKeys;
+      psPool->psLargeKeys = psLargeKey->psNextKey;
+      free(psLargeKey);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the form of the key of psBinding: KEY_INLINE, KEY_BLOCK,
+   KEY_BORROWED or KEY_FREE. */
+static int SymTable_keyForm(const struct SymTableBinding *psBinding)
+{
+   assert(psBinding != NULL);
+
+   return psBinding->uKey.acKey[INLINE_KEY_SIZE - 1];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key of psBinding, or NULL if psBinding is free. */
+static const char *SymTable_key(const struct SymTableBinding *psBinding)
+{
+   assert(psBinding != NULL);
+
+   switch (SymTable_keyForm(psBinding)) {
+      case KEY_INLINE: return psBinding->uKey.acKey;
+      case KEY_BLOCK:
+      case KEY_BORROWED: return psBinding->uKey.pcKey;
+      default: return NULL;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Mark psBinding free, so that iterators walking the slabs skip it. */
+static void SymTable_markFree(struct SymTableBinding *psBinding)
+{
+   assert(psBinding != NULL);
+
+   psBinding->uKey.acKey[INLINE_KEY_SIZE - 1] = KEY_FREE;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psDstPool ownership of all memory of psSrcPool, leaving
+   psSrcPool empty. Bindings and key copies that psSrcPool had free are
+   not reused, but are still freed along with psDstPool. */
+static void SymTable_mergePool(struct SymTablePool *psDstPool,
+   struct SymTablePool *psSrcPool)
+{
+   struct SymTableSlab *psSlab;
+   struct SymTableKeyBlock *psKeyBlock;
+   struct SymTableLargeKey *psLargeKey;
+   size_t uIndex;
+
+   assert(psDstPool != NULL);
+   assert(psSrcPool != NULL);
+
+   /* Splice the source lists in behind the first slab and key block of
+   psDstPool, which must stay first since they are the ones that
+   uSlabUsed and uKeyBlockUsed describe. */
+   if (psSrcPool->psSlabs != NULL) {
+      if (psDstPool->psSlabs == NULL) {
+         psDstPool->psSlabs = psSrcPool->psSlabs;
+         psDstPool->uSlabUsed = psSrcPool->uSlabUsed;
+      }
+      else {
+         /* Behind the first slab, every binding of a slab counts as
+         handed out, so the unused ones must be marked free. */
+         for (uIndex = psSrcPool->uSlabUsed;
+              uIndex < psSrcPool->psSlabs->uCapacity; uIndex++)
+            SymTable_markFree(&psSrcPool->psSlabs->asBindings[uIndex]);
+         for (psSlab = psSrcPool->psSlabs; psSlab->psNextSlab != NULL;
+              psSlab = psSlab->psNextSlab);
+         psSlab->psNextSlab = psDstPool->psSlabs->psNextSlab;
+         psDstPool->psSlabs->psNextSlab = psSrcPool->psSlabs;
+      }
+   }
+
+   if (psSrcPool->psKeyBlocks != NULL) {
+      if (psDstPool->psKeyBlocks == NULL) {
+         psDstPool->psKeyBlocks = psSrcPool->psKeyBlocks;
+         psDstPool->uKeyBlockUsed = psSrcPool->uKeyBlockUsed;
+      }
+      else {
+         for (psKeyBlock = psSrcPool->psKeyBlocks;
+              psKeyBlock->psNextBlock != NULL;
+              psKeyBlock = psKeyBlock->psNextBlock);
+         psKeyBlock->psNextBlock = psDstPool->psKeyBlocks->psNextBlock;
+         psDstPool->psKeyBlocks->psNextBlock = psSrcPool->psKeyBlocks;
+      }
+   }
+
+   if (psSrcPool->psLargeKeys != NULL) {
+      for (psLargeKey = psSrcPool->psLargeKeys;
+           psLargeKey->psNextKey != NULL;
+           psLargeKey = psLargeKey->psNextKey);
+      psLargeKey->psNextKey = psDstPool->psLargeKeys;
+      if (psDstPool->psLargeKeys != NULL)
+         psDstPool->psLargeKeys->psPrevKey = psLargeKey;
+      psDstPool->psLargeKeys = psSrcPool->psLargeKeys;
+   }
+
+   SymTable_initPool(psSrcPool);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return an uninitialized binding from psPool, or NULL if insufficient
+   memory is available. */
+static struct SymTableBinding *SymTable_allocBinding(
+   struct SymTablePool *psPool)
+{
+   struct SymTableBinding *psBinding;
+   struct SymTableSlab *psSlab;
+   size_t uCapacity;
+
+   assert(psPool != NULL);
+
+   if (psPool->psFreeBindings != NULL) {
+      psBinding = psPool->psFreeBindings;
+      psPool->psFreeBindings = psBinding->psNextBinding;
+      return psBinding;
+   }
+
+   if (psPool->psSlabs == NULL
+       || psPool->uSlabUsed == psPool->psSlabs->uCapacity) {
+      uCapacity = MIN_SLAB_BINDINGS;
+      if (psPool->psSlabs != NULL) {
+         uCapacity = 2 * psPool->psSlabs->uCapacity;
+         if (uCapacity > MAX_SLAB_BINDINGS)
+            uCapacity = MAX_SLAB_BINDINGS;
+      }
+      psSlab = (struct SymTableSlab*)malloc(sizeof(struct SymTableSlab)
+         + uCapacity * sizeof(struct SymTableBinding));
+      if (psSlab == NULL) return NULL;
+      psSlab->psNextSlab = psPool->psSlabs;
+      psSlab->uCapacity = uCapacity;
+      psPool->psSlabs = psSlab;
+      psPool->uSlabUsed = 0;
+   }
+
+   return &psPool->psSlabs->asBindings[psPool->uSlabUsed++];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return psBinding, which came from psPool, to psPool for reuse, and
+   mark it free. */
+static void SymTable_releaseBinding(struct SymTablePool *psPool,
+   struct SymTableBinding *psBinding)
 {
-   const size_t HASH_MULTIPLIER = 65599;
-   size_t u;
-   size_t uHash = 0;
+   assert(psPool != NULL);
+   assert(psBinding != NULL);
+
+   SymTable_markFree(psBinding);
+   psBinding->psNextBinding = psPool->psFreeBindings;
+   psPool->psFreeBindings = psBinding;
+}
+
+/*--------------------------------------------------------------------*/
 
+/* Return the size class of a key copy of uSize bytes, or
+   KEY_CLASS_COUNT if it is too large for every class. */
+static int SymTable_keyClass(size_t uSize)
+{
+   int iClass = 0;
+
+   while (iClass < KEY_CLASS_COUNT
+          && ((size_t)KEY_UNIT << iClass) < uSize)
+      iClass++;
+   return iClass;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return uSize bytes of space for a key copy from psPool, or NULL if
+   insufficient memory is available. */
+static char *SymTable_allocKey(struct SymTablePool *psPool,
+   size_t uSize)
+{
+   struct SymTableKeyBlock *psKeyBlock;
+   struct SymTableLargeKey *psLargeKey;
+   struct SymTableFreeKey *psFreeKey;
+   size_t uBlockSize;
+   size_t uClassSize;
+   int iClass;
+
+   assert(psPool != NULL);
+
+   iClass = SymTable_keyClass(uSize);
+
+   if (iClass == KEY_CLASS_COUNT) {
+      psLargeKey = (struct SymTableLargeKey*)
+         malloc(sizeof(struct SymTableLargeKey) + uSize);
+      if (psLargeKey == NULL) return NULL;
+      psLargeKey->psPrevKey = NULL;
+      psLargeKey->psNextKey = psPool->psLargeKeys;
+      if (psPool->psLargeKeys != NULL)
+         psPool->psLargeKeys->psPrevKey = psLargeKey;
+      psPool->psLargeKeys = psLargeKey;
+      return (char*)(psLargeKey + 1);
+   }
+
+   if (psPool->apsFreeKeys[iClass] != NULL) {
+      psFreeKey = psPool->apsFreeKeys[iClass];
+      psPool->apsFreeKeys[iClass] = psFreeKey->psNextKey;
+      return (char*)psFreeKey;
+   }
+
+   uClassSize = (size_t)KEY_UNIT << iClass;
+   if (psPool->psKeyBlocks == NULL
+       || psPool->uKeyBlockUsed + uClassSize
+            > psPool->psKeyBlocks->uSize) {
+      uBlockSize = MIN_KEY_BLOCK_SIZE;
+      if (psPool->psKeyBlocks != NULL) {
+         uBlockSize = 2 * psPool->psKeyBlocks->uSize;
+         if (uBlockSize > MAX_KEY_BLOCK_SIZE)
+            uBlockSize = MAX_KEY_BLOCK_SIZE;
+      }
+      psKeyBlock = (struct SymTableKeyBlock*)
+         malloc(sizeof(struct SymTableKeyBlock) + uBlockSize);
+      if (psKeyBlock == NULL) return NULL;
+      psKeyBlock->psNextBlock = psPool->psKeyBlocks;
+      psKeyBlock->uSize = uBlockSize;
+      psPool->psKeyBlocks = psKeyBlock;
+      psPool->uKeyBlockUsed = 0;
+   }
+
+   psPool->uKeyBlockUsed += uClassSize;
+   return psPool->psKeyBlocks->acKeys
+      + (psPool->uKeyBlockUsed - uClassSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key copy pcKey of uSize bytes, which came from psPool, to
+   psPool for reuse. */
+static void SymTable_releaseKey(struct SymTablePool *psPool,
+   char *pcKey, size_t uSize)
+{
+   struct SymTableLargeKey *psLargeKey;
+   struct SymTableFreeKey *psFreeKey;
+   int iClass;
+
+   assert(psPool != NULL);
+   assert(pcKey != NULL);
+
+   iClass = SymTable_keyClass(uSize);
+
+   if (iClass == KEY_CLASS_COUNT) {
+      psLargeKey = (struct SymTableLargeKey*)pcKey - 1;
+      if (psLargeKey->psPrevKey != NULL)
+         psLargeKey->psPrevKey->psNextKey = psLargeKey->psNextKey;
+      else
+         psPool->psLargeKeys = psLargeKey->psNextKey;
+      if (psLargeKey->psNextKey != NULL)
+         psLargeKey->psNextKey->psPrevKey = psLargeKey->psPrevKey;
+      free(psLargeKey);
+      return;
+   }
+
+   psFreeKey = (struct SymTableFreeKey*)(void*)pcKey;
+   psFreeKey->psNextKey = psPool->apsFreeKeys[iClass];
+   psPool->apsFreeKeys[iClass] = psFreeKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psBinding a copy of pcKey, which is uLength characters long,
+   storing it inline if it is short enough and taking space from psPool
+   otherwise. A copy in psPool starts with its length, so that keys of
+   other lengths are rejected without comparing them. If iBorrow is 1
+   (TRUE), a key too long to be inline is borrowed instead of copied,
+   and must then be followed by '\0'. Return 1 (TRUE) on success, or 0
+   (FALSE) if insufficient memory is available. */
+static int SymTable_setKey(struct SymTablePool *psPool,
+   struct SymTableBinding *psBinding, const char *pcKey, size_t uLength,
+   int iBorrow)
+{
+   char *pcCopy;
+
+   assert(psPool != NULL);
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
+
+   /* The padding sets the last byte to KEY_INLINE. */
+   if (uLength < INLINE_KEY_SIZE) {
+      memset(psBinding->uKey.acKey, 0, INLINE_KEY_SIZE);
+      memcpy(psBinding->uKey.acKey, pcKey, uLength);
+      return 1;
+   }
+
+   if (iBorrow) {
+      psBinding->uKey.pcKey = pcKey;
+      psBinding->uKey.acKey[INLINE_KEY_SIZE - 1] = KEY_BORROWED;
+      return 1;
+   }
+
+   pcCopy = SymTable_allocKey(psPool, sizeof(size_t) + uLength + 1);
+   if (pcCopy == NULL) return 0;
+   memcpy(pcCopy, &uLength, sizeof(size_t));
+   pcCopy += sizeof(size_t);
+   memcpy(pcCopy, pcKey, uLength);
+   pcCopy[uLength] = '\0';
+   psBinding->uKey.pcKey = pcCopy;
+   psBinding->uKey.acKey[INLINE_KEY_SIZE - 1] = KEY_BLOCK;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of the key of psBinding, which must not be
+   free. */
+static size_t SymTable_keyLength(
+   const struct SymTableBinding *psBinding)
+{
+   size_t uLength;
+
+   assert(psBinding != NULL);
+   assert(SymTable_keyForm(psBinding) != KEY_FREE);
+
+   if (SymTable_keyForm(psBinding) == KEY_INLINE)
+      return strlen(psBinding->uKey.acKey);
+   if (SymTable_keyForm(psBinding) == KEY_BORROWED)
+      return strlen(psBinding->uKey.pcKey);
+   memcpy(&uLength, psBinding->uKey.pcKey - sizeof(size_t),
+      sizeof(size_t));
+   return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key copy of psBinding, which came from psPool, to psPool
+   if it is in a key block. */
+static void SymTable_releaseBindingKey(struct SymTablePool *psPool,
+   struct SymTableBinding *psBinding)
+{
+   assert(psPool != NULL);
+   assert(psBinding != NULL);
+
+   if (SymTable_keyForm(psBinding) == KEY_BLOCK)
+      SymTable_releaseKey(psPool,
+         (char*)psBinding->uKey.pcKey - sizeof(size_t),
+         sizeof(size_t) + SymTable_keyLength(psBinding) + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set *puProbe to pcKey, which is uLength characters long, padded as
+   an inline key would be, and return 1 (TRUE), if pcKey is short enough
+   to be stored inline. Otherwise return 0 (FALSE). */
+static int SymTable_makeProbe(const char *pcKey, size_t uLength,
+   union SymTableKey *puProbe)
+{
    assert(pcKey != NULL);
+   assert(puProbe != NULL);
+
+   if (uLength >= INLINE_KEY_SIZE) return 0;
+   memset(puProbe->acKey, 0, INLINE_KEY_SIZE);
+   memcpy(puProbe->acKey, pcKey, uLength);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
 
-   for (u = 0; pcKey[u] != '\0'; u++)
-      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+/* Return 1 (TRUE) if the key of psBinding is pcKey, which is uLength
+   characters long, or 0 (FALSE) otherwise. puProbe is the padded copy
+   of pcKey that SymTable_makeProbe made, or NULL if pcKey is too long
+   for one. Padding makes the inline comparison reject keys of other
+   lengths too. */
+static int SymTable_keyEquals(const struct SymTableBinding *psBinding,
+   const char *pcKey, size_t uLength, const union SymTableKey *puProbe)
+{
+   size_t uWord;
 
-   return uHash % uBucketCount;
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
+
+   /* A borrowed key has no stored length; strncmp stops at its end,
+   and pcKey contains no '\0' for it to match. */
+   if (puProbe == NULL) {
+      switch (SymTable_keyForm(psBinding)) {
+         case KEY_BLOCK:
+            return SymTable_keyLength(psBinding) == uLength
+               && !memcmp(pcKey, psBinding->uKey.pcKey, uLength);
+         case KEY_BORROWED:
+            return !strncmp(psBinding->uKey.pcKey, pcKey, uLength)
+               && psBinding->uKey.pcKey[uLength] == '\0';
+         default:
+            return 0;
+      }
+   }
+
+   for (uWord = 0; uWord < INLINE_KEY_SIZE / sizeof(size_t); uWord++) {
+      if (psBinding->uKey.auWords[uWord] != puProbe->auWords[uWord])
+         return 0;
+   }
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
 SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
 {
    SymTable_T oSymTable;
-   size_t hashNum;
+
+   assert(pfHash != NULL);
 
    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
    if (oSymTable == NULL) return NULL;
 
-   oSymTable->bucketLevel = 0;
+   oSymTable->numBuckets = 0;
    oSymTable->bucketCount = 0;
+   oSymTable->pfHash = pfHash;
+   oSymTable->ppsBuckets = NULL;
+   oSymTable->ppsOldBuckets = NULL;
+   oSymTable->numOldBuckets = 0;
+   oSymTable->migrateNum = 0;
+   oSymTable->iCompacting = 0;
+   SymTable_initPool(&oSymTable->sPool);
+   SymTable_initPool(&oSymTable->sOldPool);
 
-   oSymTable->psFirstBucket = (struct SymTableBinding *) 
-   malloc(sizeof(struct SymTableBinding) * abucketCount[0]);
-   if (oSymTable->psFirstBucket == NULL) {
-      free(oSymTable);
-      return NULL;
-   }
+   return oSymTable;
+}
 
-   for (hashNum = 0; hashNum < abucketCount[0]; hashNum++) {
-      (oSymTable->psFirstBucket + hashNum)->psNextBinding = NULL;
-   }
+/*--------------------------------------------------------------------*/
 
-   return oSymTable;
+/* A hash table finds each key by its hash, whatever the order of its
+   bindings, so it ignores iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
 }
 
 /*--------------------------------------------------------------------*/
 
 void SymTable_free(SymTable_T oSymTable)
 {
-   struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
-   size_t hashNum;
-
    assert(oSymTable != NULL);
-   
-   for (hashNum = 0; 
-         hashNum < abucketCount[oSymTable->bucketLevel]; 
-         hashNum++) 
-   {
-      for (psCurrentBinding = 
-            (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-            psCurrentBinding != NULL;
-            psCurrentBinding = psNextBinding)
-      {
-         psNextBinding = psCurrentBinding->psNextBinding;
-         free((void*)psCurrentBinding->pcKey);
-         free(psCurrentBinding);
-      }
-   }
 
-   free(oSymTable->psFirstBucket);
+   SymTable_freePool(&oSymTable->sPool);
+   SymTable_freePool(&oSymTable->sOldPool);
+   free(oSymTable->ppsBuckets);
+   free(oSymTable->ppsOldBuckets);
    free(oSymTable);
 }
 
@@ -133,275 +750,846 @@ size_t SymTable_getLength(SymTable_T oSymTable)
 
 /*--------------------------------------------------------------------*/
 
-/*SymTable_rehash expands the bucket count of oSymTable so that the
-speed efficiency of the symbol table remains relatively quick, while
-allocating additional memory to achieve the task.*/
-static void SymTable_rehash(SymTable_T oSymTable)
+/*SymTable_startResize begins moving the bindings of oSymTable into
+newBucketCount new buckets. If iCompacting is 1, the bindings are also
+copied into a new pool as they move, so that the slabs and key blocks
+of the current pool are freed when the resize finishes. A table without
+buckets simply gets its first ones. Return 1 on success, or 0 if
+insufficient memory is available, in which case oSymTable is left
+unchanged. No resize may already be in progress.*/
+static int SymTable_startResize(SymTable_T oSymTable,
+   size_t newBucketCount, int iCompacting)
+{
+   struct SymTableBinding **ppsNewBuckets;
+
+   assert(oSymTable != NULL);
+   assert(oSymTable->ppsOldBuckets == NULL);
+
+   if (newBucketCount == 0) return 0;
+
+   ppsNewBuckets = (struct SymTableBinding **)
+      calloc(newBucketCount, sizeof(struct SymTableBinding *));
+   if (ppsNewBuckets == NULL) return 0;
+
+   if (oSymTable->numBuckets != 0) {
+      oSymTable->ppsOldBuckets = oSymTable->ppsBuckets;
+      oSymTable->numOldBuckets = oSymTable->numBuckets;
+      oSymTable->migrateNum = 0;
+      oSymTable->iCompacting = iCompacting;
+      if (iCompacting) {
+         oSymTable->sOldPool = oSymTable->sPool;
+         SymTable_initPool(&oSymTable->sPool);
+      }
+   }
+
+   oSymTable->ppsBuckets = ppsNewBuckets;
+   oSymTable->numBuckets = newBucketCount;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_migrate moves the bindings of up to uBucketLimit old buckets
+of oSymTable into its new buckets, and finishes the resize in progress
+once every old bucket is empty.*/
+static void SymTable_migrate(SymTable_T oSymTable, size_t uBucketLimit)
 {
-   SymTable_T nSymTable;
    struct SymTableBinding *psCurrentBinding;
    struct SymTableBinding *psNextBinding;
-   size_t hashNum;
+   struct SymTableBinding *psNewBinding;
    size_t rehashNum;
 
    assert(oSymTable != NULL);
-   
-   nSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
-   if (nSymTable == NULL) return;
 
-   nSymTable->bucketLevel = oSymTable->bucketLevel + 1;
-   nSymTable->bucketCount = oSymTable->bucketCount;
+   while (oSymTable->ppsOldBuckets != NULL && uBucketLimit-- > 0) {
+      psCurrentBinding = 
+         oSymTable->ppsOldBuckets[oSymTable->migrateNum];
+      oSymTable->ppsOldBuckets[oSymTable->migrateNum] = NULL;
 
-   nSymTable->psFirstBucket = (struct SymTableBinding *) 
-   malloc(sizeof(struct SymTableBinding) * 
-   abucketCount[nSymTable->bucketLevel]);
+      while (psCurrentBinding != NULL) {
+         psNextBinding = psCurrentBinding->psNextBinding;
 
-   if (nSymTable->psFirstBucket == NULL) {
-      free(nSymTable);
-      return;
-   } 
+         if (oSymTable->iCompacting) {
+            psNewBinding = SymTable_allocBinding(&oSymTable->sPool);
+            if (psNewBinding != NULL
+                && !SymTable_setKey(&oSymTable->sPool, psNewBinding,
+                       SymTable_key(psCurrentBinding),
+                       SymTable_keyLength(psCurrentBinding),
+                       SymTable_keyForm(psCurrentBinding)
+                          == KEY_BORROWED)) {
+               SymTable_releaseBinding(&oSymTable->sPool, 
+                  psNewBinding);
+               psNewBinding = NULL;
+            }
+
+            if (psNewBinding != NULL) {
+               psNewBinding->pvValue = psCurrentBinding->pvValue;
+               psNewBinding->uHash = psCurrentBinding->uHash;
+               /* The original stays in the old pool until the resize
+               finishes; mark it free for iterators. */
+               SymTable_markFree(psCurrentBinding);
+               psCurrentBinding = psNewBinding;
+            }
+            else {
+               /* Out of memory: keep the old pool for good and relink
+               the remaining bindings instead of copying them. */
+               SymTable_mergePool(&oSymTable->sPool, 
+                  &oSymTable->sOldPool);
+               oSymTable->iCompacting = 0;
+            }
+         }
 
-   for (hashNum = 0; hashNum < abucketCount[nSymTable->bucketLevel];
-    hashNum++) {
-      (nSymTable->psFirstBucket + hashNum)->psNextBinding = NULL;
+         rehashNum = 
+            psCurrentBinding->uHash & (oSymTable->numBuckets - 1);
+         psCurrentBinding->psNextBinding = 
+            oSymTable->ppsBuckets[rehashNum];
+         oSymTable->ppsBuckets[rehashNum] = psCurrentBinding;
+         psCurrentBinding = psNextBinding;
+      }
+
+      oSymTable->migrateNum++;
+      if (oSymTable->migrateNum == oSymTable->numOldBuckets) {
+         free(oSymTable->ppsOldBuckets);
+         oSymTable->ppsOldBuckets = NULL;
+         oSymTable->numOldBuckets = 0;
+         oSymTable->migrateNum = 0;
+         if (oSymTable->iCompacting)
+            SymTable_freePool(&oSymTable->sOldPool);
+         oSymTable->iCompacting = 0;
+      }
    }
+}
 
-   for (hashNum = 0; 
-         hashNum < abucketCount[oSymTable->bucketLevel]; hashNum++) 
-      {
-         psCurrentBinding = 
-            (oSymTable->psFirstBucket + hashNum)->psNextBinding;
+/*--------------------------------------------------------------------*/
+
+/*SymTable_grow begins doubling the bucket count of oSymTable, first
+finishing any resize that is still
+in progress. If insufficient memory is available, oSymTable keeps its
+current buckets.*/
+static void SymTable_grow(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   if (oSymTable->numBuckets > 
+         ((size_t)-1 / 2) / sizeof(struct SymTableBinding *))
+      return;
 
-         while (psCurrentBinding != NULL) {
-            psNextBinding = psCurrentBinding->psNextBinding;
-            rehashNum = 
-               SymTable_hash(psCurrentBinding->pcKey, 
-               abucketCount[nSymTable->bucketLevel]);
+   SymTable_migrate(oSymTable, oSymTable->numOldBuckets);
+   (void)SymTable_startResize(oSymTable, 
+      2 * oSymTable->numBuckets, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_shrink begins reducing the bucket count of oSymTable to
+about twice its binding count, but no fewer than INITIAL_BUCKET_COUNT.
+The migration also copies every binding and key copy into a new pool,
+so that the slabs and key blocks left over from the table's larger
+past are freed. If insufficient memory is available, or if a resize is
+already in progress, oSymTable is left unchanged.*/
+static void SymTable_shrink(SymTable_T oSymTable)
+{
+   size_t newBucketCount = INITIAL_BUCKET_COUNT;
+
+   assert(oSymTable != NULL);
 
-            psCurrentBinding->psNextBinding = 
-               (nSymTable->psFirstBucket + rehashNum)->psNextBinding;
-            (nSymTable->psFirstBucket + rehashNum)->psNextBinding = 
-               psCurrentBinding;
+   if (oSymTable->ppsOldBuckets != NULL) return;
 
-            psCurrentBinding = psNextBinding;
+   while (newBucketCount < 2 * oSymTable->bucketCount)
+      newBucketCount *= 2;
+
+   (void)SymTable_startResize(oSymTable, newBucketCount, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*Return the address of the link, either a bucket or the psNextBinding
+field of a binding, that points to the binding of oSymTable whose key
+is pcKey, which is uLength characters long and has hash uHash, or NULL
+if there is no such binding. If piOld is not NULL, set *piOld to 1
+(TRUE) if the binding is in the old buckets, or 0 (FALSE) otherwise.*/
+static struct SymTableBinding **SymTable_findLink(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength, size_t uHash, int *piOld)
+{
+   struct SymTableBinding **ppsLink;
+   struct SymTableBinding *psCurrentBinding;
+   union SymTableKey uProbe;
+   const union SymTableKey *puProbe;
+   size_t hashNum;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   puProbe = SymTable_makeProbe(pcKey, uLength, &uProbe) ?
+      &uProbe : NULL;
+
+   /* A binding that has not been migrated yet is in its old bucket;
+   any other binding is in its new bucket. */
+   if (oSymTable->ppsOldBuckets != NULL) {
+      hashNum = uHash & (oSymTable->numOldBuckets - 1);
+      if (hashNum >= oSymTable->migrateNum) {
+         for (ppsLink = &oSymTable->ppsOldBuckets[hashNum];
+              (psCurrentBinding = *ppsLink) != NULL;
+              ppsLink = &psCurrentBinding->psNextBinding)
+         {
+            if (psCurrentBinding->uHash == uHash
+                && SymTable_keyEquals(psCurrentBinding, pcKey,
+                      uLength, puProbe)) {
+               if (piOld != NULL) *piOld = 1;
+               return ppsLink;
+            }
          }
       }
+   }
+
+   if (oSymTable->numBuckets == 0) return NULL;
 
-   psCurrentBinding = oSymTable->psFirstBucket;
+   hashNum = uHash & (oSymTable->numBuckets - 1);
+   for (ppsLink = &oSymTable->ppsBuckets[hashNum];
+        (psCurrentBinding = *ppsLink) != NULL;
+        ppsLink = &psCurrentBinding->psNextBinding)
+   {
+      if (psCurrentBinding->uHash == uHash
+          && SymTable_keyEquals(psCurrentBinding, pcKey, uLength,
+                puProbe)) {
+         if (piOld != NULL) *piOld = 0;
+         return ppsLink;
+      }
+   }
+   return NULL;
+}
 
-   oSymTable->psFirstBucket = nSymTable->psFirstBucket;
-   oSymTable->bucketCount = nSymTable->bucketCount;
-   oSymTable->bucketLevel = nSymTable->bucketLevel;
+/*--------------------------------------------------------------------*/
 
-   free(psCurrentBinding);
-   free(nSymTable);
+/*Return the binding of oSymTable whose key is pcKey, which is uLength
+characters long and has hash uHash, or NULL if there is no such
+binding.*/
+static struct SymTableBinding *SymTable_find(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength, size_t uHash)
+{
+   struct SymTableBinding **ppsLink;
 
-   return;
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash, NULL);
+   if (ppsLink == NULL) return NULL;
+   return *ppsLink;
 }
 
+/*--------------------------------------------------------------------*/
 
-int SymTable_put(SymTable_T oSymTable,
-     const char *pcKey, const void *pvValue)
+/*SymTable_findOrInsertHashed is SymTable_findOrInsertN for a key pcKey
+whose hash, uHash, is already known. If iBorrow is 1 (TRUE), a binding
+that it adds borrows pcKey as SymTable_putBorrowed does.*/
+static void **SymTable_findOrInsertHashed(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, size_t uHash, int iBorrow,
+     int *piInserted)
 {
    struct SymTableBinding *psNewBinding;
    size_t hashNum;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   /* A call that finds its key adds nothing, so it must not migrate:
+   migrating moves bindings, and while compacting copies them, which
+   would invalidate addresses that earlier calls returned. */
+   psNewBinding = SymTable_find(oSymTable, pcKey, uLength, uHash);
+   if (psNewBinding != NULL) {
+      *piInserted = 0;
+      return &psNewBinding->pvValue;
+   }
 
-   if (SymTable_contains(oSymTable, pcKey)) return 0;
+   /* Migrating never moves a binding into the old buckets, so pcKey is
+   still absent, and the binding added below is in the new buckets,
+   which migrating leaves in place. */
+   SymTable_migrate(oSymTable, MIGRATE_STEP);
 
-   oSymTable->bucketCount++;
+   if (oSymTable->numBuckets == 0 
+       && !SymTable_startResize(oSymTable, INITIAL_BUCKET_COUNT, 0))
+      return NULL;
 
-   psNewBinding = 
-   (struct SymTableBinding*)malloc(sizeof(struct SymTableBinding));
+   psNewBinding = SymTable_allocBinding(&oSymTable->sPool);
    if (psNewBinding == NULL)
-      return 0;
+      return NULL;
+
+   if (!SymTable_setKey(&oSymTable->sPool, psNewBinding, pcKey,
+          uLength, iBorrow)) {
+      SymTable_releaseBinding(&oSymTable->sPool, psNewBinding);
+      return NULL;
+   }
 
-   psNewBinding->pcKey = (char *)malloc(strlen(pcKey) + 1);
-   if (psNewBinding->pcKey == NULL)
-      return 0;
+   psNewBinding->pvValue = NULL;
+   psNewBinding->uHash = uHash;
 
-   strcpy((char*)psNewBinding->pcKey, pcKey);
-   psNewBinding->pvValue = (void*) pvValue;
-   psNewBinding->psNextBinding = NULL;
+   /* New bindings always go into the new buckets. */
+   hashNum = uHash & (oSymTable->numBuckets - 1);
+   psNewBinding->psNextBinding = oSymTable->ppsBuckets[hashNum];
+   oSymTable->ppsBuckets[hashNum] = psNewBinding;
+   oSymTable->bucketCount++;
 
-   hashNum = 
-   SymTable_hash(pcKey, abucketCount[oSymTable->bucketLevel]);
+   /* Growing moves no binding that is already in the new buckets, so
+   the address of psNewBinding->pvValue stays valid. */
+   if (oSymTable->bucketCount > oSymTable->numBuckets)
+      SymTable_grow(oSymTable);
 
-   psNewBinding->psNextBinding =
-   (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-   (oSymTable->psFirstBucket + hashNum)->psNextBinding = psNewBinding;
+   *piInserted = 1;
+   return &psNewBinding->pvValue;
+}
 
-   if ((oSymTable->bucketCount > abucketCount[oSymTable->bucketLevel]) 
-         && oSymTable->bucketLevel != 7) {
-            SymTable_rehash(oSymTable);
-         }
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   return SymTable_findOrInsertHashed(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength), 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
 
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
    return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   size_t uLength;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* A key short enough to be inline is copied anyway; that costs no
+   allocation. */
+   uLength = strlen(pcKey);
+   ppvValue = SymTable_findOrInsertHashed(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength), 1, &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue) 
+{
+   struct SymTableBinding *psBinding;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (psBinding == NULL) return NULL;
+
+   oldVal = psBinding->pvValue;
+   psBinding->pvValue = (void*) pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
 void *SymTable_replace(SymTable_T oSymTable,
     const char *pcKey, const void *pvValue) 
 {
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_removeHashed is SymTable_removeN for a key pcKey whose hash,
+uHash, is already known.*/
+static void *SymTable_removeHashed(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength, size_t uHash)
+{
+   struct SymTableBinding **ppsLink;
    struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
-   size_t hashNum;
+   struct SymTablePool *psPool;
+   int iOld;
+   void *oldVal;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   hashNum = 
-   SymTable_hash(pcKey, abucketCount[oSymTable->bucketLevel]);
+   SymTable_migrate(oSymTable, MIGRATE_STEP);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash, &iOld);
+   if (ppsLink == NULL) return NULL;
+
+   /* ppsLink is the bucket or psNextBinding field that points to
+   psCurrentBinding, so unlinking is the same at any position. */
+   psCurrentBinding = *ppsLink;
+   oldVal = psCurrentBinding->pvValue;
+   *ppsLink = psCurrentBinding->psNextBinding;
+
+   /* While compacting, bindings in the old buckets belong to the old
+   pool; a binding in the new buckets belongs to the new pool even if
+   its old bucket is not migrated yet, since it was put after the
+   shrink began. */
+   psPool = &oSymTable->sPool;
+   if (oSymTable->iCompacting && iOld)
+      psPool = &oSymTable->sOldPool;
+   SymTable_releaseBindingKey(psPool, psCurrentBinding);
+   SymTable_releaseBinding(psPool, psCurrentBinding);
+
+   oSymTable->bucketCount--;
+   if (oSymTable->numBuckets > INITIAL_BUCKET_COUNT
+       && oSymTable->bucketCount * SHRINK_LOAD_DEN
+            < oSymTable->numBuckets)
+      SymTable_shrink(oSymTable);
+   return oldVal;
+}
 
-   for (psCurrentBinding = 
-            (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-        psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
-   {
-      psNextBinding = psCurrentBinding->psNextBinding;
-      if (!strcmp(pcKey, psCurrentBinding->pcKey)) {
-         void *oldVal;
-         oldVal = psCurrentBinding->pvValue;
-         psCurrentBinding->pvValue = (void*) pvValue;
-         return oldVal;
-      }
-   }
-   return NULL;
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength) 
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_removeHashed(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
 }
 
+/*--------------------------------------------------------------------*/
+
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) 
 {
-   struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNext;
-   size_t hashNum;
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableBinding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (psBinding == NULL) return NULL;
+   return psBinding->pvValue;
+}
 
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   hashNum = 
-   SymTable_hash(pcKey, abucketCount[oSymTable->bucketLevel]);
+   return SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength)) != NULL;
+}
 
-   psCurrentBinding = 
-      (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-   if (psCurrentBinding == NULL) return NULL;
-   psNext = psCurrentBinding->psNextBinding;
+/*--------------------------------------------------------------------*/
 
-   if (!strcmp(psCurrentBinding->pcKey, pcKey)) {
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
 
-      void *oldVal = psCurrentBinding->pvValue;
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
 
-      (oSymTable->psFirstBucket + hashNum)->psNextBinding = psNext;
+/*--------------------------------------------------------------------*/
 
-      free((char*) psCurrentBinding->pcKey);
-      free(psCurrentBinding);
+/*SymTable_hashBatch sets auLengths[i] and auHashes[i] to the length
+and hash of apcKeys[i] for each i below uCount, and prefetches the
+bucket, old or new, that holds the key in oSymTable.*/
+static void SymTable_hashBatch(SymTable_T oSymTable, size_t uCount,
+   const char *const apcKeys[], size_t auLengths[], size_t auHashes[])
+{
+   size_t hashNum;
+   size_t i;
 
-      oSymTable->bucketCount--;
+   assert(oSymTable != NULL);
 
-      return oldVal;
+   for (i = 0; i < uCount; i++) {
+      auLengths[i] = strlen(apcKeys[i]);
+      auHashes[i] = SymTable_hash(oSymTable, apcKeys[i], auLengths[i]);
+      if (oSymTable->ppsOldBuckets != NULL) {
+         hashNum = auHashes[i] & (oSymTable->numOldBuckets - 1);
+         if (hashNum >= oSymTable->migrateNum)
+            SymTable_prefetch(&oSymTable->ppsOldBuckets[hashNum]);
+      }
+      if (oSymTable->numBuckets != 0)
+         SymTable_prefetch(&oSymTable->ppsBuckets[
+            auHashes[i] & (oSymTable->numBuckets - 1)]);
    }
+}
 
-   while (psCurrentBinding->psNextBinding != NULL) {
-      psNext = psCurrentBinding->psNextBinding;
-      if (!strcmp(psNext->pcKey, pcKey)) {
-         void *oldVal = psNext->pvValue;
+/*--------------------------------------------------------------------*/
 
-         if (psNext->psNextBinding == NULL) 
-            psCurrentBinding->psNextBinding = NULL;
-         else 
-         psCurrentBinding->psNextBinding = psNext->psNextBinding;
-         
-         free((char*)psNext->pcKey);
-         free(psNext);
+void SymTable_getBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[])
+{
+   size_t auLengths[BATCH_STEP];
+   size_t auHashes[BATCH_STEP];
+   struct SymTableBinding *psBinding;
+   size_t uFirst;
+   size_t uStep;
+   size_t i;
 
-         oSymTable->bucketCount--;
+   assert(oSymTable != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
+
+   for (uFirst = 0; uFirst < uCount; uFirst += uStep) {
+      uStep = uCount - uFirst;
+      if (uStep > BATCH_STEP) uStep = BATCH_STEP;
+
+      SymTable_hashBatch(oSymTable, uStep, &apcKeys[uFirst],
+         auLengths, auHashes);
+
+      /* Once the buckets have arrived, prefetch the first binding of
+      each, and then the key of that binding if its hash matches and
+      the key is not inline. The bindings of the old buckets, if any,
+      are left to the lookup. */
+      if (oSymTable->numBuckets != 0) {
+         for (i = 0; i < uStep; i++) {
+            psBinding = oSymTable->ppsBuckets[
+               auHashes[i] & (oSymTable->numBuckets - 1)];
+            if (psBinding != NULL) SymTable_prefetch(psBinding);
+         }
+         for (i = 0; i < uStep; i++) {
+            psBinding = oSymTable->ppsBuckets[
+               auHashes[i] & (oSymTable->numBuckets - 1)];
+            if (psBinding != NULL && psBinding->uHash == auHashes[i]
+                && SymTable_keyForm(psBinding) != KEY_INLINE)
+               SymTable_prefetch(psBinding->uKey.pcKey);
+         }
+      }
 
-         return oldVal;
+      for (i = 0; i < uStep; i++) {
+         psBinding = SymTable_find(oSymTable, apcKeys[uFirst + i],
+            auLengths[i], auHashes[i]);
+         apvValues[uFirst + i] =
+            psBinding == NULL ? NULL : psBinding->pvValue;
       }
-      psCurrentBinding = psCurrentBinding->psNextBinding;
    }
+}
 
-   return NULL;
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *const apvValues[])
+{
+   size_t auLengths[BATCH_STEP];
+   size_t auHashes[BATCH_STEP];
+   void **ppvValue;
+   int iInserted;
+   size_t uAdded = 0;
+   size_t uFirst;
+   size_t uStep;
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
+
+   for (uFirst = 0; uFirst < uCount; uFirst += uStep) {
+      uStep = uCount - uFirst;
+      if (uStep > BATCH_STEP) uStep = BATCH_STEP;
+
+      /* A put may start a resize, after which some of the prefetched
+      buckets are no longer the ones used; they cost a wasted
+      prefetch, not a wrong result. */
+      SymTable_hashBatch(oSymTable, uStep, &apcKeys[uFirst],
+         auLengths, auHashes);
+
+      for (i = 0; i < uStep; i++) {
+         ppvValue = SymTable_findOrInsertHashed(oSymTable,
+            apcKeys[uFirst + i], auLengths[i], auHashes[i], 0,
+            &iInserted);
+         if (ppvValue != NULL && iInserted) {
+            *ppvValue = apvValues[uFirst + i];
+            uAdded++;
+         }
+      }
+   }
+   return uAdded;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+void SymTable_removeBatch(SymTable_T oSymTable, size_t uCount,
+     const char *const apcKeys[], void *apvValues[])
 {
-   struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
-   size_t hashNum;
+   size_t auLengths[BATCH_STEP];
+   size_t auHashes[BATCH_STEP];
+   size_t uFirst;
+   size_t uStep;
+   size_t i;
 
    assert(oSymTable != NULL);
-   assert(pcKey != NULL);
+   assert(uCount == 0 || (apcKeys != NULL && apvValues != NULL));
 
-   hashNum = 
-   SymTable_hash(pcKey, abucketCount[oSymTable->bucketLevel]);
+   for (uFirst = 0; uFirst < uCount; uFirst += uStep) {
+      uStep = uCount - uFirst;
+      if (uStep > BATCH_STEP) uStep = BATCH_STEP;
 
-   for (psCurrentBinding = 
-         (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-        psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
-   {
-      psNextBinding = psCurrentBinding->psNextBinding;
-      
-      if (!strcmp(pcKey, psCurrentBinding->pcKey)) {
-         return psCurrentBinding->pvValue;
-      }
+      SymTable_hashBatch(oSymTable, uStep, &apcKeys[uFirst],
+         auLengths, auHashes);
+
+      for (i = 0; i < uStep; i++)
+         apvValues[uFirst + i] = SymTable_removeHashed(oSymTable,
+            apcKeys[uFirst + i], auLengths[i], auHashes[i]);
    }
-   return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+/* Return the number of bindings handed out from psSlab, a slab of
+   psPool. */
+static size_t SymTable_slabUsed(const struct SymTablePool *psPool,
+   const struct SymTableSlab *psSlab)
 {
-   struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
-   size_t hashNum;
+   assert(psPool != NULL);
+   assert(psSlab != NULL);
 
-   assert(oSymTable != NULL);
-   assert(pcKey != NULL);
+   /* Only the first slab of a pool can have bindings left to hand
+   out. */
+   if (psSlab == psPool->psSlabs) return psPool->uSlabUsed;
+   return psSlab->uCapacity;
+}
 
-   hashNum = 
-   SymTable_hash(pcKey, abucketCount[oSymTable->bucketLevel]);
+/*--------------------------------------------------------------------*/
 
-   for (psCurrentBinding = 
-         (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-        psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
-   {
-      psNextBinding = psCurrentBinding->psNextBinding;
-      if (!strcmp(psCurrentBinding->pcKey, pcKey)) return 1;
+/* Point psIter at the first binding in use at or after index uIndex of
+   psSlab, a slab of the pool psIter->pvContainer, continuing through
+   the later slabs of that pool and then of the old pool, or finish
+   psIter if there is none. */
+static void SymTable_iterFrom(SymTable_Iter *psIter,
+   struct SymTableSlab *psSlab, size_t uIndex)
+{
+   SymTable_T oSymTable;
+   struct SymTablePool *psPool;
+   struct SymTableBinding *psBinding;
+   size_t uUsed;
+
+   assert(psIter != NULL);
+
+   oSymTable = psIter->oSymTable;
+   psPool = (struct SymTablePool*)psIter->pvContainer;
+
+   for (;;) {
+      for (; psSlab != NULL; psSlab = psSlab->psNextSlab, uIndex = 0) {
+         uUsed = SymTable_slabUsed(psPool, psSlab);
+         for (; uIndex < uUsed; uIndex++) {
+            psBinding = &psSlab->asBindings[uIndex];
+            if (SymTable_keyForm(psBinding) != KEY_FREE) {
+               psIter->pvContainer = psPool;
+               psIter->pvPosition = psSlab;
+               psIter->uIndex = uIndex;
+               psIter->pcKey = SymTable_key(psBinding);
+               psIter->pvValue = psBinding->pvValue;
+               return;
+            }
+         }
+      }
+
+      /* Only while compacting does the old pool hold bindings. */
+      if (psPool != &oSymTable->sPool) break;
+      psPool = &oSymTable->sOldPool;
+      psSlab = psPool->psSlabs;
    }
-   return 0;
+
+   psIter->pvPosition = NULL;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the iteration walks the slabs of the table rather than its
+   buckets, reading memory in address order, and skips the free
+   bindings. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvContainer = &oSymTable->sPool;
+   SymTable_iterFrom(psIter, oSymTable->sPool.psSlabs, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pvPosition != NULL);
+
+   SymTable_iterFrom(psIter, (struct SymTableSlab*)psIter->pvPosition,
+      psIter->uIndex + 1);
 }
 
 /*--------------------------------------------------------------------*/
 
+/* An iteration of a hash table holds nothing that must be
+   released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   psIter->pvPosition = NULL;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the map walks the slabs, like an iteration. */
 void SymTable_map(SymTable_T oSymTable,
      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
      const void *pvExtra)
 {
-   struct SymTableBinding *psCurrentBinding;
-   size_t hashNum;
+   SymTable_Iter sIter;
 
    assert(oSymTable != NULL);
    assert(pfApply != NULL);
 
-   for (hashNum = 0; 
-         hashNum < abucketCount[oSymTable->bucketLevel]; 
-         hashNum++) 
-   {
-      for (psCurrentBinding = 
-            (oSymTable->psFirstBucket + hashNum)->psNextBinding;
-            psCurrentBinding != NULL;
-            psCurrentBinding = psCurrentBinding->psNextBinding)
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+      (*pfApply)(sIter.pcKey, sIter.pvValue, (void*)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of
+   the iPartCount parts of pvTable, a SymTable. Slab i, counting
+   through the current pool and then the old one, belongs to part i
+   modulo the part count; all but the first few slabs of a pool are
+   the same size, so the parts are about equal, and each reads its
+   slabs in address order. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   struct SymTablePool *apsPools[2];
+   struct SymTableSlab *psSlab;
+   struct SymTableBinding *psBinding;
+   size_t uSlab = 0;
+   size_t uUsed;
+   size_t uIndex;
+   int iPool;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   apsPools[0] = &oSymTable->sPool;
+   apsPools[1] = &oSymTable->sOldPool;
+
+   for (iPool = 0; iPool < 2; iPool++) {
+      for (psSlab = apsPools[iPool]->psSlabs; psSlab != NULL;
+           psSlab = psSlab->psNextSlab, uSlab++)
       {
-         (*pfApply)((void*)psCurrentBinding->pcKey, 
-         (void*) psCurrentBinding->pvValue, (void*)pvExtra);
+         if (uSlab % (size_t)iPartCount != (size_t)iPart)
+            continue;
+         uUsed = SymTable_slabUsed(apsPools[iPool], psSlab);
+         for (uIndex = 0; uIndex < uUsed; uIndex++) {
+            psBinding = &psSlab->asBindings[uIndex];
+            if (SymTable_keyForm(psBinding) != KEY_FREE)
+               (*pfApply)(SymTable_key(psBinding),
+                  psBinding->pvValue,
+                  pvExtra);
+         }
       }
    }
-}
\ No newline at end of file
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
@@ -0,0 +1,165 @@
+/*A SymTableInt is a SymTableWord (see symtableword.h) whose uintptr_t
+keys are the client's long keys. A long converts to a uintptr_t and
+back unchanged, and distinct longs convert to distinct uintptr_ts.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include "symtableint.h"
+#include "symtableword.h"
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableInt holds the SymTableWord that stores its bindings. */
+struct SymTableInt
+{
+   /*The table of the bindings, keyed on the conversion of each key*/
+   SymTableWord_T oSymTableWord;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableIntApply is a call of SymTableInt_map, passed as the extra
+parameter of SymTableWord_map. */
+struct SymTableIntApply
+{
+   /*The function of the client*/
+   void (*pfApply)(long lKey, void *pvValue, void *pvExtra);
+
+   /*The extra parameter of the client*/
+   void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableInt_T SymTableInt_new(void)
+{
+   SymTableInt_T oSymTableInt;
+
+   oSymTableInt = (SymTableInt_T)malloc(sizeof(struct SymTableInt));
+   if (oSymTableInt == NULL) return NULL;
+
+   oSymTableInt->oSymTableWord = SymTableWord_new();
+   if (oSymTableInt->oSymTableWord == NULL) {
+      free(oSymTableInt);
+      return NULL;
+   }
+
+   return oSymTableInt;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTableInt_free(SymTableInt_T oSymTableInt)
+{
+   assert(oSymTableInt != NULL);
+
+   SymTableWord_free(oSymTableInt->oSymTableWord);
+   free(oSymTableInt);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt)
+{
+   assert(oSymTableInt != NULL);
+
+   return SymTableWord_getLength(oSymTableInt->oSymTableWord);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTableInt_put(SymTableInt_T oSymTableInt, long lKey,
+     const void *pvValue)
+{
+   assert(oSymTableInt != NULL);
+
+   return SymTableWord_put(oSymTableInt->oSymTableWord,
+      (uintptr_t)lKey, (void*)pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, long lKey,
+     const void *pvValue)
+{
+   void *oldVal;
+
+   assert(oSymTableInt != NULL);
+
+   if (!SymTableWord_replace(oSymTableInt->oSymTableWord,
+          (uintptr_t)lKey, (void*)pvValue, &oldVal))
+      return NULL;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTableInt_contains(SymTableInt_T oSymTableInt, long lKey)
+{
+   assert(oSymTableInt != NULL);
+
+   return SymTableWord_contains(oSymTableInt->oSymTableWord,
+      (uintptr_t)lKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTableInt_get(SymTableInt_T oSymTableInt, long lKey)
+{
+   void **ppvValue;
+
+   assert(oSymTableInt != NULL);
+
+   ppvValue = SymTableWord_get(oSymTableInt->oSymTableWord,
+      (uintptr_t)lKey);
+   if (ppvValue == NULL) return NULL;
+   return *ppvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, long lKey)
+{
+   void *oldVal;
+
+   assert(oSymTableInt != NULL);
+
+   if (!SymTableWord_remove(oSymTableInt->oSymTableWord,
+          (uintptr_t)lKey, &oldVal))
+      return NULL;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of pvApply, a SymTableIntApply, to the binding
+   whose converted key is uKey and whose value is *ppvValue. */
+static void SymTableInt_applyWord(uintptr_t uKey, void **ppvValue,
+   void *pvApply)
+{
+   struct SymTableIntApply *psApply =
+      (struct SymTableIntApply*)pvApply;
+
+   assert(ppvValue != NULL);
+   assert(psApply != NULL);
+
+   (*psApply->pfApply)((long)uKey, *ppvValue,
+      psApply->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+     void (*pfApply)(long lKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableIntApply sApply;
+
+   assert(oSymTableInt != NULL);
+   assert(pfApply != NULL);
+
+   sApply.pfApply = pfApply;
+   sApply.pvExtra = (void*)pvExtra;
+   SymTableWord_map(oSymTableInt->oSymTableWord, SymTableInt_applyWord,
+      &sApply);
+}
@@ -0,0 +1,57 @@
+/*A SymTableInt is a symbol table whose keys are integers rather than
+strings. It offers the same operations as a SymTable (see symtable.h),
+but keeps each key inline beside its value, so that it neither formats
+integers into strings nor copies, hashes or compares strings. Any long,
+including 0 and negative numbers, is a valid key.*/
+
+#include <stddef.h>
+
+#ifndef SYMTABLEINT_INCLUDED
+#define SYMTABLEINT_INCLUDED
+
+/* A SymTableInt_T is a pointer to a SymTableInt ADT*/
+typedef struct SymTableInt *SymTableInt_T;
+
+/*SymTableInt_new returns a new SymTableInt object that contains no
+bindings, or NULL if insufficient memory is available.*/
+SymTableInt_T SymTableInt_new(void);
+
+/*SymTableInt_free frees all memory occupied by oSymTableInt.*/
+void SymTableInt_free(SymTableInt_T oSymTableInt);
+
+/*SymTableInt_getLength returns the number of bindings in
+oSymTableInt.*/
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt);
+
+/*If oSymTableInt does not contain a binding with key lKey, then
+SymTableInt_put adds a binding consisting of lKey and pvValue and
+returns 1 (TRUE). Otherwise, or if insufficient memory is available,
+it leaves oSymTableInt unchanged and returns 0 (FALSE).*/
+int SymTableInt_put(SymTableInt_T oSymTableInt, long lKey,
+     const void *pvValue);
+
+/*SymTableInt_replace replaces the value of the binding of oSymTableInt
+with key lKey by pvValue and returns the old value, or returns NULL if
+there is no such binding.*/
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, long lKey,
+     const void *pvValue);
+
+/*SymTableInt_contains returns 1 (TRUE) if oSymTableInt contains a
+binding with key lKey, and 0 (FALSE) if not.*/
+int SymTableInt_contains(SymTableInt_T oSymTableInt, long lKey);
+
+/*SymTableInt_get returns the value of the binding of oSymTableInt with
+key lKey, or NULL if there is none.*/
+void *SymTableInt_get(SymTableInt_T oSymTableInt, long lKey);
+
+/*SymTableInt_remove removes the binding of oSymTableInt with key lKey
+and returns its value, or returns NULL if there is none.*/
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, long lKey);
+
+/*SymTableInt_map calls (*pfApply)(lKey, pvValue, pvExtra) for each
+lKey/pvValue binding of oSymTableInt.*/
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+     void (*pfApply)(long lKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+#endif
@@ -20,6 +20,15 @@ struct SymTableBinding
    /*The key associated with the binding, used to locate the value*/
    const char *pcKey;
 
+   /*The length of pcKey, so that keys of other lengths are rejected
+   without comparing them*/
+   size_t uLength;
+
+   /*1 (TRUE) if pcKey belongs to the client, which added the binding
+   with SymTable_putBorrowed, or 0 (FALSE) if it is a copy that the
+   binding owns*/
+   int iBorrowed;
+
    /*The pointer to the value associated with the binding*/
    void *pvValue;
 
@@ -35,10 +44,30 @@ struct SymTable
 {
    /* The address of the first SymTableBinding. */
    struct SymTableBinding *psFirstBinding;
+
+   /* The number of bindings in the list, so that SymTable_getLength
+   need not walk it. */
+   size_t bindingCount;
+
+   /* How SymTable_getN reorders the list: one of the
+   SYMTABLE_REORDER values. */
+   int iReorder;
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Free psBinding, and its key unless the key is borrowed. */
+static void SymTable_freeBinding(struct SymTableBinding *psBinding)
+{
+   assert(psBinding != NULL);
+
+   if (!psBinding->iBorrowed)
+      free((char*)psBinding->pcKey);
+   free(psBinding);
+}
+
+/*--------------------------------------------------------------------*/
+
 SymTable_T SymTable_new(void)
 {
    SymTable_T oSymTable;
@@ -48,11 +77,25 @@ SymTable_T SymTable_new(void)
       return NULL;
 
    oSymTable->psFirstBinding = NULL;
+   oSymTable->bindingCount = 0;
+   oSymTable->iReorder = SYMTABLE_REORDER_NONE;
    return oSymTable;
 }
 
 /*--------------------------------------------------------------------*/
 
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   /* A list compares keys directly, so it has no use for pfHash. */
+   assert(pfHash != NULL);
+   (void)pfHash;
+
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_free(SymTable_T oSymTable)
 {
    struct SymTableBinding *psCurrentBinding;
@@ -65,8 +108,7 @@ void SymTable_free(SymTable_T oSymTable)
         psCurrentBinding = psNextBinding)
    {
       psNextBinding = psCurrentBinding->psNextBinding;
-      free((void*)psCurrentBinding->pcKey);
-      free(psCurrentBinding);
+      SymTable_freeBinding(psCurrentBinding);
    }
 
    free(oSymTable);
@@ -74,23 +116,132 @@ void SymTable_free(SymTable_T oSymTable)
 
 /*--------------------------------------------------------------------*/
 
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+
+   oSymTable->iReorder = iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
 size_t SymTable_getLength(SymTable_T oSymTable) 
 {
-   size_t n = 0;
+   assert(oSymTable != NULL);
+
+   return oSymTable->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the key of psBinding is the uLength characters
+   at pcKey, or 0 (FALSE) otherwise. Keys of other lengths are
+   rejected without reading them. */
+static int SymTable_keyEquals(const struct SymTableBinding *psBinding,
+     const char *pcKey, size_t uLength)
+{
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
+
+   return psBinding->uLength == uLength
+      && !memcmp(psBinding->pcKey, pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_findOrAdd is SymTable_findOrInsertN, except that if
+   iBorrow is 1 (TRUE), a binding that it adds borrows pcKey, which
+   must then be followed by '\0', instead of copying it. */
+static void **SymTable_findOrAdd(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int iBorrow, int *piInserted)
+{
    struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
+   struct SymTableBinding *psNewBinding;
+   char *pcCopy;
 
    assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
 
    for (psCurrentBinding = oSymTable->psFirstBinding;
         psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
+        psCurrentBinding = psCurrentBinding->psNextBinding)
    {
-      psNextBinding = psCurrentBinding->psNextBinding;
-      n++;
+      if (SymTable_keyEquals(psCurrentBinding, pcKey, uLength)) {
+         *piInserted = 0;
+         return &psCurrentBinding->pvValue;
+      }
    }
 
-   return n;
+   psNewBinding = 
+   (struct SymTableBinding*)malloc(sizeof(struct SymTableBinding));
+   if (psNewBinding == NULL)
+      return NULL;
+
+   if (iBorrow)
+      psNewBinding->pcKey = pcKey;
+   else {
+      pcCopy = (char *)malloc(uLength + 1);
+      if (pcCopy == NULL) {
+         free(psNewBinding);
+         return NULL;
+      }
+      memcpy(pcCopy, pcKey, uLength);
+      pcCopy[uLength] = '\0';
+      psNewBinding->pcKey = pcCopy;
+   }
+   psNewBinding->uLength = uLength;
+   psNewBinding->iBorrowed = iBorrow;
+   psNewBinding->pvValue = NULL;
+   psNewBinding->psNextBinding = oSymTable->psFirstBinding;
+   oSymTable->psFirstBinding = psNewBinding;
+   oSymTable->bindingCount++;
+
+   *piInserted = 1;
+   return &psNewBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   return SymTable_findOrAdd(oSymTable, pcKey, uLength, 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
@@ -98,33 +249,35 @@ size_t SymTable_getLength(SymTable_T oSymTable)
 int SymTable_put(SymTable_T oSymTable,
      const char *pcKey, const void *pvValue)
 {
-   struct SymTableBinding *psNewBinding;
-
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   if (SymTable_contains(oSymTable, pcKey)) return 0;
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
 
-   psNewBinding = 
-   (struct SymTableBinding*)malloc(sizeof(struct SymTableBinding));
-   if (psNewBinding == NULL)
-      return 0;
+/*--------------------------------------------------------------------*/
 
-   psNewBinding->pcKey = (char *)malloc(strlen(pcKey) + 1);
-   if (psNewBinding->pcKey == NULL)
-      return 0;
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
 
-   strcpy((char*)psNewBinding->pcKey, pcKey);
-   psNewBinding->pvValue = (void*) pvValue;
-   psNewBinding->psNextBinding = oSymTable->psFirstBinding;
-   oSymTable->psFirstBinding = psNewBinding;
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), 1,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
    return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_replace(SymTable_T oSymTable,
-    const char *pcKey, const void *pvValue) 
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue) 
 {
    struct SymTableBinding *psCurrentBinding;
    struct SymTableBinding *psNextBinding;
@@ -137,7 +290,7 @@ void *SymTable_replace(SymTable_T oSymTable,
         psCurrentBinding = psNextBinding)
    {
       psNextBinding = psCurrentBinding->psNextBinding;
-      if (!strcmp(pcKey, psCurrentBinding->pcKey)) {
+      if (SymTable_keyEquals(psCurrentBinding, pcKey, uLength)) {
          void *oldVal;
          oldVal = psCurrentBinding->pvValue;
          psCurrentBinding->pvValue = (void*) pvValue;
@@ -149,7 +302,19 @@ void *SymTable_replace(SymTable_T oSymTable,
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) 
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) 
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength)
 {
    struct SymTableBinding *psCurrentBinding;
    struct SymTableBinding *psNext;
@@ -161,21 +326,21 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
    if (psCurrentBinding == NULL) return NULL;
    psNext = psCurrentBinding->psNextBinding;
 
-   if (!strcmp(psCurrentBinding->pcKey, pcKey)) {
+   if (SymTable_keyEquals(psCurrentBinding, pcKey, uLength)) {
 
       void *oldVal = psCurrentBinding->pvValue;
 
       oSymTable->psFirstBinding = psNext;
 
-      free((char*) psCurrentBinding->pcKey);
-      free(psCurrentBinding);
+      SymTable_freeBinding(psCurrentBinding);
+      oSymTable->bindingCount--;
 
       return oldVal;
    }
 
    while (psCurrentBinding->psNextBinding != NULL) {
       psNext = psCurrentBinding->psNextBinding;
-      if (!strcmp(psNext->pcKey, pcKey)) {
+      if (SymTable_keyEquals(psNext, pcKey, uLength)) {
          void *oldVal = psNext->pvValue;
 
          if (psNext->psNextBinding == NULL) 
@@ -183,8 +348,8 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
          else 
          psCurrentBinding->psNextBinding = psNext->psNextBinding;
          
-         free((char*)psNext->pcKey);
-         free(psNext);
+         SymTable_freeBinding(psNext);
+         oSymTable->bindingCount--;
 
          return oldVal;
       }
@@ -196,30 +361,74 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) 
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength)
 {
    struct SymTableBinding *psCurrentBinding;
-   struct SymTableBinding *psNextBinding;
+   struct SymTableBinding *psPrevBinding = NULL;
+   struct SymTableBinding *psPrevPrevBinding = NULL;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
    for (psCurrentBinding = oSymTable->psFirstBinding;
         psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
+        psCurrentBinding = psCurrentBinding->psNextBinding)
    {
-      psNextBinding = psCurrentBinding->psNextBinding;
-      
-      if (!strcmp(pcKey, psCurrentBinding->pcKey)) {
-         return psCurrentBinding->pvValue;
-      }
+      if (SymTable_keyEquals(psCurrentBinding, pcKey, uLength))
+         break;
+      psPrevPrevBinding = psPrevBinding;
+      psPrevBinding = psCurrentBinding;
    }
-   return NULL;
+   if (psCurrentBinding == NULL) return NULL;
+
+   /* The first binding stays where it is under either policy. */
+   if (psPrevBinding == NULL) return psCurrentBinding->pvValue;
+
+   switch (oSymTable->iReorder) {
+      case SYMTABLE_REORDER_MOVE_TO_FRONT:
+         psPrevBinding->psNextBinding = psCurrentBinding->psNextBinding;
+         psCurrentBinding->psNextBinding = oSymTable->psFirstBinding;
+         oSymTable->psFirstBinding = psCurrentBinding;
+         break;
+      case SYMTABLE_REORDER_TRANSPOSE:
+         psPrevBinding->psNextBinding = psCurrentBinding->psNextBinding;
+         psCurrentBinding->psNextBinding = psPrevBinding;
+         if (psPrevPrevBinding == NULL)
+            oSymTable->psFirstBinding = psCurrentBinding;
+         else
+            psPrevPrevBinding->psNextBinding = psCurrentBinding;
+         break;
+      default:
+         break;
+   }
+   return psCurrentBinding->pvValue;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength)
 {
    struct SymTableBinding *psCurrentBinding;
    struct SymTableBinding *psNextBinding;
@@ -232,13 +441,75 @@ int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
         psCurrentBinding = psNextBinding)
    {
       psNextBinding = psCurrentBinding->psNextBinding;
-      if (!strcmp(psCurrentBinding->pcKey, pcKey)) return 1;
+      if (SymTable_keyEquals(psCurrentBinding, pcKey, uLength))
+         return 1;
    }
    return 0;
 }
 
 /*--------------------------------------------------------------------*/
 
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at psBinding, or finish it if psBinding is NULL. */
+static void SymTable_iterAt(SymTable_Iter *psIter,
+     struct SymTableBinding *psBinding)
+{
+   assert(psIter != NULL);
+
+   psIter->pvPosition = psBinding;
+   if (psBinding == NULL) {
+      psIter->pcKey = NULL;
+      psIter->pvValue = NULL;
+      return;
+   }
+   psIter->pcKey = psBinding->pcKey;
+   psIter->pvValue = psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->uIndex = 0;
+   SymTable_iterAt(psIter, oSymTable->psFirstBinding);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pvPosition != NULL);
+
+   SymTable_iterAt(psIter,
+      ((struct SymTableBinding*)psIter->pvPosition)->psNextBinding);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration of a list holds nothing that must be released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   SymTable_iterAt(psIter, NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_map(SymTable_T oSymTable,
      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
      const void *pvExtra)
@@ -254,4 +525,44 @@ void SymTable_map(SymTable_T oSymTable,
       (*pfApply)((void*)psCurrentBinding->pcKey, 
       (void*) psCurrentBinding->pvValue, (void*)pvExtra);
    
-}
\ No newline at end of file
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A list cannot be split into parts without walking it first, so the
+   parallel functions apply pfApply to every binding on the calling
+   thread. */
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+   (void)iThreadCount;
+
+   SymTable_map(oSymTable, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here every binding is applied to apvAccumulators[0], and the other
+   accumulators are merged into it as they were set up. */
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   int i;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymTable_map(oSymTable, pfApply, apvAccumulators[0]);
+   for (i = 1; i < iThreadCount; i++)
+      (*pfMerge)(apvAccumulators[0], apvAccumulators[i]);
+}
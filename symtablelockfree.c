@@ -0,0 +1,1431 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation is a lock-free split-ordered list (Shalev and
+Shavit) that any number of threads may use at once. All bindings are
+kept in a single lock-free linked list (Harris and Michael), sorted by
+the bit-reversed hash of their keys, so that the bindings of every
+bucket are contiguous. Each bucket points to a dummy node where its
+bindings begin, and doubling or halving the bucket count only adds or
+removes dummy nodes, never moving a binding. Nodes that SymTable_remove
+unlinks are freed through epoch-based reclamation once no thread can
+still be reading them. SymTable_new, SymTable_newWithHash and
+SymTable_free must not run concurrently with any other call on the
+same table. This file requires C11.*/
+
+/* Request POSIX declarations, for thread-specific data. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+/*The number of buckets of a new table, and of the first segment of the
+bucket directory. Each later segment has as many buckets as all the
+segments before it, so the directory never moves a bucket*/
+enum {INITIAL_BUCKET_COUNT = 64, LOG_INITIAL_BUCKET_COUNT = 6};
+
+/*The number of segments of the bucket directory, which caps the bucket
+count at INITIAL_BUCKET_COUNT << (SEGMENT_COUNT - 1)*/
+enum {SEGMENT_COUNT = 24};
+
+/*The table doubles its bucket count once it holds more than
+MAX_LOAD bindings per bucket, and halves it once it holds fewer than
+one binding per SHRINK_LOAD_DEN buckets*/
+enum {MAX_LOAD = 2, SHRINK_LOAD_DEN = 8};
+
+/*The binding count is split among COUNTER_COUNT counters, chosen by
+hash, so that threads inserting different keys rarely update the same
+cache line. Each counter is padded to COUNTER_SIZE bytes*/
+enum {COUNTER_COUNT = 16, COUNTER_SIZE = 128};
+
+/*After retiring RETIRE_THRESHOLD nodes, a thread tries to advance the
+global epoch, so that its retired nodes can eventually be freed*/
+enum {RETIRE_THRESHOLD = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableRetired heads every block of memory that can be retired,
+so that blocks waiting to be freed can be kept on a list without
+touching fields that other threads may still be reading. */
+struct SymTableRetired
+{
+   /*The next block retired in the same epoch by the same thread*/
+   struct SymTableRetired *psNextRetired;
+};
+
+/* A SymTableNode is either a binding or the dummy node where the
+bindings of a bucket begin. Nodes are linked into a single list sorted
+by uSortKey, then by key. */
+struct SymTableNode
+{
+   /*The header used once the node is retired*/
+   struct SymTableRetired sRetired;
+
+   /*The bit-reversed hash of the key, with the lowest bit set, for a
+   binding; the bit-reversed bucket index for a dummy node*/
+   uint64_t uSortKey;
+
+   /*The address of the next node, with the lowest bit set once this
+   node has been removed from the table*/
+   _Atomic uintptr_t uNext;
+
+   /*The value of the binding, or pvTombstone once the binding has been
+   removed. Unused in dummy nodes*/
+   void *_Atomic pvValue;
+
+   /*The length of pcKey*/
+   size_t uLength;
+
+   /*The key of the binding: acKey, or the client's own key if it was
+   borrowed with SymTable_putBorrowed*/
+   const char *pcKey;
+
+   /*The copy of the key, allocated with the node unless the key is
+   borrowed, and empty in dummy nodes*/
+   char acKey[];
+};
+
+/* A SymTablePaddedCount holds one of the counters of a table on cache
+lines of its own. */
+union SymTablePaddedCount
+{
+   _Atomic size_t uCount;
+   char acPad[COUNTER_SIZE];
+};
+
+/* A SymTable is the list of all its nodes, reached through a directory
+of bucket segments. Bucket b points to the dummy node of bucket b, or
+is NULL if that dummy node has not been added yet. */
+struct SymTable
+{
+   /*The binding counts, placed first so that the fields below share
+   no cache line with a counter*/
+   union SymTablePaddedCount auCounts[COUNTER_COUNT];
+
+   /*The number of buckets in use, always a power of two*/
+   _Atomic size_t uBucketCount;
+
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*The bucket segments, each allocated when first needed and kept
+   until the table is freed*/
+   struct SymTableNode *_Atomic *_Atomic appsSegments[SEGMENT_COUNT];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableEpochRecord tracks the epoch of one thread. Records are
+kept on a global list that is never shortened; a thread that exits
+leaves its record, and the nodes it has yet to free, to the next
+thread that needs one. */
+struct SymTableEpochRecord
+{
+   /*The global epoch observed on entry, shifted left by one, with the
+   lowest bit set while the thread is using a table*/
+   _Atomic uintptr_t uState;
+
+   /*1 if a thread owns the record, 0 if it can be taken*/
+   atomic_int iOwned;
+
+   /*The next record of the global list*/
+   struct SymTableEpochRecord *psNextRecord;
+
+   /*The following fields are used only by the owner of the record*/
+
+   /*The number of nested calls that the thread is in*/
+   unsigned uDepth;
+
+   /*The global epoch observed by the outermost call*/
+   uintptr_t uEpoch;
+
+   /*The blocks retired in each of the last three epochs, indexed by
+   epoch modulo 3*/
+   struct SymTableRetired *apsLimbo[3];
+
+   /*The number of blocks retired since the last attempt to advance
+   the global epoch*/
+   size_t uRetiredCount;
+};
+
+/* A SymTablePaddedRecord keeps a record on cache lines of its own. */
+union SymTablePaddedRecord
+{
+   struct SymTableEpochRecord sRecord;
+   char acPad[2 * COUNTER_SIZE];
+};
+
+/*The global epoch*/
+static _Atomic uintptr_t uGlobalEpoch;
+
+/*The epoch records of every thread that has used a table*/
+static struct SymTableEpochRecord *_Atomic psRecords;
+
+/*The record of the calling thread, or NULL*/
+static _Thread_local struct SymTableEpochRecord *psThreadRecord;
+
+/*The key whose destructor gives up the record of an exiting thread*/
+static pthread_key_t sRecordKey;
+static int iRecordKeyCreated;
+static pthread_once_t sRecordKeyOnce = PTHREAD_ONCE_INIT;
+
+/*The value of a removed binding. Its address is never a client's
+value*/
+static char cTombstone;
+static void *const pvTombstone = &cTombstone;
+
+/*--------------------------------------------------------------------*/
+
+/* Give up the record pvRecord of a thread that is exiting. */
+static void SymTable_releaseRecord(void *pvRecord)
+{
+   struct SymTableEpochRecord *psRecord =
+      (struct SymTableEpochRecord*)pvRecord;
+
+   assert(psRecord != NULL);
+
+   psRecord->uDepth = 0;
+   atomic_store(&psRecord->iOwned, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Create the key that releases records at thread exit. */
+static void SymTable_createRecordKey(void)
+{
+   iRecordKeyCreated =
+      pthread_key_create(&sRecordKey, SymTable_releaseRecord) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the epoch record of the calling thread, taking a released
+   record or adding a new one to the global list if the thread has
+   none yet. Return NULL if insufficient memory is available. */
+static struct SymTableEpochRecord *SymTable_record(void)
+{
+   struct SymTableEpochRecord *psRecord;
+   int iFree;
+
+   if (psThreadRecord != NULL) return psThreadRecord;
+
+   pthread_once(&sRecordKeyOnce, SymTable_createRecordKey);
+
+   for (psRecord = atomic_load(&psRecords); psRecord != NULL;
+        psRecord = psRecord->psNextRecord)
+   {
+      iFree = 0;
+      if (atomic_load_explicit(&psRecord->iOwned,
+             memory_order_relaxed) == 0
+          && atomic_compare_exchange_strong(&psRecord->iOwned,
+             &iFree, 1))
+         break;
+   }
+
+   if (psRecord == NULL) {
+      psRecord = (struct SymTableEpochRecord*)
+         calloc(1, sizeof(union SymTablePaddedRecord));
+      if (psRecord == NULL) return NULL;
+      atomic_init(&psRecord->uState, 0);
+      atomic_init(&psRecord->iOwned, 1);
+      psRecord->psNextRecord = atomic_load(&psRecords);
+      while (!atomic_compare_exchange_weak(&psRecords,
+                &psRecord->psNextRecord, psRecord));
+   }
+
+   /* Without the key, the record is simply never released. */
+   if (iRecordKeyCreated)
+      (void)pthread_setspecific(sRecordKey, psRecord);
+
+   psThreadRecord = psRecord;
+   return psRecord;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free every block of the list *ppsLimbo and empty the list. */
+static void SymTable_freeLimbo(struct SymTableRetired **ppsLimbo)
+{
+   struct SymTableRetired *psCurrent;
+   struct SymTableRetired *psNext;
+
+   assert(ppsLimbo != NULL);
+
+   for (psCurrent = *ppsLimbo; psCurrent != NULL; psCurrent = psNext) {
+      psNext = psCurrent->psNextRetired;
+      free(psCurrent);
+   }
+   *ppsLimbo = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Mark the calling thread as using a table, and return its record.
+   Nodes that the thread reaches from now until the matching call of
+   SymTable_exit are not freed. A thread that enters a new epoch first
+   frees the blocks it retired three or more epochs ago. Calls may
+   nest. */
+static struct SymTableEpochRecord *SymTable_enter(void)
+{
+   struct SymTableEpochRecord *psRecord;
+   uintptr_t uEpoch;
+
+   psRecord = SymTable_record();
+
+   /* Without a record the thread cannot read the table safely, and
+   most functions of symtable.h have no way to report the failure. */
+   if (psRecord == NULL) abort();
+
+   if (psRecord->uDepth++ == 0) {
+      uEpoch = atomic_load(&uGlobalEpoch);
+      atomic_store(&psRecord->uState, (uEpoch << 1) | 1);
+      /* The table must not be read before the store is visible to
+      threads advancing the epoch. */
+      atomic_thread_fence(memory_order_seq_cst);
+
+      if (psRecord->uEpoch != uEpoch) {
+         SymTable_freeLimbo(&psRecord->apsLimbo[uEpoch % 3]);
+         psRecord->uEpoch = uEpoch;
+      }
+   }
+   return psRecord;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Undo the matching call of SymTable_enter, whose record is
+   psRecord. */
+static void SymTable_exit(struct SymTableEpochRecord *psRecord)
+{
+   assert(psRecord != NULL);
+   assert(psRecord->uDepth > 0);
+
+   if (--psRecord->uDepth == 0)
+      atomic_store_explicit(&psRecord->uState, psRecord->uEpoch << 1,
+         memory_order_release);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Advance the global epoch if every thread that is using a table has
+   observed it. */
+static void SymTable_tryAdvance(void)
+{
+   struct SymTableEpochRecord *psRecord;
+   uintptr_t uEpoch;
+   uintptr_t uState;
+
+   uEpoch = atomic_load(&uGlobalEpoch);
+   for (psRecord = atomic_load(&psRecords); psRecord != NULL;
+        psRecord = psRecord->psNextRecord)
+   {
+      uState = atomic_load(&psRecord->uState);
+      if ((uState & 1) != 0 && (uState >> 1) != uEpoch) return;
+   }
+   (void)atomic_compare_exchange_strong(&uGlobalEpoch, &uEpoch,
+      uEpoch + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the block psRetired, which is no longer reachable from any
+   table, once no thread can still be reading it. psRecord is the
+   record of the calling thread, which must be using a table. */
+static void SymTable_retire(struct SymTableEpochRecord *psRecord,
+   struct SymTableRetired *psRetired)
+{
+   assert(psRecord != NULL);
+   assert(psRecord->uDepth > 0);
+   assert(psRetired != NULL);
+
+   psRetired->psNextRetired = psRecord->apsLimbo[psRecord->uEpoch % 3];
+   psRecord->apsLimbo[psRecord->uEpoch % 3] = psRetired;
+
+   if (++psRecord->uRetiredCount >= RETIRE_THRESHOLD) {
+      psRecord->uRetiredCount = 0;
+      SymTable_tryAdvance();
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return uValue with the order of its 64 bits reversed. */
+static uint64_t SymTable_reverse(uint64_t uValue)
+{
+   uValue = ((uValue >> 1) & UINT64_C(0x5555555555555555))
+      | ((uValue & UINT64_C(0x5555555555555555)) << 1);
+   uValue = ((uValue >> 2) & UINT64_C(0x3333333333333333))
+      | ((uValue & UINT64_C(0x3333333333333333)) << 2);
+   uValue = ((uValue >> 4) & UINT64_C(0x0f0f0f0f0f0f0f0f))
+      | ((uValue & UINT64_C(0x0f0f0f0f0f0f0f0f)) << 4);
+   uValue = ((uValue >> 8) & UINT64_C(0x00ff00ff00ff00ff))
+      | ((uValue & UINT64_C(0x00ff00ff00ff00ff)) << 8);
+   uValue = ((uValue >> 16) & UINT64_C(0x0000ffff0000ffff))
+      | ((uValue & UINT64_C(0x0000ffff0000ffff)) << 16);
+   return (uValue >> 32) | (uValue << 32);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the highest set bit of uValue, which must not
+   be 0. */
+static int SymTable_log2(size_t uValue)
+{
+   int iBit = 0;
+
+   assert(uValue != 0);
+
+#if defined(__GNUC__)
+   if (sizeof(size_t) == sizeof(unsigned long long))
+      return (int)(8 * sizeof(unsigned long long)) - 1
+         - __builtin_clzll((unsigned long long)uValue);
+#endif
+   while ((uValue >>= 1) != 0) iBit++;
+   return iBit;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the bucket whose dummy node precedes that of bucket
+   uBucket, which is uBucket without its highest set bit. uBucket must
+   not be 0. */
+static size_t SymTable_parent(size_t uBucket)
+{
+   return uBucket & ~((size_t)1 << SymTable_log2(uBucket));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of bucket uBucket of oSymTable, allocating its
+   segment if needed, or NULL if insufficient memory is available. */
+static struct SymTableNode *_Atomic *SymTable_slot(SymTable_T oSymTable,
+   size_t uBucket)
+{
+   struct SymTableNode *_Atomic *ppsSegment;
+   struct SymTableNode *_Atomic *ppsExpected = NULL;
+   size_t uFirst;
+   size_t uSize;
+   int iSegment;
+
+   assert(oSymTable != NULL);
+
+   if (uBucket < INITIAL_BUCKET_COUNT) {
+      iSegment = 0;
+      uFirst = 0;
+      uSize = INITIAL_BUCKET_COUNT;
+   }
+   else {
+      iSegment = SymTable_log2(uBucket) - LOG_INITIAL_BUCKET_COUNT + 1;
+      uFirst = (size_t)INITIAL_BUCKET_COUNT << (iSegment - 1);
+      uSize = uFirst;
+   }
+   assert(iSegment < SEGMENT_COUNT);
+
+   ppsSegment = atomic_load_explicit(&oSymTable->appsSegments[iSegment],
+      memory_order_acquire);
+   if (ppsSegment == NULL) {
+      /* All bits zero is a null pointer, atomic or not, on every
+      platform that this file supports. */
+      ppsSegment = (struct SymTableNode *_Atomic *)
+         calloc(uSize, sizeof(struct SymTableNode *_Atomic));
+      if (ppsSegment == NULL) return NULL;
+      if (!atomic_compare_exchange_strong(
+             &oSymTable->appsSegments[iSegment], &ppsExpected,
+             ppsSegment)) {
+         free(ppsSegment);
+         ppsSegment = ppsExpected;
+      }
+   }
+   return &ppsSegment[uBucket - uFirst];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0, or a positive number as the node
+   psNode sorts before, with, or after a node whose sort key is
+   uSortKey and whose key is pcKey, which is uLength characters long.
+   Keys with the same sort key are ordered by length first, so that
+   keys of other lengths are rejected without comparing them. pcKey is
+   ignored for dummy nodes. */
+static int SymTable_compare(const struct SymTableNode *psNode,
+   uint64_t uSortKey, const char *pcKey, size_t uLength)
+{
+   assert(psNode != NULL);
+
+   if (psNode->uSortKey != uSortKey)
+      return psNode->uSortKey < uSortKey ? -1 : 1;
+   if ((uSortKey & 1) == 0) return 0;
+   if (psNode->uLength != uLength)
+      return psNode->uLength < uLength ? -1 : 1;
+   return memcmp(psNode->pcKey, pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+static struct SymTableNode *SymTable_bucket(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket);
+
+/*SymTable_search finds where a node whose sort key is uSortKey and
+whose key is pcKey, which is uLength characters long, belongs in the
+list of oSymTable, starting from the dummy node of bucket uBucket. It
+sets *ppuPrev to the link that should point to such a node and
+*ppsCurrent to the node that link points to, which is the first node
+that does not sort before it, or NULL. Return 1 if *ppsCurrent is such
+a node, 0 otherwise. Along the way it unlinks every removed node that
+it passes, retiring bindings; dummy nodes are retired by whoever
+removed them. psRecord is the record of the calling thread.*/
+static int SymTable_search(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket,
+   uint64_t uSortKey, const char *pcKey, size_t uLength,
+   _Atomic uintptr_t **ppuPrev, struct SymTableNode **ppsCurrent)
+{
+   _Atomic uintptr_t *puPrev;
+   struct SymTableNode *psCurrent;
+   uintptr_t uCurrent;
+   uintptr_t uNext;
+   int iCompare;
+
+   assert(oSymTable != NULL);
+   assert(ppuPrev != NULL);
+   assert(ppsCurrent != NULL);
+
+retry:
+   puPrev = &SymTable_bucket(oSymTable, psRecord, uBucket)->uNext;
+   uCurrent = atomic_load_explicit(puPrev, memory_order_acquire);
+   if ((uCurrent & 1) != 0) goto retry;
+
+   for (;;) {
+      psCurrent = (struct SymTableNode*)uCurrent;
+      if (psCurrent == NULL) {
+         iCompare = 1;
+         break;
+      }
+
+      uNext = atomic_load_explicit(&psCurrent->uNext,
+         memory_order_acquire);
+
+      /* The node before psCurrent was removed, or psCurrent was
+      unlinked, since puPrev was read. */
+      if (atomic_load_explicit(puPrev, memory_order_acquire)
+          != uCurrent)
+         goto retry;
+
+      /* A binding whose value is the tombstone is already removed;
+      help its remover by marking it. */
+      if ((uNext & 1) == 0 && (psCurrent->uSortKey & 1) != 0
+          && atomic_load_explicit(&psCurrent->pvValue,
+                memory_order_acquire) == pvTombstone) {
+         (void)atomic_compare_exchange_strong(&psCurrent->uNext,
+            &uNext, uNext | 1);
+         continue;
+      }
+
+      if ((uNext & 1) == 0) {
+         iCompare = SymTable_compare(psCurrent, uSortKey, pcKey,
+            uLength);
+         if (iCompare >= 0) break;
+         puPrev = &psCurrent->uNext;
+      }
+      else {
+         uNext &= ~(uintptr_t)1;
+         if (!atomic_compare_exchange_strong_explicit(puPrev,
+                &uCurrent, uNext, memory_order_acq_rel,
+                memory_order_acquire))
+            goto retry;
+         if ((psCurrent->uSortKey & 1) != 0)
+            SymTable_retire(psRecord, &psCurrent->sRetired);
+      }
+      uCurrent = uNext;
+   }
+
+   *ppuPrev = puPrev;
+   *ppsCurrent = psCurrent;
+   return iCompare == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_insert links psNode into the list of oSymTable, starting the
+search from the dummy node of bucket uBucket. Return psNode, or the
+node already in the list with the same sort key and key, in which case
+psNode is left unlinked. psRecord is the record of the calling
+thread.*/
+static struct SymTableNode *SymTable_insert(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket,
+   struct SymTableNode *psNode)
+{
+   _Atomic uintptr_t *puPrev;
+   struct SymTableNode *psCurrent;
+   uintptr_t uCurrent;
+
+   assert(oSymTable != NULL);
+   assert(psNode != NULL);
+
+   for (;;) {
+      if (SymTable_search(oSymTable, psRecord, uBucket,
+             psNode->uSortKey, psNode->pcKey, psNode->uLength,
+             &puPrev, &psCurrent))
+         return psCurrent;
+
+      uCurrent = (uintptr_t)psCurrent;
+      atomic_store_explicit(&psNode->uNext, uCurrent,
+         memory_order_relaxed);
+      if (atomic_compare_exchange_strong_explicit(puPrev, &uCurrent,
+             (uintptr_t)psNode, memory_order_release,
+             memory_order_relaxed))
+         return psNode;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_removeDummy removes psDummy, the dummy node of bucket
+uBucket of oSymTable, which *ppsSlot pointed to. Only the thread that
+marks psDummy unlinks, clears and retires it, so that it is no longer
+reachable when it is retired. psRecord is the record of the calling
+thread.*/
+static void SymTable_removeDummy(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket,
+   struct SymTableNode *psDummy, struct SymTableNode *_Atomic *ppsSlot)
+{
+   _Atomic uintptr_t *puPrev;
+   struct SymTableNode *psCurrent;
+   struct SymTableNode *psExpected = psDummy;
+   uintptr_t uNext;
+
+   assert(oSymTable != NULL);
+   assert(uBucket != 0);
+   assert(psDummy != NULL);
+   assert(ppsSlot != NULL);
+
+   uNext = atomic_load(&psDummy->uNext);
+   do {
+      if ((uNext & 1) != 0) return;
+   } while (!atomic_compare_exchange_weak(&psDummy->uNext, &uNext,
+               uNext | 1));
+
+   /* The search cannot pass psDummy without unlinking it. */
+   (void)SymTable_search(oSymTable, psRecord,
+      SymTable_parent(uBucket), psDummy->uSortKey, NULL, 0,
+      &puPrev, &psCurrent);
+
+   (void)atomic_compare_exchange_strong(ppsSlot, &psExpected, NULL);
+   SymTable_retire(psRecord, &psDummy->sRetired);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_initBucket adds a dummy node for bucket uBucket of oSymTable,
+whose address is ppsSlot, and returns it. Return NULL if insufficient
+memory is available, or if another thread is adding the same dummy
+node or the table no longer uses the bucket; the caller then starts
+from the parent bucket instead. psRecord is the record of the calling
+thread.*/
+static struct SymTableNode *SymTable_initBucket(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket,
+   struct SymTableNode *_Atomic *ppsSlot)
+{
+   struct SymTableNode *psDummy;
+   struct SymTableNode *psCurrent;
+
+   assert(oSymTable != NULL);
+   assert(uBucket != 0);
+   assert(ppsSlot != NULL);
+
+   psDummy = (struct SymTableNode*)
+      malloc(sizeof(struct SymTableNode) + 1);
+   if (psDummy == NULL) return NULL;
+
+   psDummy->uSortKey = SymTable_reverse((uint64_t)uBucket);
+   atomic_init(&psDummy->uNext, 0);
+   atomic_init(&psDummy->pvValue, NULL);
+   psDummy->uLength = 0;
+   psDummy->acKey[0] = '\0';
+   psDummy->pcKey = psDummy->acKey;
+
+   if (SymTable_insert(oSymTable, psRecord, SymTable_parent(uBucket),
+          psDummy) != psDummy) {
+      free(psDummy);
+      return NULL;
+   }
+
+   /* The bucket may still point to a removed dummy node, which its
+   remover retires without needing the bucket. */
+   psCurrent = atomic_load(ppsSlot);
+   while ((psCurrent == NULL
+           || (atomic_load(&psCurrent->uNext) & 1) != 0)
+          && !atomic_compare_exchange_weak(ppsSlot, &psCurrent,
+                psDummy));
+
+   /* A shrink that began before psDummy was stored would miss it. */
+   if (uBucket >= atomic_load(&oSymTable->uBucketCount)) {
+      if (atomic_load(ppsSlot) == psDummy)
+         SymTable_removeDummy(oSymTable, psRecord, uBucket, psDummy,
+            ppsSlot);
+      return NULL;
+   }
+   return psDummy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the dummy node where a search of bucket uBucket of oSymTable
+   should start: that of uBucket if it exists or can be added, or
+   else that of the nearest ancestor of uBucket. psRecord is the
+   record of the calling thread. */
+static struct SymTableNode *SymTable_bucket(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, size_t uBucket)
+{
+   struct SymTableNode *_Atomic *ppsSlot;
+   struct SymTableNode *psDummy;
+
+   assert(oSymTable != NULL);
+
+   for (;;) {
+      ppsSlot = SymTable_slot(oSymTable, uBucket);
+      if (ppsSlot != NULL) {
+         psDummy = atomic_load_explicit(ppsSlot, memory_order_acquire);
+         if (psDummy == NULL && uBucket != 0)
+            psDummy = SymTable_initBucket(oSymTable, psRecord, uBucket,
+               ppsSlot);
+         if (psDummy != NULL
+             && (atomic_load_explicit(&psDummy->uNext,
+                    memory_order_acquire) & 1) == 0)
+            return psDummy;
+      }
+      /* The dummy node of bucket 0 is never removed. */
+      assert(uBucket != 0);
+      uBucket = SymTable_parent(uBucket);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the sum of the binding counts of oSymTable. */
+static size_t SymTable_count(SymTable_T oSymTable)
+{
+   size_t uCount = 0;
+   int iCounter;
+
+   assert(oSymTable != NULL);
+
+   for (iCounter = 0; iCounter < COUNTER_COUNT; iCounter++)
+      uCount += atomic_load_explicit(
+         &oSymTable->auCounts[iCounter].uCount, memory_order_relaxed);
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   SymTable_T oSymTable;
+   struct SymTableNode *psDummy;
+   struct SymTableNode *_Atomic *ppsSlot;
+   int iCounter;
+   int iSegment;
+
+   assert(pfHash != NULL);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   for (iCounter = 0; iCounter < COUNTER_COUNT; iCounter++)
+      atomic_init(&oSymTable->auCounts[iCounter].uCount, 0);
+   atomic_init(&oSymTable->uBucketCount, INITIAL_BUCKET_COUNT);
+   oSymTable->pfHash = pfHash;
+   for (iSegment = 0; iSegment < SEGMENT_COUNT; iSegment++)
+      atomic_init(&oSymTable->appsSegments[iSegment], NULL);
+
+   /* The dummy node of bucket 0 heads the list. */
+   psDummy = (struct SymTableNode*)
+      malloc(sizeof(struct SymTableNode) + 1);
+   ppsSlot = SymTable_slot(oSymTable, 0);
+   if (psDummy == NULL || ppsSlot == NULL) {
+      free(psDummy);
+      free(atomic_load(&oSymTable->appsSegments[0]));
+      free(oSymTable);
+      return NULL;
+   }
+   psDummy->uSortKey = 0;
+   atomic_init(&psDummy->uNext, 0);
+   atomic_init(&psDummy->pvValue, NULL);
+   psDummy->uLength = 0;
+   psDummy->acKey[0] = '\0';
+   psDummy->pcKey = psDummy->acKey;
+   atomic_store(ppsSlot, psDummy);
+
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The split-ordered list must stay sorted by key, so the table
+   ignores iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   struct SymTableNode *psCurrent;
+   struct SymTableNode *psNext;
+   int iSegment;
+
+   assert(oSymTable != NULL);
+
+   /* Every node still linked, dummy or not, is reached from the dummy
+   node of bucket 0. Unlinked nodes are already retired. */
+   for (psCurrent = atomic_load(SymTable_slot(oSymTable, 0));
+        psCurrent != NULL; psCurrent = psNext) {
+      psNext = (struct SymTableNode*)
+         (atomic_load(&psCurrent->uNext) & ~(uintptr_t)1);
+      free(psCurrent);
+   }
+
+   for (iSegment = 0; iSegment < SEGMENT_COUNT; iSegment++)
+      free(atomic_load(&oSymTable->appsSegments[iSegment]));
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the length is exact only while no other thread is adding or
+   removing bindings. */
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   return SymTable_count(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_grow doubles the bucket count of oSymTable if it holds more
+than MAX_LOAD bindings per bucket. A put calls it once the counter of
+its key exceeds that counter's share; the table as a whole is checked
+here, so that a skewed hash function cannot make it grow without
+bound.*/
+static void SymTable_grow(SymTable_T oSymTable)
+{
+   size_t uBucketCount;
+
+   assert(oSymTable != NULL);
+
+   uBucketCount = atomic_load(&oSymTable->uBucketCount);
+   if (SymTable_count(oSymTable) > MAX_LOAD * uBucketCount
+       && uBucketCount
+          < (size_t)INITIAL_BUCKET_COUNT << (SEGMENT_COUNT - 1))
+      (void)atomic_compare_exchange_strong(&oSymTable->uBucketCount,
+         &uBucketCount, 2 * uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_shrink halves the bucket count of oSymTable if it holds fewer
+than one binding per SHRINK_LOAD_DEN buckets, and removes the dummy
+nodes of the buckets no longer in use. Their segments are kept for
+later growth. psRecord is the record of the calling thread.*/
+static void SymTable_shrink(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord)
+{
+   struct SymTableNode *_Atomic *ppsSlot;
+   struct SymTableNode *psDummy;
+   size_t uBucketCount;
+   size_t uBucket;
+
+   assert(oSymTable != NULL);
+
+   uBucketCount = atomic_load(&oSymTable->uBucketCount);
+   if (uBucketCount <= INITIAL_BUCKET_COUNT
+       || SymTable_count(oSymTable) * SHRINK_LOAD_DEN >= uBucketCount
+       || !atomic_compare_exchange_strong(&oSymTable->uBucketCount,
+             &uBucketCount, uBucketCount / 2))
+      return;
+
+   for (uBucket = uBucketCount / 2; uBucket < uBucketCount; uBucket++) {
+      ppsSlot = SymTable_slot(oSymTable, uBucket);
+      if (ppsSlot == NULL) continue;
+      psDummy = atomic_load(ppsSlot);
+      if (psDummy != NULL)
+         SymTable_removeDummy(oSymTable, psRecord, uBucket, psDummy,
+            ppsSlot);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_findNode returns the binding of oSymTable whose key is pcKey,
+which is uLength characters long, or NULL if there is no such binding.
+If puHash is not NULL, *puHash is set to the hash of pcKey either way.
+psRecord is the record of the calling thread.*/
+static struct SymTableNode *SymTable_findNode(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, const char *pcKey,
+   size_t uLength, size_t *puHash)
+{
+   _Atomic uintptr_t *puPrev;
+   struct SymTableNode *psCurrent;
+   size_t uHash;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   if (puHash != NULL) *puHash = uHash;
+
+   if (!SymTable_search(oSymTable, psRecord,
+          uHash & (atomic_load_explicit(&oSymTable->uBucketCount,
+                      memory_order_acquire) - 1),
+          SymTable_reverse((uint64_t)uHash | (UINT64_C(1) << 63)),
+          pcKey, uLength, &puPrev, &psCurrent))
+      return NULL;
+   return psCurrent;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_add returns the binding of oSymTable whose key is pcKey,
+which is uLength characters long, first adding one with value pvValue
+if there is none. It sets *piInserted to 1 if it added the binding and
+0 otherwise. If iBorrow is 1, an added binding borrows pcKey, which
+must then be followed by '\0', instead of copying it. Return NULL if
+insufficient memory is available. psRecord is the record of the calling
+thread.*/
+static struct SymTableNode *SymTable_add(SymTable_T oSymTable,
+   struct SymTableEpochRecord *psRecord, const char *pcKey,
+   size_t uLength, int iBorrow, const void *pvValue, int *piInserted)
+{
+   struct SymTableNode *psNode;
+   struct SymTableNode *psFound;
+   union SymTablePaddedCount *puCount;
+   size_t uHash;
+   size_t uBucketCount;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   *piInserted = 0;
+
+   psFound = SymTable_findNode(oSymTable, psRecord, pcKey, uLength,
+      &uHash);
+   if (psFound != NULL) return psFound;
+
+   psNode = (struct SymTableNode*)
+      malloc(sizeof(struct SymTableNode) + (iBorrow ? 0 : uLength + 1));
+   if (psNode == NULL) return NULL;
+
+   psNode->uSortKey =
+      SymTable_reverse((uint64_t)uHash | (UINT64_C(1) << 63));
+   atomic_init(&psNode->uNext, 0);
+   atomic_init(&psNode->pvValue, (void*)pvValue);
+   psNode->uLength = uLength;
+   if (iBorrow)
+      psNode->pcKey = pcKey;
+   else {
+      memcpy(psNode->acKey, pcKey, uLength);
+      psNode->acKey[uLength] = '\0';
+      psNode->pcKey = psNode->acKey;
+   }
+
+   uBucketCount = atomic_load_explicit(&oSymTable->uBucketCount,
+      memory_order_acquire);
+   psFound = SymTable_insert(oSymTable, psRecord,
+      uHash & (uBucketCount - 1), psNode);
+   if (psFound != psNode) {
+      free(psNode);
+      return psFound;
+   }
+
+   puCount = &oSymTable->auCounts[uHash & (COUNTER_COUNT - 1)];
+   if (atomic_fetch_add_explicit(&puCount->uCount, 1,
+          memory_order_relaxed) + 1
+       > MAX_LOAD * uBucketCount / COUNTER_COUNT)
+      SymTable_grow(oSymTable);
+
+   *piInserted = 1;
+   return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the returned address stays valid until the binding is removed,
+   whichever thread removes it. Reads and writes through it are not
+   synchronized with other threads. */
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psNode;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   psRecord = SymTable_enter();
+   psNode = SymTable_add(oSymTable, psRecord, pcKey, uLength, 0, NULL,
+      piInserted);
+   SymTable_exit(psRecord);
+
+   if (psNode == NULL) return NULL;
+   /* An atomic pointer has the representation of a plain one. */
+   return (void**)&psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   struct SymTableEpochRecord *psRecord;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* The value is stored before the binding is linked, so that no
+   other thread sees the binding without it. */
+   psRecord = SymTable_enter();
+   (void)SymTable_add(oSymTable, psRecord, pcKey, uLength, 0, pvValue,
+      &iInserted);
+   SymTable_exit(psRecord);
+   return iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   struct SymTableEpochRecord *psRecord;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psRecord = SymTable_enter();
+   (void)SymTable_add(oSymTable, psRecord, pcKey, strlen(pcKey), 1,
+      pvValue, &iInserted);
+   SymTable_exit(psRecord);
+   return iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psNode;
+   void *oldVal = NULL;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psRecord = SymTable_enter();
+   for (;;) {
+      psNode = SymTable_findNode(oSymTable, psRecord, pcKey, uLength,
+         NULL);
+      if (psNode == NULL) break;
+
+      oldVal = atomic_load(&psNode->pvValue);
+      while (oldVal != pvTombstone
+             && !atomic_compare_exchange_weak(&psNode->pvValue,
+                   &oldVal, (void*)pvValue));
+      if (oldVal != pvTombstone) break;
+
+      /* The binding was removed after it was found; a new binding
+      with the same key may have been added since. */
+      oldVal = NULL;
+   }
+   SymTable_exit(psRecord);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psNode;
+   _Atomic uintptr_t *puPrev;
+   struct SymTableNode *psCurrent;
+   union SymTablePaddedCount *puCount;
+   uintptr_t uNext;
+   size_t uHash;
+   void *oldVal = NULL;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psRecord = SymTable_enter();
+   for (;;) {
+      psNode = SymTable_findNode(oSymTable, psRecord, pcKey, uLength,
+         &uHash);
+      if (psNode == NULL) break;
+
+      /* Storing the tombstone is what removes the binding. */
+      oldVal = atomic_load(&psNode->pvValue);
+      while (oldVal != pvTombstone
+             && !atomic_compare_exchange_weak(&psNode->pvValue,
+                   &oldVal, pvTombstone));
+      if (oldVal == pvTombstone) {
+         oldVal = NULL;
+         continue;
+      }
+
+      /* Mark the node. A search cannot pass a marked node without
+      unlinking it, and whichever thread unlinks it retires it. */
+      uNext = atomic_load(&psNode->uNext);
+      while ((uNext & 1) == 0
+             && !atomic_compare_exchange_weak(&psNode->uNext, &uNext,
+                   uNext | 1));
+      (void)SymTable_search(oSymTable, psRecord,
+         uHash & (atomic_load(&oSymTable->uBucketCount) - 1),
+         psNode->uSortKey, pcKey, uLength, &puPrev, &psCurrent);
+
+      puCount = &oSymTable->auCounts[uHash & (COUNTER_COUNT - 1)];
+      (void)atomic_fetch_sub_explicit(&puCount->uCount, 1,
+         memory_order_relaxed);
+      if (atomic_load_explicit(&puCount->uCount, memory_order_relaxed)
+          * SHRINK_LOAD_DEN * COUNTER_COUNT
+          < atomic_load(&oSymTable->uBucketCount))
+         SymTable_shrink(oSymTable, psRecord);
+      break;
+   }
+   SymTable_exit(psRecord);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psNode;
+   void *pvValue = NULL;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psRecord = SymTable_enter();
+   psNode = SymTable_findNode(oSymTable, psRecord, pcKey, uLength,
+         NULL);
+   if (psNode != NULL) {
+      pvValue = atomic_load_explicit(&psNode->pvValue,
+         memory_order_acquire);
+      if (pvValue == pvTombstone) pvValue = NULL;
+   }
+   SymTable_exit(psRecord);
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psNode;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psRecord = SymTable_enter();
+   psNode = SymTable_findNode(oSymTable, psRecord, pcKey, uLength,
+         NULL);
+   iFound = psNode != NULL
+      && atomic_load_explicit(&psNode->pvValue,
+            memory_order_acquire) != pvTombstone;
+   SymTable_exit(psRecord);
+   return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding at or after the node psNode, or
+   finish psIter, leaving the epoch entered by SymTable_iterBegin, if
+   there is none. The calling thread must be in that epoch. */
+static void SymTable_iterFrom(SymTable_Iter *psIter,
+     struct SymTableNode *psNode)
+{
+   uintptr_t uNext;
+   void *pvValue;
+
+   assert(psIter != NULL);
+
+   for (; psNode != NULL;
+        psNode = (struct SymTableNode*)(uNext & ~(uintptr_t)1))
+   {
+      uNext = atomic_load_explicit(&psNode->uNext,
+         memory_order_acquire);
+      if ((psNode->uSortKey & 1) == 0 || (uNext & 1) != 0)
+         continue;
+      pvValue = atomic_load_explicit(&psNode->pvValue,
+         memory_order_acquire);
+      if (pvValue != pvTombstone) {
+         psIter->pvPosition = psNode;
+         psIter->pcKey = psNode->pcKey;
+         psIter->pvValue = pvValue;
+         return;
+      }
+   }
+
+   psIter->pvPosition = NULL;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+   SymTable_exit(SymTable_record());
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the calling thread stays in an epoch from SymTable_iterBegin
+   until the iteration is done or ended, so no node that it can reach
+   is freed meanwhile; a long iteration therefore delays the freeing
+   of removed bindings by every thread. The iteration must be
+   finished by the thread that began it. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->uIndex = 0;
+   (void)SymTable_enter();
+   SymTable_iterFrom(psIter,
+      atomic_load(SymTable_slot(oSymTable, 0)));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   struct SymTableNode *psNode;
+
+   assert(psIter != NULL);
+   assert(psIter->pvPosition != NULL);
+
+   psNode = (struct SymTableNode*)psIter->pvPosition;
+   SymTable_iterFrom(psIter, (struct SymTableNode*)
+      (atomic_load_explicit(&psNode->uNext, memory_order_acquire)
+         & ~(uintptr_t)1));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   if (psIter->pcKey != NULL) SymTable_iterFrom(psIter, NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here bindings that other threads add or remove while the map is in
+   progress may or may not be visited. pfApply may call any function
+   on oSymTable. */
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psCurrent;
+   uintptr_t uNext;
+   void *pvValue;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   psRecord = SymTable_enter();
+   for (psCurrent = atomic_load(SymTable_slot(oSymTable, 0));
+        psCurrent != NULL;
+        psCurrent = (struct SymTableNode*)(uNext & ~(uintptr_t)1))
+   {
+      uNext = atomic_load_explicit(&psCurrent->uNext,
+         memory_order_acquire);
+      if ((psCurrent->uSortKey & 1) == 0 || (uNext & 1) != 0)
+         continue;
+      pvValue = atomic_load_explicit(&psCurrent->pvValue,
+         memory_order_acquire);
+      if (pvValue != pvTombstone)
+         (*pfApply)(psCurrent->pcKey, pvValue, (void*)pvExtra);
+   }
+   SymTable_exit(psRecord);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable. Part i holds the nodes whose
+   sort keys lie in the i-th of as many equal ranges as there are parts;
+   since the list is sorted, the part is a run of it, which the part
+   enters at the dummy node of the bucket whose sort key is the greatest
+   that does not exceed the start of the range. Bindings that other
+   threads add or remove meanwhile may or may not be visited. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   struct SymTableEpochRecord *psRecord;
+   struct SymTableNode *psCurrent;
+   uintptr_t uNext;
+   uint64_t uWidth;
+   uint64_t uFirst;
+   uint64_t uLast;
+   size_t uBucketCount;
+   void *pvValue;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+
+   /* The range of part i is [uFirst, uLast], where the last part
+   extends to the greatest sort key. */
+   uWidth = UINT64_MAX / (uint64_t)iPartCount;
+   uFirst = uWidth * (uint64_t)iPart;
+   uLast = iPart == iPartCount - 1 ? UINT64_MAX
+      : uFirst + uWidth - 1;
+
+   psRecord = SymTable_enter();
+   uBucketCount = atomic_load(&oSymTable->uBucketCount);
+   for (psCurrent = SymTable_bucket(oSymTable, psRecord,
+           (size_t)SymTable_reverse(uFirst) & (uBucketCount - 1));
+        psCurrent != NULL && psCurrent->uSortKey <= uLast;
+        psCurrent = (struct SymTableNode*)(uNext & ~(uintptr_t)1))
+   {
+      uNext = atomic_load_explicit(&psCurrent->uNext,
+         memory_order_acquire);
+      if ((psCurrent->uSortKey & 1) == 0 || (uNext & 1) != 0
+          || psCurrent->uSortKey < uFirst)
+         continue;
+      pvValue = atomic_load_explicit(&psCurrent->pvValue,
+         memory_order_acquire);
+      if (pvValue != pvTombstone)
+         (*pfApply)(psCurrent->pcKey, pvValue, pvExtra);
+   }
+   SymTable_exit(psRecord);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
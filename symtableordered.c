@@ -0,0 +1,1221 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation specifically uses a B+ tree, which keeps the
+bindings in order of key (see symtableordered.h). Each node holds a few
+dozen keys, so that a lookup visits a handful of nodes and searches
+each with a binary search, and the leaves are chained in order, so that
+a range of keys is a walk along the chain.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symtableordered.h"
+#include "symparallel.h"
+
+/*The most bindings that a leaf holds, and the fewest that a leaf other
+than the root holds*/
+enum {LEAF_KEYS = 32, LEAF_MIN_KEYS = LEAF_KEYS / 2};
+
+/*The most keys that a branch holds, and the fewest that a branch other
+than the root holds. A branch has one more child than keys, and a full
+branch splits into two of BRANCH_MIN_KEYS keys around its middle key*/
+enum {BRANCH_KEYS = 31, BRANCH_MIN_KEYS = BRANCH_KEYS / 2};
+
+/*The number of leading bytes of a key that are kept in its prefix*/
+enum {PREFIX_BYTES = sizeof(unsigned long long)};
+
+/*Set in the stored length of a key that the client lent with
+SymTable_putBorrowed, which the symbol table must not free*/
+static const size_t BORROWED_KEY = ~((size_t)-1 >> 1);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableKey is a key as a node stores it. */
+struct SymTableKey
+{
+   /*The first PREFIX_BYTES bytes of the key, most significant first
+   and padded with zeros, so that most comparisons of keys that differ
+   early compare two integers and read neither key*/
+   unsigned long long ullPrefix;
+
+   /*The key, owned by the symbol table unless it is borrowed*/
+   const char *pcKey;
+
+   /*The length of the key, with BORROWED_KEY set if it is borrowed*/
+   size_t uLength;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableLeaf holds bindings in increasing order of key. */
+struct SymTableLeaf
+{
+   /*The number of bindings in the leaf*/
+   size_t uCount;
+
+   /*The leaf that holds the next keys, or NULL*/
+   struct SymTableLeaf *psNext;
+
+   /*The keys*/
+   struct SymTableKey asKeys[LEAF_KEYS];
+
+   /*The value of each key*/
+   void *apvValues[LEAF_KEYS];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableBranch holds uCount keys and uCount + 1 children, which
+are all branches or all leaves. asKeys[i] is the least key in the
+subtree of apvChildren[i + 1], and shares that key's string, so every
+key in the subtree of apvChildren[i] is less than it. */
+struct SymTableBranch
+{
+   /*The number of keys in the branch*/
+   size_t uCount;
+
+   /*The keys*/
+   struct SymTableKey asKeys[BRANCH_KEYS];
+
+   /*The children*/
+   void *apvChildren[BRANCH_KEYS + 1];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is a B+ tree whose leaves are all at the same depth. */
+struct SymTable
+{
+   /*The number of bindings within the symbol table*/
+   size_t bindingCount;
+
+   /*The number of levels of branches above the leaves*/
+   size_t uHeight;
+
+   /*The number of leaves*/
+   size_t uLeafCount;
+
+   /*The root, a leaf if uHeight is 0 and a branch otherwise*/
+   void *pvRoot;
+
+   /*The leaf that holds the least keys. Splits and merges always keep
+   the left node of a pair, so it never changes*/
+   struct SymTableLeaf *psFirst;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return pcKey, which is uLength characters long, as a node would
+   store it. */
+static struct SymTableKey SymTable_makeKey(const char *pcKey,
+   size_t uLength)
+{
+   struct SymTableKey sKey;
+   size_t i;
+
+   assert(pcKey != NULL);
+
+   sKey.ullPrefix = 0;
+   for (i = 0; i < PREFIX_BYTES; i++) {
+      sKey.ullPrefix <<= 8;
+      if (i < uLength)
+         sKey.ullPrefix |= (unsigned char)pcKey[i];
+   }
+   sKey.pcKey = pcKey;
+   sKey.uLength = uLength;
+   return sKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0 or a positive number as *psKey1 is less
+   than, equal to or greater than *psKey2. */
+static int SymTable_compare(const struct SymTableKey *psKey1,
+   const struct SymTableKey *psKey2)
+{
+   size_t uLength1;
+   size_t uLength2;
+   size_t uShorter;
+   size_t uSkip;
+   int iResult;
+
+   assert(psKey1 != NULL);
+   assert(psKey2 != NULL);
+
+   if (psKey1->ullPrefix != psKey2->ullPrefix)
+      return psKey1->ullPrefix < psKey2->ullPrefix ? -1 : 1;
+
+   /* Equal prefixes mean equal leading bytes, up to the length of the
+   shorter key. */
+   uLength1 = psKey1->uLength & ~BORROWED_KEY;
+   uLength2 = psKey2->uLength & ~BORROWED_KEY;
+   uShorter = uLength1 < uLength2 ? uLength1 : uLength2;
+   uSkip = uShorter < PREFIX_BYTES ? uShorter : PREFIX_BYTES;
+   iResult = memcmp(psKey1->pcKey + uSkip, psKey2->pcKey + uSkip,
+      uShorter - uSkip);
+   if (iResult != 0) return iResult;
+   if (uLength1 == uLength2) return 0;
+   return uLength1 < uLength2 ? -1 : 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first key of psLeaf that is not less than
+   *psKey, or psLeaf->uCount if there is none. Set *piFound to 1
+   (TRUE) if that key is *psKey, and to 0 (FALSE) otherwise. */
+static size_t SymTable_searchLeaf(const struct SymTableLeaf *psLeaf,
+   const struct SymTableKey *psKey, int *piFound)
+{
+   size_t uLow = 0;
+   size_t uHigh = psLeaf->uCount;
+   size_t uMiddle;
+   int iResult;
+
+   assert(psLeaf != NULL);
+   assert(psKey != NULL);
+   assert(piFound != NULL);
+
+   *piFound = 0;
+   while (uLow < uHigh) {
+      uMiddle = uLow + (uHigh - uLow) / 2;
+      iResult = SymTable_compare(&psLeaf->asKeys[uMiddle], psKey);
+      if (iResult < 0)
+         uLow = uMiddle + 1;
+      else if (iResult > 0)
+         uHigh = uMiddle;
+      else {
+         *piFound = 1;
+         return uMiddle;
+      }
+   }
+   return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the child of psBranch whose subtree would hold
+   *psKey: the number of keys of psBranch that are not greater than
+   *psKey. */
+static size_t SymTable_searchBranch(
+   const struct SymTableBranch *psBranch,
+   const struct SymTableKey *psKey)
+{
+   size_t uLow = 0;
+   size_t uHigh = psBranch->uCount;
+   size_t uMiddle;
+
+   assert(psBranch != NULL);
+   assert(psKey != NULL);
+
+   while (uLow < uHigh) {
+      uMiddle = uLow + (uHigh - uLow) / 2;
+      if (SymTable_compare(&psBranch->asKeys[uMiddle], psKey) <= 0)
+         uLow = uMiddle + 1;
+      else
+         uHigh = uMiddle;
+   }
+   return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable whose keys would include *psKey. */
+static struct SymTableLeaf *SymTable_findLeaf(SymTable_T oSymTable,
+   const struct SymTableKey *psKey)
+{
+   void *pvNode;
+   size_t uLevel;
+   struct SymTableBranch *psBranch;
+
+   assert(oSymTable != NULL);
+   assert(psKey != NULL);
+
+   pvNode = oSymTable->pvRoot;
+   for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--) {
+      psBranch = (struct SymTableBranch*)pvNode;
+      pvNode = psBranch->apvChildren[
+         SymTable_searchBranch(psBranch, psKey)];
+   }
+   return (struct SymTableLeaf*)pvNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a pointer to the value of the binding of oSymTable whose key
+   is *psKey, or NULL if there is none. */
+static void **SymTable_find(SymTable_T oSymTable,
+   const struct SymTableKey *psKey)
+{
+   struct SymTableLeaf *psLeaf;
+   size_t uIndex;
+   int iFound;
+
+   psLeaf = SymTable_findLeaf(oSymTable, psKey);
+   uIndex = SymTable_searchLeaf(psLeaf, psKey, &iFound);
+   return iFound ? &psLeaf->apvValues[uIndex] : NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of keys of pvNode, which is a leaf if uLevel is 0
+   and a branch otherwise. */
+static size_t SymTable_nodeCount(const void *pvNode, size_t uLevel)
+{
+   assert(pvNode != NULL);
+
+   if (uLevel == 0)
+      return ((const struct SymTableLeaf*)pvNode)->uCount;
+   return ((const struct SymTableBranch*)pvNode)->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if pvNode, which is a leaf if uLevel is 0 and a
+   branch otherwise, has no room for another key, or 0 (FALSE) if it
+   does. */
+static int SymTable_isFull(const void *pvNode, size_t uLevel)
+{
+   return SymTable_nodeCount(pvNode, uLevel)
+      == (uLevel == 0 ? (size_t)LEAF_KEYS : (size_t)BRANCH_KEYS);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if pvNode, which is a leaf if uLevel is 0 and a
+   branch otherwise, would have too few keys without one of them, or
+   0 (FALSE) if not. */
+static int SymTable_isMinimal(const void *pvNode, size_t uLevel)
+{
+   return SymTable_nodeCount(pvNode, uLevel)
+      <= (uLevel == 0 ? (size_t)LEAF_MIN_KEYS
+         : (size_t)BRANCH_MIN_KEYS);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert *psKey into psBranch as key uIndex, with pvChild as the child
+   after it. psBranch must not be full. */
+static void SymTable_insertIntoBranch(struct SymTableBranch *psBranch,
+   size_t uIndex, const struct SymTableKey *psKey, void *pvChild)
+{
+   assert(psBranch != NULL);
+   assert(psBranch->uCount < BRANCH_KEYS);
+   assert(uIndex <= psBranch->uCount);
+
+   memmove(&psBranch->asKeys[uIndex + 1], &psBranch->asKeys[uIndex],
+      (psBranch->uCount - uIndex) * sizeof(struct SymTableKey));
+   memmove(&psBranch->apvChildren[uIndex + 2],
+      &psBranch->apvChildren[uIndex + 1],
+      (psBranch->uCount - uIndex) * sizeof(void*));
+   psBranch->asKeys[uIndex] = *psKey;
+   psBranch->apvChildren[uIndex + 1] = pvChild;
+   psBranch->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove key uIndex of psBranch, and the child after it. */
+static void SymTable_removeFromBranch(struct SymTableBranch *psBranch,
+   size_t uIndex)
+{
+   assert(psBranch != NULL);
+   assert(uIndex < psBranch->uCount);
+
+   memmove(&psBranch->asKeys[uIndex], &psBranch->asKeys[uIndex + 1],
+      (psBranch->uCount - uIndex - 1) * sizeof(struct SymTableKey));
+   memmove(&psBranch->apvChildren[uIndex + 1],
+      &psBranch->apvChildren[uIndex + 2],
+      (psBranch->uCount - uIndex - 1) * sizeof(void*));
+   psBranch->uCount--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Split child uIndex of psParent, which must be full, into two, adding
+   the new right half to psParent after it. psParent must not be full,
+   and its children are leaves if uLevel is 0 and branches otherwise.
+   Return 1 (TRUE) on success, or 0 (FALSE), leaving oSymTable
+   unchanged, if insufficient memory is available. */
+static int SymTable_splitChild(SymTable_T oSymTable,
+   struct SymTableBranch *psParent, size_t uIndex, size_t uLevel)
+{
+   struct SymTableLeaf *psLeft;
+   struct SymTableLeaf *psRight;
+   struct SymTableBranch *psLeftBranch;
+   struct SymTableBranch *psRightBranch;
+   size_t uKeep;
+
+   assert(oSymTable != NULL);
+   assert(psParent != NULL);
+   assert(psParent->uCount < BRANCH_KEYS);
+
+   if (uLevel == 0) {
+      psLeft = (struct SymTableLeaf*)psParent->apvChildren[uIndex];
+      psRight = (struct SymTableLeaf*)
+         malloc(sizeof(struct SymTableLeaf));
+      if (psRight == NULL) return 0;
+
+      uKeep = psLeft->uCount / 2;
+      psRight->uCount = psLeft->uCount - uKeep;
+      memcpy(psRight->asKeys, &psLeft->asKeys[uKeep],
+         psRight->uCount * sizeof(struct SymTableKey));
+      memcpy(psRight->apvValues, &psLeft->apvValues[uKeep],
+         psRight->uCount * sizeof(void*));
+      psLeft->uCount = uKeep;
+      psRight->psNext = psLeft->psNext;
+      psLeft->psNext = psRight;
+      oSymTable->uLeafCount++;
+
+      SymTable_insertIntoBranch(psParent, uIndex, &psRight->asKeys[0],
+         psRight);
+      return 1;
+   }
+
+   psLeftBranch = (struct SymTableBranch*)psParent->apvChildren[uIndex];
+   psRightBranch = (struct SymTableBranch*)
+      malloc(sizeof(struct SymTableBranch));
+   if (psRightBranch == NULL) return 0;
+
+   /* The middle key moves up to psParent, and is in neither half. */
+   uKeep = psLeftBranch->uCount / 2;
+   psRightBranch->uCount = psLeftBranch->uCount - uKeep - 1;
+   memcpy(psRightBranch->asKeys, &psLeftBranch->asKeys[uKeep + 1],
+      psRightBranch->uCount * sizeof(struct SymTableKey));
+   memcpy(psRightBranch->apvChildren,
+      &psLeftBranch->apvChildren[uKeep + 1],
+      (psRightBranch->uCount + 1) * sizeof(void*));
+   psLeftBranch->uCount = uKeep;
+
+   SymTable_insertIntoBranch(psParent, uIndex,
+      &psLeftBranch->asKeys[uKeep], psRightBranch);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge children uIndex and uIndex + 1 of psParent, whose keys must
+   fit in one node, into child uIndex. The children are leaves if
+   uLevel is 0 and branches otherwise. */
+static void SymTable_mergeChildren(SymTable_T oSymTable,
+   struct SymTableBranch *psParent, size_t uIndex, size_t uLevel)
+{
+   struct SymTableLeaf *psLeft;
+   struct SymTableLeaf *psRight;
+   struct SymTableBranch *psLeftBranch;
+   struct SymTableBranch *psRightBranch;
+
+   assert(oSymTable != NULL);
+   assert(psParent != NULL);
+   assert(uIndex < psParent->uCount);
+
+   if (uLevel == 0) {
+      psLeft = (struct SymTableLeaf*)psParent->apvChildren[uIndex];
+      psRight = (struct SymTableLeaf*)psParent->apvChildren[uIndex + 1];
+      assert(psLeft->uCount + psRight->uCount <= LEAF_KEYS);
+
+      memcpy(&psLeft->asKeys[psLeft->uCount], psRight->asKeys,
+         psRight->uCount * sizeof(struct SymTableKey));
+      memcpy(&psLeft->apvValues[psLeft->uCount], psRight->apvValues,
+         psRight->uCount * sizeof(void*));
+      psLeft->uCount += psRight->uCount;
+      psLeft->psNext = psRight->psNext;
+      free(psRight);
+      oSymTable->uLeafCount--;
+   }
+   else {
+      psLeftBranch =
+         (struct SymTableBranch*)psParent->apvChildren[uIndex];
+      psRightBranch =
+         (struct SymTableBranch*)psParent->apvChildren[uIndex + 1];
+      assert(psLeftBranch->uCount + psRightBranch->uCount + 1
+         <= BRANCH_KEYS);
+
+      /* The key between the two moves down between their children. */
+      psLeftBranch->asKeys[psLeftBranch->uCount] =
+         psParent->asKeys[uIndex];
+      memcpy(&psLeftBranch->asKeys[psLeftBranch->uCount + 1],
+         psRightBranch->asKeys,
+         psRightBranch->uCount * sizeof(struct SymTableKey));
+      memcpy(&psLeftBranch->apvChildren[psLeftBranch->uCount + 1],
+         psRightBranch->apvChildren,
+         (psRightBranch->uCount + 1) * sizeof(void*));
+      psLeftBranch->uCount += psRightBranch->uCount + 1;
+      free(psRightBranch);
+   }
+
+   SymTable_removeFromBranch(psParent, uIndex);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the last key of child uIndex - 1 of psParent to the front of
+   child uIndex. The children are leaves if uLevel is 0 and branches
+   otherwise. */
+static void SymTable_borrowFromLeft(struct SymTableBranch *psParent,
+   size_t uIndex, size_t uLevel)
+{
+   struct SymTableLeaf *psLeft;
+   struct SymTableLeaf *psChild;
+   struct SymTableBranch *psLeftBranch;
+   struct SymTableBranch *psChildBranch;
+
+   assert(psParent != NULL);
+   assert(uIndex > 0);
+
+   if (uLevel == 0) {
+      psLeft = (struct SymTableLeaf*)psParent->apvChildren[uIndex - 1];
+      psChild = (struct SymTableLeaf*)psParent->apvChildren[uIndex];
+
+      memmove(&psChild->asKeys[1], psChild->asKeys,
+         psChild->uCount * sizeof(struct SymTableKey));
+      memmove(&psChild->apvValues[1], psChild->apvValues,
+         psChild->uCount * sizeof(void*));
+      psLeft->uCount--;
+      psChild->asKeys[0] = psLeft->asKeys[psLeft->uCount];
+      psChild->apvValues[0] = psLeft->apvValues[psLeft->uCount];
+      psChild->uCount++;
+      psParent->asKeys[uIndex - 1] = psChild->asKeys[0];
+      return;
+   }
+
+   psLeftBranch =
+      (struct SymTableBranch*)psParent->apvChildren[uIndex - 1];
+   psChildBranch =
+      (struct SymTableBranch*)psParent->apvChildren[uIndex];
+
+   /* The key between the two moves down, and the last key of the left
+   node moves up in its place. */
+   memmove(&psChildBranch->asKeys[1], psChildBranch->asKeys,
+      psChildBranch->uCount * sizeof(struct SymTableKey));
+   memmove(&psChildBranch->apvChildren[1], psChildBranch->apvChildren,
+      (psChildBranch->uCount + 1) * sizeof(void*));
+   psChildBranch->asKeys[0] = psParent->asKeys[uIndex - 1];
+   psChildBranch->apvChildren[0] =
+      psLeftBranch->apvChildren[psLeftBranch->uCount];
+   psChildBranch->uCount++;
+   psLeftBranch->uCount--;
+   psParent->asKeys[uIndex - 1] =
+      psLeftBranch->asKeys[psLeftBranch->uCount];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the first key of child uIndex + 1 of psParent to the end of
+   child uIndex. The children are leaves if uLevel is 0 and branches
+   otherwise. */
+static void SymTable_borrowFromRight(struct SymTableBranch *psParent,
+   size_t uIndex, size_t uLevel)
+{
+   struct SymTableLeaf *psChild;
+   struct SymTableLeaf *psRight;
+   struct SymTableBranch *psChildBranch;
+   struct SymTableBranch *psRightBranch;
+
+   assert(psParent != NULL);
+   assert(uIndex < psParent->uCount);
+
+   if (uLevel == 0) {
+      psChild = (struct SymTableLeaf*)psParent->apvChildren[uIndex];
+      psRight = (struct SymTableLeaf*)psParent->apvChildren[uIndex + 1];
+
+      psChild->asKeys[psChild->uCount] = psRight->asKeys[0];
+      psChild->apvValues[psChild->uCount] = psRight->apvValues[0];
+      psChild->uCount++;
+      psRight->uCount--;
+      memmove(psRight->asKeys, &psRight->asKeys[1],
+         psRight->uCount * sizeof(struct SymTableKey));
+      memmove(psRight->apvValues, &psRight->apvValues[1],
+         psRight->uCount * sizeof(void*));
+      psParent->asKeys[uIndex] = psRight->asKeys[0];
+      return;
+   }
+
+   psChildBranch =
+      (struct SymTableBranch*)psParent->apvChildren[uIndex];
+   psRightBranch =
+      (struct SymTableBranch*)psParent->apvChildren[uIndex + 1];
+
+   /* The key between the two moves down, and the first key of the
+   right node moves up in its place. */
+   psChildBranch->asKeys[psChildBranch->uCount] =
+      psParent->asKeys[uIndex];
+   psChildBranch->apvChildren[psChildBranch->uCount + 1] =
+      psRightBranch->apvChildren[0];
+   psChildBranch->uCount++;
+   psParent->asKeys[uIndex] = psRightBranch->asKeys[0];
+   psRightBranch->uCount--;
+   memmove(psRightBranch->asKeys, &psRightBranch->asKeys[1],
+      psRightBranch->uCount * sizeof(struct SymTableKey));
+   memmove(psRightBranch->apvChildren, &psRightBranch->apvChildren[1],
+      (psRightBranch->uCount + 1) * sizeof(void*));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give child uIndex of psParent, which would have too few keys without
+   one of them, another key from a sibling, or merge it with a sibling
+   if neither has one to spare. The children are leaves if uLevel is 0
+   and branches otherwise. Return the index of the child that now
+   holds the keys of child uIndex. */
+static size_t SymTable_fixChild(SymTable_T oSymTable,
+   struct SymTableBranch *psParent, size_t uIndex, size_t uLevel)
+{
+   assert(oSymTable != NULL);
+   assert(psParent != NULL);
+
+   if (uIndex > 0
+       && !SymTable_isMinimal(psParent->apvChildren[uIndex - 1],
+             uLevel))
+   {
+      SymTable_borrowFromLeft(psParent, uIndex, uLevel);
+      return uIndex;
+   }
+   if (uIndex < psParent->uCount
+       && !SymTable_isMinimal(psParent->apvChildren[uIndex + 1],
+             uLevel))
+   {
+      SymTable_borrowFromRight(psParent, uIndex, uLevel);
+      return uIndex;
+   }
+   if (uIndex > 0) {
+      SymTable_mergeChildren(oSymTable, psParent, uIndex - 1, uLevel);
+      return uIndex - 1;
+   }
+   SymTable_mergeChildren(oSymTable, psParent, uIndex, uLevel);
+   return uIndex;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvNode, which is a leaf if uLevel is 0 and a branch otherwise,
+   and everything below it. */
+static void SymTable_freeNode(void *pvNode, size_t uLevel)
+{
+   struct SymTableLeaf *psLeaf;
+   struct SymTableBranch *psBranch;
+   size_t i;
+
+   assert(pvNode != NULL);
+
+   if (uLevel == 0) {
+      psLeaf = (struct SymTableLeaf*)pvNode;
+      for (i = 0; i < psLeaf->uCount; i++)
+         if ((psLeaf->asKeys[i].uLength & BORROWED_KEY) == 0)
+            free((char*)psLeaf->asKeys[i].pcKey);
+   }
+   else {
+      psBranch = (struct SymTableBranch*)pvNode;
+      for (i = 0; i <= psBranch->uCount; i++)
+         SymTable_freeNode(psBranch->apvChildren[i], uLevel - 1);
+   }
+   free(pvNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   SymTable_T oSymTable;
+   struct SymTableLeaf *psLeaf;
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   psLeaf = (struct SymTableLeaf*)malloc(sizeof(struct SymTableLeaf));
+   if (psLeaf == NULL) {
+      free(oSymTable);
+      return NULL;
+   }
+   psLeaf->uCount = 0;
+   psLeaf->psNext = NULL;
+
+   oSymTable->bindingCount = 0;
+   oSymTable->uHeight = 0;
+   oSymTable->uLeafCount = 1;
+   oSymTable->pvRoot = psLeaf;
+   oSymTable->psFirst = psLeaf;
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The table compares keys and never hashes them, so it ignores
+   pfHash. */
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   assert(pfHash != NULL);
+   (void)pfHash;
+
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Bindings always stay in order of key, so the table ignores
+   iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   SymTable_freeNode(oSymTable->pvRoot, oSymTable->uHeight);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_findOrAdd is SymTable_findOrInsertN, except that if
+   iBorrow is 1 (TRUE), a binding that it adds borrows pcKey, which
+   must then be followed by '\0', instead of copying it. */
+static void **SymTable_findOrAdd(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int iBorrow, int *piInserted)
+{
+   struct SymTableKey sKey;
+   struct SymTableBranch *psBranch;
+   struct SymTableLeaf *psLeaf;
+   void **ppvValue;
+   void *pvNode;
+   char *pcKeyCopy;
+   size_t uLevel;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   sKey = SymTable_makeKey(pcKey, uLength);
+   ppvValue = SymTable_find(oSymTable, &sKey);
+   if (ppvValue != NULL) {
+      *piInserted = 0;
+      return ppvValue;
+   }
+
+   /* A full root gets a new root above it, so that it can split. */
+   if (SymTable_isFull(oSymTable->pvRoot, oSymTable->uHeight)) {
+      psBranch = (struct SymTableBranch*)
+         malloc(sizeof(struct SymTableBranch));
+      if (psBranch == NULL) return NULL;
+      psBranch->uCount = 0;
+      psBranch->apvChildren[0] = oSymTable->pvRoot;
+      if (!SymTable_splitChild(oSymTable, psBranch, 0,
+             oSymTable->uHeight)) {
+         free(psBranch);
+         return NULL;
+      }
+      oSymTable->pvRoot = psBranch;
+      oSymTable->uHeight++;
+   }
+
+   /* Split each full node on the way down, so that every node that
+   the new key reaches has room for a key from below. */
+   pvNode = oSymTable->pvRoot;
+   for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--) {
+      psBranch = (struct SymTableBranch*)pvNode;
+      uIndex = SymTable_searchBranch(psBranch, &sKey);
+      if (SymTable_isFull(psBranch->apvChildren[uIndex], uLevel - 1)) {
+         if (!SymTable_splitChild(oSymTable, psBranch, uIndex,
+                uLevel - 1))
+            return NULL;
+         if (SymTable_compare(&psBranch->asKeys[uIndex], &sKey) <= 0)
+            uIndex++;
+      }
+      pvNode = psBranch->apvChildren[uIndex];
+   }
+
+   if (iBorrow)
+      pcKeyCopy = (char*)pcKey;
+   else {
+      pcKeyCopy = (char*)malloc(uLength + 1);
+      if (pcKeyCopy == NULL) return NULL;
+      memcpy(pcKeyCopy, pcKey, uLength);
+      pcKeyCopy[uLength] = '\0';
+   }
+   sKey.pcKey = pcKeyCopy;
+   if (iBorrow) sKey.uLength |= BORROWED_KEY;
+
+   psLeaf = (struct SymTableLeaf*)pvNode;
+   uIndex = SymTable_searchLeaf(psLeaf, &sKey, &iFound);
+   assert(!iFound);
+   memmove(&psLeaf->asKeys[uIndex + 1], &psLeaf->asKeys[uIndex],
+      (psLeaf->uCount - uIndex) * sizeof(struct SymTableKey));
+   memmove(&psLeaf->apvValues[uIndex + 1], &psLeaf->apvValues[uIndex],
+      (psLeaf->uCount - uIndex) * sizeof(void*));
+   psLeaf->asKeys[uIndex] = sKey;
+   psLeaf->apvValues[uIndex] = NULL;
+   psLeaf->uCount++;
+   oSymTable->bindingCount++;
+
+   *piInserted = 1;
+   return &psLeaf->apvValues[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   return SymTable_findOrAdd(oSymTable, pcKey, uLength, 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), 1,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   struct SymTableKey sKey;
+   void **ppvValue;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   sKey = SymTable_makeKey(pcKey, uLength);
+   ppvValue = SymTable_find(oSymTable, &sKey);
+   if (ppvValue == NULL) return NULL;
+
+   oldVal = *ppvValue;
+   *ppvValue = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableKey sKey;
+   struct SymTableKey sOldKey;
+   struct SymTableBranch *psBranch;
+   struct SymTableLeaf *psLeaf;
+   void *pvNode;
+   void *oldVal;
+   size_t uLevel;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   sKey = SymTable_makeKey(pcKey, uLength);
+   if (SymTable_find(oSymTable, &sKey) == NULL) return NULL;
+
+   /* Give each node on the way down a key to spare, so that every node
+   that loses a key to a merge below it keeps enough. Only the root may
+   lose its last key, and then its one child takes its place. */
+   pvNode = oSymTable->pvRoot;
+   for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--) {
+      psBranch = (struct SymTableBranch*)pvNode;
+      uIndex = SymTable_searchBranch(psBranch, &sKey);
+      if (SymTable_isMinimal(psBranch->apvChildren[uIndex], uLevel - 1))
+         uIndex = SymTable_fixChild(oSymTable, psBranch, uIndex,
+            uLevel - 1);
+      pvNode = psBranch->apvChildren[uIndex];
+      if (psBranch->uCount == 0) {
+         assert(psBranch == oSymTable->pvRoot);
+         oSymTable->pvRoot = pvNode;
+         oSymTable->uHeight--;
+         free(psBranch);
+      }
+   }
+
+   psLeaf = (struct SymTableLeaf*)pvNode;
+   uIndex = SymTable_searchLeaf(psLeaf, &sKey, &iFound);
+   assert(iFound);
+   sOldKey = psLeaf->asKeys[uIndex];
+   oldVal = psLeaf->apvValues[uIndex];
+   psLeaf->uCount--;
+   memmove(&psLeaf->asKeys[uIndex], &psLeaf->asKeys[uIndex + 1],
+      (psLeaf->uCount - uIndex) * sizeof(struct SymTableKey));
+   memmove(&psLeaf->apvValues[uIndex], &psLeaf->apvValues[uIndex + 1],
+      (psLeaf->uCount - uIndex) * sizeof(void*));
+   oSymTable->bindingCount--;
+
+   /* The least key of a leaf may also be a key of a branch above it,
+   which must now share the string of the leaf's new least key. */
+   if (uIndex == 0 && psLeaf->uCount > 0) {
+      pvNode = oSymTable->pvRoot;
+      for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--) {
+         psBranch = (struct SymTableBranch*)pvNode;
+         uIndex = SymTable_searchBranch(psBranch, &sKey);
+         if (uIndex > 0
+             && SymTable_compare(&psBranch->asKeys[uIndex - 1], &sKey)
+                == 0)
+            psBranch->asKeys[uIndex - 1] = psLeaf->asKeys[0];
+         pvNode = psBranch->apvChildren[uIndex];
+      }
+   }
+
+   if ((sOldKey.uLength & BORROWED_KEY) == 0)
+      free((char*)sOldKey.pcKey);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableKey sKey;
+   void **ppvValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   sKey = SymTable_makeKey(pcKey, uLength);
+   ppvValue = SymTable_find(oSymTable, &sKey);
+   return ppvValue != NULL ? *ppvValue : NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableKey sKey;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   sKey = SymTable_makeKey(pcKey, uLength);
+   return SymTable_find(oSymTable, &sKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding at or after binding uIndex of
+   psLeaf, or finish psIter if there is none. */
+static void SymTable_iterFrom(SymTable_Iter *psIter,
+   struct SymTableLeaf *psLeaf, size_t uIndex)
+{
+   assert(psIter != NULL);
+
+   while (psLeaf != NULL && uIndex >= psLeaf->uCount) {
+      psLeaf = psLeaf->psNext;
+      uIndex = 0;
+   }
+   psIter->pvPosition = psLeaf;
+   psIter->uIndex = uIndex;
+   if (psLeaf == NULL) {
+      psIter->pcKey = NULL;
+      psIter->pvValue = NULL;
+      return;
+   }
+   psIter->pcKey = psLeaf->asKeys[uIndex].pcKey;
+   psIter->pvValue = psLeaf->apvValues[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvContainer = NULL;
+   SymTable_iterFrom(psIter, oSymTable->psFirst, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pcKey != NULL);
+
+   SymTable_iterFrom(psIter, (struct SymTableLeaf*)psIter->pvPosition,
+      psIter->uIndex + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration along the leaves holds nothing that must be
+   released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableLeaf *psLeaf;
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (psLeaf = oSymTable->psFirst; psLeaf != NULL;
+        psLeaf = psLeaf->psNext)
+      for (i = 0; i < psLeaf->uCount; i++)
+         (*pfApply)(psLeaf->asKeys[i].pcKey, psLeaf->apvValues[i],
+            (void*)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapRange(SymTable_T oSymTable,
+     const char *pcLow, const char *pcHigh,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableKey sLow;
+   struct SymTableKey sHigh;
+   struct SymTableLeaf *psLeaf;
+   size_t i;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   psLeaf = oSymTable->psFirst;
+   i = 0;
+   if (pcLow != NULL) {
+      sLow = SymTable_makeKey(pcLow, strlen(pcLow));
+      psLeaf = SymTable_findLeaf(oSymTable, &sLow);
+      i = SymTable_searchLeaf(psLeaf, &sLow, &iFound);
+   }
+   if (pcHigh != NULL)
+      sHigh = SymTable_makeKey(pcHigh, strlen(pcHigh));
+
+   for (; psLeaf != NULL; psLeaf = psLeaf->psNext, i = 0)
+      for (; i < psLeaf->uCount; i++) {
+         if (pcHigh != NULL
+             && SymTable_compare(&psLeaf->asKeys[i], &sHigh) >= 0)
+            return;
+         (*pfApply)(psLeaf->asKeys[i].pcKey, psLeaf->apvValues[i],
+            (void*)pvExtra);
+      }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableKey sPrefix;
+   struct SymTableKey *psKey;
+   struct SymTableLeaf *psLeaf;
+   size_t uLength;
+   size_t i;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcPrefix != NULL);
+   assert(pfApply != NULL);
+
+   /* The keys that begin with pcPrefix are the run of keys that starts
+   at the first key not less than it. */
+   uLength = strlen(pcPrefix);
+   sPrefix = SymTable_makeKey(pcPrefix, uLength);
+   psLeaf = SymTable_findLeaf(oSymTable, &sPrefix);
+   i = SymTable_searchLeaf(psLeaf, &sPrefix, &iFound);
+
+   for (; psLeaf != NULL; psLeaf = psLeaf->psNext, i = 0)
+      for (; i < psLeaf->uCount; i++) {
+         psKey = &psLeaf->asKeys[i];
+         if ((psKey->uLength & ~BORROWED_KEY) < uLength
+             || memcmp(psKey->pcKey, pcPrefix, uLength) != 0)
+            return;
+         (*pfApply)(psKey->pcKey, psLeaf->apvValues[i],
+            (void*)pvExtra);
+      }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable, which is a run of
+   consecutive leaves. Each part walks the chain of leaves to its first
+   one, which costs one step per leaf rather than per binding. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   struct SymTableLeaf *psLeaf;
+   size_t uLeaf;
+   size_t uFirst;
+   size_t uEnd;
+   size_t i;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uFirst = SymParallel_first(oSymTable->uLeafCount, iPart,
+      iPartCount);
+   uEnd = SymParallel_first(oSymTable->uLeafCount, iPart + 1,
+      iPartCount);
+
+   psLeaf = oSymTable->psFirst;
+   for (uLeaf = 0; uLeaf < uFirst; uLeaf++)
+      psLeaf = psLeaf->psNext;
+   for (; uLeaf < uEnd; uLeaf++, psLeaf = psLeaf->psNext)
+      for (i = 0; i < psLeaf->uCount; i++)
+         (*pfApply)(psLeaf->asKeys[i].pcKey,
+            psLeaf->apvValues[i], pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
@@ -0,0 +1,32 @@
+/*An ordered symbol table implements symtable.h, and keeps its bindings
+in increasing order of key. Keys are compared byte by byte as unsigned
+chars, and a key that is a prefix of another comes first. SymTable_map,
+SymTable_iterBegin and the functions below visit bindings in that
+order, and SymTable_mapParallel gives each thread a run of consecutive
+keys. Only symtableordered.c implements the functions below; a client
+that calls them must be linked with it.*/
+
+#include "symtable.h"
+
+#ifndef SYMTABLEORDERED_INCLUDED
+#define SYMTABLEORDERED_INCLUDED
+
+/*SymTable_mapRange calls (*pfApply)(pcKey, pvValue, pvExtra) for each
+pcKey/pvValue binding of oSymTable such that pcLow <= pcKey < pcHigh,
+in increasing order of key. A NULL pcLow or pcHigh leaves that end of
+the range open. pfApply must not add or remove bindings of
+oSymTable.*/
+void SymTable_mapRange(SymTable_T oSymTable,
+     const char *pcLow, const char *pcHigh,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+/*SymTable_mapPrefix calls (*pfApply)(pcKey, pvValue, pvExtra) for each
+pcKey/pvValue binding of oSymTable such that pcKey begins with
+pcPrefix, in increasing order of key. pfApply must not add or remove
+bindings of oSymTable.*/
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+#endif
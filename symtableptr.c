@@ -0,0 +1,166 @@
+/*A SymTablePtr is a SymTableWord (see symtableword.h) whose uintptr_t
+keys are the client's addresses. An address converts to a uintptr_t
+and back unchanged, so two keys are equal exactly when they are the
+same address.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include "symtableptr.h"
+#include "symtableword.h"
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTablePtr holds the SymTableWord that stores its bindings. */
+struct SymTablePtr
+{
+   /*The table of the bindings, keyed on the conversion of each key*/
+   SymTableWord_T oSymTableWord;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTablePtrApply is a call of SymTablePtr_map, passed as the extra
+parameter of SymTableWord_map. */
+struct SymTablePtrApply
+{
+   /*The function of the client*/
+   void (*pfApply)(const void *pvKey, void *pvValue, void *pvExtra);
+
+   /*The extra parameter of the client*/
+   void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTablePtr_T SymTablePtr_new(void)
+{
+   SymTablePtr_T oSymTablePtr;
+
+   oSymTablePtr = (SymTablePtr_T)malloc(sizeof(struct SymTablePtr));
+   if (oSymTablePtr == NULL) return NULL;
+
+   oSymTablePtr->oSymTableWord = SymTableWord_new();
+   if (oSymTablePtr->oSymTableWord == NULL) {
+      free(oSymTablePtr);
+      return NULL;
+   }
+
+   return oSymTablePtr;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTablePtr_free(SymTablePtr_T oSymTablePtr)
+{
+   assert(oSymTablePtr != NULL);
+
+   SymTableWord_free(oSymTablePtr->oSymTableWord);
+   free(oSymTablePtr);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTablePtr_getLength(SymTablePtr_T oSymTablePtr)
+{
+   assert(oSymTablePtr != NULL);
+
+   return SymTableWord_getLength(oSymTablePtr->oSymTableWord);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTablePtr_put(SymTablePtr_T oSymTablePtr, const void *pvKey,
+     const void *pvValue)
+{
+   assert(oSymTablePtr != NULL);
+
+   return SymTableWord_put(oSymTablePtr->oSymTableWord,
+      (uintptr_t)pvKey, (void*)pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTablePtr_replace(SymTablePtr_T oSymTablePtr, const void *pvKey,
+     const void *pvValue)
+{
+   void *oldVal;
+
+   assert(oSymTablePtr != NULL);
+
+   if (!SymTableWord_replace(oSymTablePtr->oSymTableWord,
+          (uintptr_t)pvKey, (void*)pvValue, &oldVal))
+      return NULL;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTablePtr_contains(SymTablePtr_T oSymTablePtr, const void *pvKey)
+{
+   assert(oSymTablePtr != NULL);
+
+   return SymTableWord_contains(oSymTablePtr->oSymTableWord,
+      (uintptr_t)pvKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTablePtr_get(SymTablePtr_T oSymTablePtr, const void *pvKey)
+{
+   void **ppvValue;
+
+   assert(oSymTablePtr != NULL);
+
+   ppvValue = SymTableWord_get(oSymTablePtr->oSymTableWord,
+      (uintptr_t)pvKey);
+   if (ppvValue == NULL) return NULL;
+   return *ppvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTablePtr_remove(SymTablePtr_T oSymTablePtr, const void *pvKey)
+{
+   void *oldVal;
+
+   assert(oSymTablePtr != NULL);
+
+   if (!SymTableWord_remove(oSymTablePtr->oSymTableWord,
+          (uintptr_t)pvKey, &oldVal))
+      return NULL;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of pvApply, a SymTablePtrApply, to the binding
+   whose converted key is uKey and whose value is *ppvValue. */
+static void SymTablePtr_applyWord(uintptr_t uKey, void **ppvValue,
+   void *pvApply)
+{
+   struct SymTablePtrApply *psApply =
+      (struct SymTablePtrApply*)pvApply;
+
+   assert(ppvValue != NULL);
+   assert(psApply != NULL);
+
+   (*psApply->pfApply)((const void*)uKey, *ppvValue,
+      psApply->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTablePtr_map(SymTablePtr_T oSymTablePtr,
+     void (*pfApply)(const void *pvKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTablePtrApply sApply;
+
+   assert(oSymTablePtr != NULL);
+   assert(pfApply != NULL);
+
+   sApply.pfApply = pfApply;
+   sApply.pvExtra = (void*)pvExtra;
+   SymTableWord_map(oSymTablePtr->oSymTableWord, SymTablePtr_applyWord,
+      &sApply);
+}
@@ -0,0 +1,58 @@
+/*A SymTablePtr is a symbol table whose keys are addresses rather than
+strings. It offers the same operations as a SymTable (see symtable.h),
+but keeps each key inline beside its value and compares keys by
+identity: two keys are equal only if they are the same address, not
+if the objects they point to are equal. The table never dereferences a
+key, so any address, including NULL, is a valid key.*/
+
+#include <stddef.h>
+
+#ifndef SYMTABLEPTR_INCLUDED
+#define SYMTABLEPTR_INCLUDED
+
+/* A SymTablePtr_T is a pointer to a SymTablePtr ADT*/
+typedef struct SymTablePtr *SymTablePtr_T;
+
+/*SymTablePtr_new returns a new SymTablePtr object that contains no
+bindings, or NULL if insufficient memory is available.*/
+SymTablePtr_T SymTablePtr_new(void);
+
+/*SymTablePtr_free frees all memory occupied by oSymTablePtr.*/
+void SymTablePtr_free(SymTablePtr_T oSymTablePtr);
+
+/*SymTablePtr_getLength returns the number of bindings in
+oSymTablePtr.*/
+size_t SymTablePtr_getLength(SymTablePtr_T oSymTablePtr);
+
+/*If oSymTablePtr does not contain a binding with key pvKey, then
+SymTablePtr_put adds a binding consisting of pvKey and pvValue and
+returns 1 (TRUE). Otherwise, or if insufficient memory is available,
+it leaves oSymTablePtr unchanged and returns 0 (FALSE).*/
+int SymTablePtr_put(SymTablePtr_T oSymTablePtr, const void *pvKey,
+     const void *pvValue);
+
+/*SymTablePtr_replace replaces the value of the binding of oSymTablePtr
+with key pvKey by pvValue and returns the old value, or returns NULL if
+there is no such binding.*/
+void *SymTablePtr_replace(SymTablePtr_T oSymTablePtr, const void *pvKey,
+     const void *pvValue);
+
+/*SymTablePtr_contains returns 1 (TRUE) if oSymTablePtr contains a
+binding with key pvKey, and 0 (FALSE) if not.*/
+int SymTablePtr_contains(SymTablePtr_T oSymTablePtr, const void *pvKey);
+
+/*SymTablePtr_get returns the value of the binding of oSymTablePtr with
+key pvKey, or NULL if there is none.*/
+void *SymTablePtr_get(SymTablePtr_T oSymTablePtr, const void *pvKey);
+
+/*SymTablePtr_remove removes the binding of oSymTablePtr with key pvKey
+and returns its value, or returns NULL if there is none.*/
+void *SymTablePtr_remove(SymTablePtr_T oSymTablePtr, const void *pvKey);
+
+/*SymTablePtr_map calls (*pfApply)(pvKey, pvValue, pvExtra) for each
+pvKey/pvValue binding of oSymTablePtr.*/
+void SymTablePtr_map(SymTablePtr_T oSymTablePtr,
+     void (*pfApply)(const void *pvKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+#endif
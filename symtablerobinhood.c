@@ -0,0 +1,756 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation specifically uses an open-addressing hash table
+with linear probing and Robin Hood displacement. Hashes, keys and
+values live in three flat arrays instead of linked bindings, so a
+probe walks consecutive memory rather than chasing pointers.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+/*The number of slots allocated by SymTable_new. The slot count is
+always a power of two so that a hash can be reduced with a mask*/
+enum {INITIAL_SLOT_COUNT = 16};
+
+/*The table expands once more than MAX_LOAD_NUM / MAX_LOAD_DEN of its
+slots are in use*/
+enum {MAX_LOAD_NUM = 4, MAX_LOAD_DEN = 5};
+
+/*Once removals leave fewer than 1 / SHRINK_LOAD_DEN of its slots in
+use, the table shrinks to the fewest slots that are at most
+SHRINK_TARGET_NUM / SHRINK_TARGET_DEN in use, which is far enough from
+both thresholds that put/remove churn does not resize repeatedly*/
+enum {SHRINK_LOAD_DEN = 8};
+enum {SHRINK_TARGET_NUM = 2, SHRINK_TARGET_DEN = 5};
+
+/*A stored hash of EMPTY_HASH marks an unused slot; SymTable_hash never
+returns it*/
+enum {EMPTY_HASH = 0};
+
+/*Set in the stored length of a key that the client lent with
+SymTable_putBorrowed, which the symbol table must not free*/
+static const size_t BORROWED_KEY = ~((size_t)-1 >> 1);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable stores slot i's binding as puHashes[i], ppcKeys[i],
+puLengths[i] and ppvValues[i]. Every binding sits at or after its home
+slot (its hash masked by the slot count), and bindings that are further
+from home are never placed behind bindings that are closer to home. */
+struct SymTable
+{
+   /*The number of slots in each array, always a power of two*/
+   size_t numSlots;
+
+   /*The number of bindings within the symbol table*/
+   size_t bindingCount;
+
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*The full hash of the key in each slot, or EMPTY_HASH*/
+   size_t *puHashes;
+
+   /*The key in each occupied slot, owned by the symbol table unless
+   it is borrowed*/
+   const char **ppcKeys;
+
+   /*The length of the key in each occupied slot, so that keys of other
+   lengths are rejected without reading them, with BORROWED_KEY set if
+   the key is borrowed*/
+   size_t *puLengths;
+
+   /*The value in each occupied slot*/
+   void **ppvValues;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of pcKey, which is uLength characters long, in
+   oSymTable. It is never EMPTY_HASH. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength)
+{
+   size_t uHash;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   if (uHash == EMPTY_HASH) uHash = 1;
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a copy of pcKey, which is uLength characters long, or NULL
+   if insufficient memory is available. */
+static char *SymTable_copyKey(const char *pcKey, size_t uLength)
+{
+   char *pcKeyCopy;
+
+   assert(pcKey != NULL);
+
+   pcKeyCopy = (char*)malloc(uLength + 1);
+   if (pcKeyCopy == NULL) return NULL;
+   memcpy(pcKeyCopy, pcKey, uLength);
+   pcKeyCopy[uLength] = '\0';
+   return pcKeyCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the key in slot uSlot of oSymTable, which must be occupied,
+   unless it is borrowed. */
+static void SymTable_freeKey(SymTable_T oSymTable, size_t uSlot)
+{
+   assert(oSymTable != NULL);
+
+   if ((oSymTable->puLengths[uSlot] & BORROWED_KEY) == 0)
+      free((char*)oSymTable->ppcKeys[uSlot]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the key in slot uSlot of oSymTable, which must be
+   occupied, is pcKey, which is uLength characters long, or 0 (FALSE)
+   otherwise. */
+static int SymTable_keyEquals(SymTable_T oSymTable, size_t uSlot,
+   const char *pcKey, size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return (oSymTable->puLengths[uSlot] & ~BORROWED_KEY) == uLength
+      && !memcmp(oSymTable->ppcKeys[uSlot], pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return how far slot uSlot of oSymTable, which must be occupied, is
+   from the home slot of its binding. */
+static size_t SymTable_distance(SymTable_T oSymTable, size_t uSlot)
+{
+   size_t uMask = oSymTable->numSlots - 1;
+   return (uSlot - (oSymTable->puHashes[uSlot] & uMask)) & uMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate uSlotCount empty slots for oSymTable, leaving its previous
+   arrays untouched. Return 1 on success, or 0 if insufficient memory
+   is available. */
+static int SymTable_allocSlots(SymTable_T oSymTable, size_t uSlotCount)
+{
+   size_t *puHashes;
+   const char **ppcKeys;
+   size_t *puLengths;
+   void **ppvValues;
+
+   puHashes = (size_t*)calloc(uSlotCount, sizeof(size_t));
+   ppcKeys = (const char**)malloc(uSlotCount * sizeof(const char*));
+   puLengths = (size_t*)malloc(uSlotCount * sizeof(size_t));
+   ppvValues = (void**)malloc(uSlotCount * sizeof(void*));
+   if (puHashes == NULL || ppcKeys == NULL || puLengths == NULL
+       || ppvValues == NULL) {
+      free(puHashes);
+      free(ppcKeys);
+      free(puLengths);
+      free(ppvValues);
+      return 0;
+   }
+
+   oSymTable->numSlots = uSlotCount;
+   oSymTable->puHashes = puHashes;
+   oSymTable->ppcKeys = ppcKeys;
+   oSymTable->puLengths = puLengths;
+   oSymTable->ppvValues = ppvValues;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Place the binding (uHash, pcKey, uLength, pvValue), whose key must
+   not be in oSymTable, into slot uSlot of oSymTable, which is uDistance
+   slots from the binding's home slot. Any binding evicted from uSlot
+   moves on in turn, displacing bindings that are closer to home than
+   itself. There must be an empty slot. */
+static void SymTable_placeAt(SymTable_T oSymTable, size_t uSlot,
+   size_t uDistance, size_t uHash, const char *pcKey, size_t uLength,
+   void *pvValue)
+{
+   size_t uMask = oSymTable->numSlots - 1;
+   size_t uSlotDistance;
+
+   while (oSymTable->puHashes[uSlot] != EMPTY_HASH) {
+      uSlotDistance = SymTable_distance(oSymTable, uSlot);
+      if (uSlotDistance < uDistance) {
+         size_t uTempHash = oSymTable->puHashes[uSlot];
+         const char *pcTempKey = oSymTable->ppcKeys[uSlot];
+         size_t uTempLength = oSymTable->puLengths[uSlot];
+         void *pvTempValue = oSymTable->ppvValues[uSlot];
+
+         oSymTable->puHashes[uSlot] = uHash;
+         oSymTable->ppcKeys[uSlot] = pcKey;
+         oSymTable->puLengths[uSlot] = uLength;
+         oSymTable->ppvValues[uSlot] = pvValue;
+
+         uHash = uTempHash;
+         pcKey = pcTempKey;
+         uLength = uTempLength;
+         pvValue = pvTempValue;
+         uDistance = uSlotDistance;
+      }
+      uSlot = (uSlot + 1) & uMask;
+      uDistance++;
+   }
+
+   oSymTable->puHashes[uSlot] = uHash;
+   oSymTable->ppcKeys[uSlot] = pcKey;
+   oSymTable->puLengths[uSlot] = uLength;
+   oSymTable->ppvValues[uSlot] = pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the slot of oSymTable that holds the key pcKey, which is
+   uLength characters long and whose hash is uHash, or
+   oSymTable->numSlots if there is no such slot. */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength, size_t uHash)
+{
+   size_t uMask = oSymTable->numSlots - 1;
+   size_t uSlot = uHash & uMask;
+   size_t uDistance = 0;
+
+   while (oSymTable->puHashes[uSlot] != EMPTY_HASH
+          && SymTable_distance(oSymTable, uSlot) >= uDistance) {
+      if (oSymTable->puHashes[uSlot] == uHash
+          && SymTable_keyEquals(oSymTable, uSlot, pcKey, uLength))
+         return uSlot;
+      uSlot = (uSlot + 1) & uMask;
+      uDistance++;
+   }
+   return oSymTable->numSlots;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   SymTable_T oSymTable;
+
+   assert(pfHash != NULL);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   oSymTable->bindingCount = 0;
+   oSymTable->pfHash = pfHash;
+   if (!SymTable_allocSlots(oSymTable, INITIAL_SLOT_COUNT)) {
+      free(oSymTable);
+      return NULL;
+   }
+
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Robin Hood placement fixes where each binding sits in its probe
+   sequence, so the table ignores iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->puHashes[uSlot] != EMPTY_HASH)
+         SymTable_freeKey(oSymTable, uSlot);
+   }
+
+   free(oSymTable->puHashes);
+   free(oSymTable->ppcKeys);
+   free(oSymTable->puLengths);
+   free(oSymTable->ppvValues);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_rehash changes the slot count of oSymTable to uNewCount, a
+power of two with room for every binding, and moves every binding into
+the new arrays using its stored hash. If insufficient memory is
+available, oSymTable is left unchanged.*/
+static void SymTable_rehash(SymTable_T oSymTable, size_t uNewCount)
+{
+   size_t uOldCount = oSymTable->numSlots;
+   size_t *puOldHashes = oSymTable->puHashes;
+   const char **ppcOldKeys = oSymTable->ppcKeys;
+   size_t *puOldLengths = oSymTable->puLengths;
+   void **ppvOldValues = oSymTable->ppvValues;
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+
+   if (!SymTable_allocSlots(oSymTable, uNewCount)) return;
+
+   for (uSlot = 0; uSlot < uOldCount; uSlot++) {
+      if (puOldHashes[uSlot] != EMPTY_HASH)
+         SymTable_placeAt(oSymTable,
+            puOldHashes[uSlot] & (oSymTable->numSlots - 1), 0,
+            puOldHashes[uSlot], ppcOldKeys[uSlot], puOldLengths[uSlot],
+            ppvOldValues[uSlot]);
+   }
+
+   free(puOldHashes);
+   free(ppcOldKeys);
+   free(puOldLengths);
+   free(ppvOldValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_findOrAdd is SymTable_findOrInsertN, except that if
+   iBorrow is 1 (TRUE), a binding that it adds borrows pcKey, which
+   must then be followed by '\0', instead of copying it. */
+static void **SymTable_findOrAdd(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int iBorrow, int *piInserted)
+{
+   size_t uHash;
+   size_t uMask;
+   size_t uSlot;
+   size_t uDistance;
+   size_t uOldCount;
+   const char *pcKeyCopy;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   uHash = SymTable_hash(oSymTable, pcKey, uLength);
+
+   for (;;) {
+      /* Probe until the key is found, or until the slot where it would
+      have to be placed is reached. */
+      uMask = oSymTable->numSlots - 1;
+      uSlot = uHash & uMask;
+      uDistance = 0;
+      while (oSymTable->puHashes[uSlot] != EMPTY_HASH
+             && SymTable_distance(oSymTable, uSlot) >= uDistance) {
+         if (oSymTable->puHashes[uSlot] == uHash
+             && SymTable_keyEquals(oSymTable, uSlot, pcKey, uLength)) {
+            *piInserted = 0;
+            return &oSymTable->ppvValues[uSlot];
+         }
+         uSlot = (uSlot + 1) & uMask;
+         uDistance++;
+      }
+
+      if ((oSymTable->bindingCount + 1) * MAX_LOAD_DEN
+            <= oSymTable->numSlots * MAX_LOAD_NUM)
+         break;
+
+      /* Expansion moves every binding, so probe again afterward. Keep
+      at least one slot empty even if expansion fails. */
+      uOldCount = oSymTable->numSlots;
+      if (uOldCount <= ((size_t)-1 / 2) / sizeof(size_t))
+         SymTable_rehash(oSymTable, 2 * uOldCount);
+      if (oSymTable->numSlots == uOldCount) {
+         if (oSymTable->bindingCount + 1 >= oSymTable->numSlots)
+            return NULL;
+         break;
+      }
+   }
+
+   pcKeyCopy = iBorrow ? pcKey : SymTable_copyKey(pcKey, uLength);
+   if (pcKeyCopy == NULL)
+      return NULL;
+
+   /* The new binding stays in uSlot; only bindings it evicts move. */
+   SymTable_placeAt(oSymTable, uSlot, uDistance, uHash, pcKeyCopy,
+      iBorrow ? uLength | BORROWED_KEY : uLength, NULL);
+   oSymTable->bindingCount++;
+
+   *piInserted = 1;
+   return &oSymTable->ppvValues[uSlot];
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   return SymTable_findOrAdd(oSymTable, pcKey, uLength, 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), 1,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   size_t uSlot;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->ppvValues[uSlot];
+   oSymTable->ppvValues[uSlot] = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   size_t uMask;
+   size_t uSlot;
+   size_t uNext;
+   size_t uNewCount;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->ppvValues[uSlot];
+   SymTable_freeKey(oSymTable, uSlot);
+
+   /* Shift the following displaced bindings back by one slot, so no
+   tombstone is needed. */
+   uMask = oSymTable->numSlots - 1;
+   uNext = (uSlot + 1) & uMask;
+   while (oSymTable->puHashes[uNext] != EMPTY_HASH
+          && SymTable_distance(oSymTable, uNext) != 0) {
+      oSymTable->puHashes[uSlot] = oSymTable->puHashes[uNext];
+      oSymTable->ppcKeys[uSlot] = oSymTable->ppcKeys[uNext];
+      oSymTable->puLengths[uSlot] = oSymTable->puLengths[uNext];
+      oSymTable->ppvValues[uSlot] = oSymTable->ppvValues[uNext];
+      uSlot = uNext;
+      uNext = (uNext + 1) & uMask;
+   }
+   oSymTable->puHashes[uSlot] = EMPTY_HASH;
+
+   oSymTable->bindingCount--;
+
+   if (oSymTable->numSlots > INITIAL_SLOT_COUNT
+       && oSymTable->bindingCount * SHRINK_LOAD_DEN
+            < oSymTable->numSlots) {
+      uNewCount = INITIAL_SLOT_COUNT;
+      while (oSymTable->bindingCount * SHRINK_TARGET_DEN
+               > uNewCount * SHRINK_TARGET_NUM)
+         uNewCount *= 2;
+      SymTable_rehash(oSymTable, uNewCount);
+   }
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+   return oSymTable->ppvValues[uSlot];
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength))
+      != oSymTable->numSlots;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding in a slot at or after uSlot, or
+   finish psIter if there is none. */
+static void SymTable_iterFrom(SymTable_Iter *psIter, size_t uSlot)
+{
+   SymTable_T oSymTable;
+
+   assert(psIter != NULL);
+
+   oSymTable = psIter->oSymTable;
+   for (; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->puHashes[uSlot] != EMPTY_HASH) {
+         psIter->uIndex = uSlot;
+         psIter->pcKey = oSymTable->ppcKeys[uSlot];
+         psIter->pvValue = oSymTable->ppvValues[uSlot];
+         return;
+      }
+   }
+   psIter->uIndex = oSymTable->numSlots;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvPosition = NULL;
+   SymTable_iterFrom(psIter, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pcKey != NULL);
+
+   SymTable_iterFrom(psIter, psIter->uIndex + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration of the slots holds nothing that must be released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if (oSymTable->puHashes[uSlot] != EMPTY_HASH)
+         (*pfApply)(oSymTable->ppcKeys[uSlot],
+            oSymTable->ppvValues[uSlot], (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable, which is a run of
+   consecutive slots. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   size_t uSlot;
+   size_t uEnd;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uEnd = SymParallel_first(oSymTable->numSlots, iPart + 1,
+      iPartCount);
+
+   for (uSlot = SymParallel_first(oSymTable->numSlots, iPart,
+           iPartCount);
+        uSlot < uEnd; uSlot++)
+   {
+      if (oSymTable->puHashes[uSlot] != EMPTY_HASH)
+         (*pfApply)(oSymTable->ppcKeys[uSlot],
+            oSymTable->ppvValues[uSlot], pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
@@ -0,0 +1,900 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation is a hash table that any number of threads may
+use at once. Its buckets are divided among STRIPE_COUNT stripes, each
+guarded by its own reader/writer lock, so that gets and contains of
+different threads proceed in parallel, and puts and removes lock only
+the stripe of their key. Only resizing locks the whole table.
+SymTable_new, SymTable_newWithHash and SymTable_free must not run
+concurrently with any other call on the same table.*/
+
+/* Request POSIX declarations, for reader/writer locks. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+/*The number of lock stripes, a power of two. The bucket of a hash is
+its low bits, so bucket b always belongs to stripe b % STRIPE_COUNT,
+however many buckets the table has*/
+enum {STRIPE_COUNT = 64};
+
+/*The number of buckets of a new table. Bucket counts are always powers
+of two and never fewer than STRIPE_COUNT*/
+enum {INITIAL_BUCKET_COUNT = 512};
+
+/*Once removals leave fewer than one binding per SHRINK_LOAD_DEN
+buckets, the table shrinks back to about two buckets per binding*/
+enum {SHRINK_LOAD_DEN = 8};
+
+/*The bytes reserved for each stripe: twice a 64-byte cache line, so
+that no two stripes share a cache line however the table is aligned*/
+enum {STRIPE_SIZE = 128};
+
+/* Each key and value is stored in a SymTableBinding. SymTableBindings
+are linked to form a list. */
+struct SymTableBinding
+{
+   /*The full hash of pcKey*/
+   size_t uHash;
+
+   /*The length of pcKey, so that keys of other lengths are rejected
+   without comparing them*/
+   size_t uLength;
+
+   /*The key associated with the binding: acKey, or the client's own
+   key if it was borrowed with SymTable_putBorrowed*/
+   const char *pcKey;
+
+   /*The pointer to the value associated with the binding*/
+   void *pvValue;
+
+   /*The pointer to the next binding to allow for a linked list*/
+   struct SymTableBinding *psNextBinding;
+
+   /*The copy of the key, allocated with the binding unless the key is
+   borrowed*/
+   char acKey[];
+};
+
+/* A SymTableStripe guards every bucket whose index is congruent to
+its own index modulo STRIPE_COUNT. */
+struct SymTableStripe
+{
+   /*Held for reading to search the buckets of the stripe, and for
+   writing to change them*/
+   pthread_rwlock_t sLock;
+
+   /*The number of bindings in the buckets of the stripe*/
+   size_t uBindingCount;
+};
+
+/* A SymTablePaddedStripe keeps a stripe on cache lines of its own, so
+that threads locking different stripes do not contend for them. */
+union SymTablePaddedStripe
+{
+   struct SymTableStripe sStripe;
+   char acPad[STRIPE_SIZE];
+};
+
+/* A SymTable is an array of buckets, each of which points to the
+first SymTableBinding of its list, and the stripes that guard them.
+numBuckets and ppsBuckets change only while every stripe is locked for
+writing, so holding any one stripe lock is enough to read them. */
+struct SymTable
+{
+   /*The stripes of the table, placed first so that the fields below,
+   which every call reads, share no cache line with a lock*/
+   union SymTablePaddedStripe auStripes[STRIPE_COUNT];
+
+   /*The number of buckets, always a power of two*/
+   size_t numBuckets;
+
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*The first SymTableBinding of each bucket, or NULL if the bucket is
+   empty*/
+   struct SymTableBinding **ppsBuckets;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the stripe of oSymTable that guards the bucket of hash
+   uHash. */
+static struct SymTableStripe *SymTable_stripe(SymTable_T oSymTable,
+   size_t uHash)
+{
+   assert(oSymTable != NULL);
+
+   return &oSymTable->auStripes[uHash & (STRIPE_COUNT - 1)].sStripe;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock every stripe of oSymTable, for writing if iWrite is 1 and for
+   reading otherwise. Stripes are always locked in index order, so
+   that two threads locking them all cannot deadlock. */
+static void SymTable_lockAll(SymTable_T oSymTable, int iWrite)
+{
+   int iStripe;
+
+   assert(oSymTable != NULL);
+
+   for (iStripe = 0; iStripe < STRIPE_COUNT; iStripe++) {
+      if (iWrite)
+         pthread_rwlock_wrlock(
+            &oSymTable->auStripes[iStripe].sStripe.sLock);
+      else
+         pthread_rwlock_rdlock(
+            &oSymTable->auStripes[iStripe].sStripe.sLock);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Unlock every stripe of oSymTable. */
+static void SymTable_unlockAll(SymTable_T oSymTable)
+{
+   int iStripe;
+
+   assert(oSymTable != NULL);
+
+   for (iStripe = STRIPE_COUNT - 1; iStripe >= 0; iStripe--)
+      pthread_rwlock_unlock(
+         &oSymTable->auStripes[iStripe].sStripe.sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable. Every stripe must be
+   locked. */
+static size_t SymTable_count(SymTable_T oSymTable)
+{
+   size_t uCount = 0;
+   int iStripe;
+
+   assert(oSymTable != NULL);
+
+   for (iStripe = 0; iStripe < STRIPE_COUNT; iStripe++)
+      uCount += oSymTable->auStripes[iStripe].sStripe.uBindingCount;
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   SymTable_T oSymTable;
+   int iStripe;
+
+   assert(pfHash != NULL);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   oSymTable->ppsBuckets = (struct SymTableBinding **)
+      calloc(INITIAL_BUCKET_COUNT, sizeof(struct SymTableBinding *));
+   if (oSymTable->ppsBuckets == NULL) {
+      free(oSymTable);
+      return NULL;
+   }
+
+   for (iStripe = 0; iStripe < STRIPE_COUNT; iStripe++) {
+      struct SymTableStripe *psStripe =
+         &oSymTable->auStripes[iStripe].sStripe;
+      if (pthread_rwlock_init(&psStripe->sLock, NULL) != 0) {
+         while (--iStripe >= 0)
+            pthread_rwlock_destroy(
+               &oSymTable->auStripes[iStripe].sStripe.sLock);
+         free(oSymTable->ppsBuckets);
+         free(oSymTable);
+         return NULL;
+      }
+      psStripe->uBindingCount = 0;
+   }
+
+   oSymTable->numBuckets = INITIAL_BUCKET_COUNT;
+   oSymTable->pfHash = pfHash;
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Each key is found by its hash, and gets hold only a shared lock,
+   under which they must not relink a chain, so the table ignores
+   iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   struct SymTableBinding *psCurrentBinding;
+   struct SymTableBinding *psNextBinding;
+   size_t hashNum;
+   int iStripe;
+
+   assert(oSymTable != NULL);
+
+   for (hashNum = 0; hashNum < oSymTable->numBuckets; hashNum++) {
+      for (psCurrentBinding = oSymTable->ppsBuckets[hashNum];
+           psCurrentBinding != NULL;
+           psCurrentBinding = psNextBinding)
+      {
+         psNextBinding = psCurrentBinding->psNextBinding;
+         free(psCurrentBinding);
+      }
+   }
+
+   for (iStripe = 0; iStripe < STRIPE_COUNT; iStripe++)
+      pthread_rwlock_destroy(
+         &oSymTable->auStripes[iStripe].sStripe.sLock);
+
+   free(oSymTable->ppsBuckets);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   size_t uCount;
+
+   assert(oSymTable != NULL);
+
+   SymTable_lockAll(oSymTable, 0);
+   uCount = SymTable_count(oSymTable);
+   SymTable_unlockAll(oSymTable);
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_resize relinks every binding of oSymTable into
+newBucketCount new buckets, leaving oSymTable unchanged if
+insufficient memory is available. Bindings do not move, so the
+addresses of their values stay valid. Every stripe must be locked for
+writing.*/
+static void SymTable_resize(SymTable_T oSymTable, size_t newBucketCount)
+{
+   struct SymTableBinding **ppsNewBuckets;
+   struct SymTableBinding *psCurrentBinding;
+   struct SymTableBinding *psNextBinding;
+   size_t hashNum;
+   size_t newHashNum;
+
+   assert(oSymTable != NULL);
+   assert(newBucketCount >= STRIPE_COUNT);
+
+   ppsNewBuckets = (struct SymTableBinding **)
+      calloc(newBucketCount, sizeof(struct SymTableBinding *));
+   if (ppsNewBuckets == NULL) return;
+
+   for (hashNum = 0; hashNum < oSymTable->numBuckets; hashNum++) {
+      for (psCurrentBinding = oSymTable->ppsBuckets[hashNum];
+           psCurrentBinding != NULL;
+           psCurrentBinding = psNextBinding)
+      {
+         psNextBinding = psCurrentBinding->psNextBinding;
+         newHashNum = psCurrentBinding->uHash & (newBucketCount - 1);
+         psCurrentBinding->psNextBinding = ppsNewBuckets[newHashNum];
+         ppsNewBuckets[newHashNum] = psCurrentBinding;
+      }
+   }
+
+   free(oSymTable->ppsBuckets);
+   oSymTable->ppsBuckets = ppsNewBuckets;
+   oSymTable->numBuckets = newBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_grow doubles the bucket count of oSymTable if it holds more
+bindings than buckets. A put calls it, without holding any lock, once
+the stripe of its key holds more bindings than that stripe has
+buckets; the table as a whole is checked again here because another
+thread may have grown it in between.*/
+static void SymTable_grow(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   SymTable_lockAll(oSymTable, 1);
+   if (SymTable_count(oSymTable) > oSymTable->numBuckets
+       && oSymTable->numBuckets <=
+          ((size_t)-1 / 2) / sizeof(struct SymTableBinding *))
+      SymTable_resize(oSymTable, 2 * oSymTable->numBuckets);
+   SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*SymTable_shrink reduces the bucket count of oSymTable to about twice
+its binding count, but no fewer than INITIAL_BUCKET_COUNT, if it holds
+fewer than one binding per SHRINK_LOAD_DEN buckets. A remove calls it,
+without holding any lock, once the stripe of its key is that sparse.*/
+static void SymTable_shrink(SymTable_T oSymTable)
+{
+   size_t uCount;
+   size_t newBucketCount = INITIAL_BUCKET_COUNT;
+
+   assert(oSymTable != NULL);
+
+   SymTable_lockAll(oSymTable, 1);
+   uCount = SymTable_count(oSymTable);
+   if (oSymTable->numBuckets > INITIAL_BUCKET_COUNT
+       && uCount * SHRINK_LOAD_DEN < oSymTable->numBuckets) {
+      while (newBucketCount < 2 * uCount)
+         newBucketCount *= 2;
+      SymTable_resize(oSymTable, newBucketCount);
+   }
+   SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*Return the address of the link, either a bucket or the psNextBinding
+field of a binding, that points to the binding of oSymTable whose key
+is pcKey, which is uLength characters long and has hash uHash, or NULL
+if there is no such binding. The stripe of uHash must be locked.*/
+static struct SymTableBinding **SymTable_findLink(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength, size_t uHash)
+{
+   struct SymTableBinding **ppsLink;
+   struct SymTableBinding *psCurrentBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   for (ppsLink =
+           &oSymTable->ppsBuckets[uHash & (oSymTable->numBuckets - 1)];
+        (psCurrentBinding = *ppsLink) != NULL;
+        ppsLink = &psCurrentBinding->psNextBinding)
+   {
+      if (psCurrentBinding->uHash == uHash
+          && psCurrentBinding->uLength == uLength
+          && !memcmp(pcKey, psCurrentBinding->pcKey, uLength))
+         return ppsLink;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*Return the binding of oSymTable whose key is pcKey, which is uLength
+characters long and has hash uHash, or NULL if there is no such
+binding. The stripe of uHash must be locked.*/
+static struct SymTableBinding *SymTable_find(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength, size_t uHash)
+{
+   struct SymTableBinding **ppsLink;
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+   if (ppsLink == NULL) return NULL;
+   return *ppsLink;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here the returned address stays valid until the binding is removed,
+   whichever thread removes it. Reads and writes through it are not
+   synchronized with other threads. */
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   struct SymTableStripe *psStripe;
+   struct SymTableBinding *psNewBinding;
+   size_t uHash;
+   size_t hashNum;
+   int iGrow;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_wrlock(&psStripe->sLock);
+
+   psNewBinding = SymTable_find(oSymTable, pcKey, uLength, uHash);
+   if (psNewBinding != NULL) {
+      pthread_rwlock_unlock(&psStripe->sLock);
+      *piInserted = 0;
+      return &psNewBinding->pvValue;
+   }
+
+   psNewBinding = (struct SymTableBinding*)
+      malloc(sizeof(struct SymTableBinding) + uLength + 1);
+   if (psNewBinding == NULL) {
+      pthread_rwlock_unlock(&psStripe->sLock);
+      return NULL;
+   }
+
+   memcpy(psNewBinding->acKey, pcKey, uLength);
+   psNewBinding->acKey[uLength] = '\0';
+   psNewBinding->pcKey = psNewBinding->acKey;
+   psNewBinding->uLength = uLength;
+   psNewBinding->pvValue = NULL;
+   psNewBinding->uHash = uHash;
+
+   hashNum = uHash & (oSymTable->numBuckets - 1);
+   psNewBinding->psNextBinding = oSymTable->ppsBuckets[hashNum];
+   oSymTable->ppsBuckets[hashNum] = psNewBinding;
+   psStripe->uBindingCount++;
+
+   iGrow = psStripe->uBindingCount >
+      oSymTable->numBuckets / STRIPE_COUNT;
+
+   pthread_rwlock_unlock(&psStripe->sLock);
+
+   if (iGrow) SymTable_grow(oSymTable);
+
+   *piInserted = 1;
+   return &psNewBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_putKey is SymTable_putN, except that if iBorrow is 1
+   (TRUE), a binding that it adds borrows pcKey, which must then be
+   followed by '\0', instead of copying it. */
+static int SymTable_putKey(SymTable_T oSymTable, const char *pcKey,
+     size_t uLength, const void *pvValue, int iBorrow)
+{
+   struct SymTableStripe *psStripe;
+   struct SymTableBinding *psNewBinding;
+   size_t uHash;
+   size_t hashNum;
+   int iGrow;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* Unlike the other implementations, put does not call
+   SymTable_findOrInsertN, because another thread could see the NULL
+   value of the new binding before pvValue is stored. */
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_wrlock(&psStripe->sLock);
+
+   if (SymTable_find(oSymTable, pcKey, uLength, uHash) != NULL) {
+      pthread_rwlock_unlock(&psStripe->sLock);
+      return 0;
+   }
+
+   psNewBinding = (struct SymTableBinding*)
+      malloc(sizeof(struct SymTableBinding)
+         + (iBorrow ? 0 : uLength + 1));
+   if (psNewBinding == NULL) {
+      pthread_rwlock_unlock(&psStripe->sLock);
+      return 0;
+   }
+
+   if (iBorrow)
+      psNewBinding->pcKey = pcKey;
+   else {
+      memcpy(psNewBinding->acKey, pcKey, uLength);
+      psNewBinding->acKey[uLength] = '\0';
+      psNewBinding->pcKey = psNewBinding->acKey;
+   }
+   psNewBinding->uLength = uLength;
+   psNewBinding->pvValue = (void*) pvValue;
+   psNewBinding->uHash = uHash;
+
+   hashNum = uHash & (oSymTable->numBuckets - 1);
+   psNewBinding->psNextBinding = oSymTable->ppsBuckets[hashNum];
+   oSymTable->ppsBuckets[hashNum] = psNewBinding;
+   psStripe->uBindingCount++;
+
+   iGrow = psStripe->uBindingCount >
+      oSymTable->numBuckets / STRIPE_COUNT;
+
+   pthread_rwlock_unlock(&psStripe->sLock);
+
+   if (iGrow) SymTable_grow(oSymTable);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   return SymTable_putKey(oSymTable, pcKey, uLength, pvValue, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putKey(oSymTable, pcKey, strlen(pcKey), pvValue, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   struct SymTableStripe *psStripe;
+   struct SymTableBinding *psBinding;
+   size_t uHash;
+   void *oldVal = NULL;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_wrlock(&psStripe->sLock);
+   psBinding = SymTable_find(oSymTable, pcKey, uLength, uHash);
+   if (psBinding != NULL) {
+      oldVal = psBinding->pvValue;
+      psBinding->pvValue = (void*) pvValue;
+   }
+   pthread_rwlock_unlock(&psStripe->sLock);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableStripe *psStripe;
+   struct SymTableBinding **ppsLink;
+   struct SymTableBinding *psCurrentBinding;
+   size_t uHash;
+   void *oldVal;
+   int iShrink;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_wrlock(&psStripe->sLock);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+   if (ppsLink == NULL) {
+      pthread_rwlock_unlock(&psStripe->sLock);
+      return NULL;
+   }
+
+   psCurrentBinding = *ppsLink;
+   oldVal = psCurrentBinding->pvValue;
+   *ppsLink = psCurrentBinding->psNextBinding;
+   psStripe->uBindingCount--;
+
+   iShrink = oSymTable->numBuckets > INITIAL_BUCKET_COUNT
+      && psStripe->uBindingCount * SHRINK_LOAD_DEN
+         < oSymTable->numBuckets / STRIPE_COUNT;
+
+   pthread_rwlock_unlock(&psStripe->sLock);
+
+   free(psCurrentBinding);
+   if (iShrink) SymTable_shrink(oSymTable);
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableStripe *psStripe;
+   struct SymTableBinding *psBinding;
+   size_t uHash;
+   void *pvValue = NULL;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_rdlock(&psStripe->sLock);
+   psBinding = SymTable_find(oSymTable, pcKey, uLength, uHash);
+   if (psBinding != NULL) pvValue = psBinding->pvValue;
+   pthread_rwlock_unlock(&psStripe->sLock);
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableStripe *psStripe;
+   size_t uHash;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = (*oSymTable->pfHash)(pcKey, uLength);
+   psStripe = SymTable_stripe(oSymTable, uHash);
+
+   pthread_rwlock_rdlock(&psStripe->sLock);
+   iFound = SymTable_find(oSymTable, pcKey, uLength, uHash) != NULL;
+   pthread_rwlock_unlock(&psStripe->sLock);
+   return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at psBinding, the binding in bucket uIndex, or finish
+   psIter, releasing the stripes that it holds, if psBinding is
+   NULL. */
+static void SymTable_iterAt(SymTable_Iter *psIter,
+     struct SymTableBinding *psBinding, size_t uIndex)
+{
+   assert(psIter != NULL);
+
+   psIter->pvPosition = psBinding;
+   psIter->uIndex = uIndex;
+   if (psBinding == NULL) {
+      psIter->pcKey = NULL;
+      psIter->pvValue = NULL;
+      SymTable_unlockAll(psIter->oSymTable);
+      return;
+   }
+   psIter->pcKey = psBinding->pcKey;
+   psIter->pvValue = psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding of the first nonempty bucket at
+   or after uIndex, or finish psIter if there is none. */
+static void SymTable_iterFrom(SymTable_Iter *psIter, size_t uIndex)
+{
+   SymTable_T oSymTable;
+
+   assert(psIter != NULL);
+
+   oSymTable = psIter->oSymTable;
+   for (; uIndex < oSymTable->numBuckets; uIndex++) {
+      if (oSymTable->ppsBuckets[uIndex] != NULL) {
+         SymTable_iterAt(psIter, oSymTable->ppsBuckets[uIndex],
+            uIndex);
+         return;
+      }
+   }
+   SymTable_iterAt(psIter, NULL, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here every stripe stays locked for reading from SymTable_iterBegin
+   until the iteration is done or ended, so the iteration sees a
+   consistent snapshot, but the thread iterating must not add or
+   remove bindings of oSymTable meanwhile. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   SymTable_lockAll(oSymTable, 0);
+   SymTable_iterFrom(psIter, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   struct SymTableBinding *psBinding;
+
+   assert(psIter != NULL);
+   assert(psIter->pvPosition != NULL);
+
+   psBinding =
+      ((struct SymTableBinding*)psIter->pvPosition)->psNextBinding;
+   if (psBinding != NULL)
+      SymTable_iterAt(psIter, psBinding, psIter->uIndex);
+   else
+      SymTable_iterFrom(psIter, psIter->uIndex + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   if (psIter->pcKey != NULL) SymTable_iterAt(psIter, NULL, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here every stripe stays locked for reading while pfApply runs, so
+   pfApply sees a consistent snapshot but must not call any function
+   on oSymTable. */
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableBinding *psCurrentBinding;
+   size_t hashNum;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   SymTable_lockAll(oSymTable, 0);
+   for (hashNum = 0; hashNum < oSymTable->numBuckets; hashNum++) {
+      for (psCurrentBinding = oSymTable->ppsBuckets[hashNum];
+           psCurrentBinding != NULL;
+           psCurrentBinding = psCurrentBinding->psNextBinding)
+      {
+         (*pfApply)(psCurrentBinding->pcKey,
+            psCurrentBinding->pvValue, (void*)pvExtra);
+      }
+   }
+   SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable, which is a run of
+   consecutive buckets. The caller holds every stripe for reading. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   struct SymTableBinding *psCurrentBinding;
+   size_t hashNum;
+   size_t uEnd;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uEnd = SymParallel_first(oSymTable->numBuckets, iPart + 1,
+      iPartCount);
+
+   for (hashNum = SymParallel_first(oSymTable->numBuckets, iPart,
+           iPartCount);
+        hashNum < uEnd; hashNum++)
+   {
+      for (psCurrentBinding = oSymTable->ppsBuckets[hashNum];
+           psCurrentBinding != NULL;
+           psCurrentBinding = psCurrentBinding->psNextBinding)
+      {
+         (*pfApply)(psCurrentBinding->pcKey,
+            psCurrentBinding->pvValue, pvExtra);
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Here every stripe stays locked for reading while the parts run, as
+   in SymTable_map, so pfApply must not call any function on
+   oSymTable. */
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymTable_lockAll(oSymTable, 0);
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+   SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymTable_lockAll(oSymTable, 0);
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+   SymTable_unlockAll(oSymTable);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
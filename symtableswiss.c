@@ -0,0 +1,791 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation specifically uses an open-addressing hash table
+whose slots come in groups of GROUP_SIZE, each slot with a control
+byte that holds 7 bits of its key's hash. A lookup compares the
+control bytes of a whole group at once, with one SSE2 instruction
+where the compiler targets it, and reads a key only when its 7 bits
+match, so a miss usually reads no key at all.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "symparallel.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*The number of slots whose control bytes a lookup compares at once.
+Groups are aligned, and the slot count is always a power of two and a
+multiple of GROUP_SIZE*/
+enum {GROUP_SIZE = 16};
+
+/*The number of slots allocated by SymTable_new, and the fewest that a
+table ever shrinks to*/
+enum {INITIAL_SLOT_COUNT = GROUP_SIZE};
+
+/*At most MAX_LOAD_NUM / MAX_LOAD_DEN of the slots may hold bindings or
+be DELETED, so that every probe sequence reaches an EMPTY slot*/
+enum {MAX_LOAD_NUM = 7, MAX_LOAD_DEN = 8};
+
+/*Once removals leave fewer than 1 / SHRINK_LOAD_DEN of its slots in
+use, the table shrinks to the fewest slots that are at most
+SHRINK_TARGET_NUM / SHRINK_TARGET_DEN in use*/
+enum {SHRINK_LOAD_DEN = 8};
+enum {SHRINK_TARGET_NUM = 2, SHRINK_TARGET_DEN = 5};
+
+/*The control byte of a slot that has never held a binding since the
+table was last resized, and of a slot whose binding was removed. The
+control byte of a slot that holds a binding is the low 7 bits of its
+hash, so the high bit alone tells a free slot from a full one*/
+enum {CTRL_EMPTY = 0x80, CTRL_DELETED = 0xFE};
+
+/*Set in the stored length of a key that the client lent with
+SymTable_putBorrowed, which the symbol table must not free*/
+static const size_t BORROWED_KEY = ~((size_t)-1 >> 1);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableSlot holds one binding, if its control byte says so. */
+struct SymTableSlot
+{
+   /*The full hash of the key, so that resizing need not hash it
+   again*/
+   size_t uHash;
+
+   /*The key, owned by the symbol table unless it is borrowed*/
+   const char *pcKey;
+
+   /*The length of the key, with BORROWED_KEY set if it is borrowed*/
+   size_t uLength;
+
+   /*The value*/
+   void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable keeps the control bytes apart from the slots, so that a
+group's bytes fill part of one cache line. The probe sequence of a
+key visits whole groups: first the group that the high bits of its
+hash select, then groups 1, 3, 6, ... further on, which visits every
+group of a power-of-two table. A lookup stops at the first group that
+has an EMPTY slot. */
+struct SymTable
+{
+   /*The number of slots, a power of two and a multiple of GROUP_SIZE*/
+   size_t numSlots;
+
+   /*The number of bindings within the symbol table*/
+   size_t bindingCount;
+
+   /*The number of EMPTY slots that may still be filled before the
+   table must be resized*/
+   size_t uGrowthLeft;
+
+   /*The function that hashes keys*/
+   size_t (*pfHash)(const char *pcKey, size_t uLength);
+
+   /*The control byte of each slot*/
+   unsigned char *pucCtrl;
+
+   /*The slots*/
+   struct SymTableSlot *psSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a mask with bit i set for each i below GROUP_SIZE such that
+   pucGroup[i] is ucByte. */
+static unsigned SymTable_matchByte(const unsigned char *pucGroup,
+   unsigned char ucByte)
+{
+#if defined(__SSE2__)
+   __m128i sGroup = _mm_loadu_si128((const __m128i*)pucGroup);
+   return (unsigned)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(sGroup, _mm_set1_epi8((char)ucByte)));
+#else
+   unsigned uMask = 0;
+   int i;
+
+   for (i = 0; i < GROUP_SIZE; i++)
+      if (pucGroup[i] == ucByte) uMask |= 1u << i;
+   return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a mask with bit i set for each i below GROUP_SIZE such that
+   pucGroup[i] is EMPTY or DELETED. */
+static unsigned SymTable_matchFree(const unsigned char *pucGroup)
+{
+#if defined(__SSE2__)
+   return (unsigned)_mm_movemask_epi8(
+      _mm_loadu_si128((const __m128i*)pucGroup));
+#else
+   unsigned uMask = 0;
+   int i;
+
+   for (i = 0; i < GROUP_SIZE; i++)
+      if ((pucGroup[i] & 0x80) != 0) uMask |= 1u << i;
+   return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the lowest set bit of uMask, which must not be
+   0. */
+static int SymTable_lowestBit(unsigned uMask)
+{
+#if defined(__GNUC__)
+   return __builtin_ctz(uMask);
+#else
+   int i = 0;
+
+   assert(uMask != 0);
+   while ((uMask & 1u) == 0) {
+      uMask >>= 1;
+      i++;
+   }
+   return i;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings plus DELETED slots that a table of
+   uSlotCount slots may hold. */
+static size_t SymTable_capacity(size_t uSlotCount)
+{
+   return uSlotCount / MAX_LOAD_DEN * MAX_LOAD_NUM;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of pcKey, which is uLength characters long, in
+   oSymTable. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return (*oSymTable->pfHash)(pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the control byte of a slot that holds a key whose hash is
+   uHash. */
+static unsigned char SymTable_tag(size_t uHash)
+{
+   return (unsigned char)(uHash & 0x7F);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first group of the probe sequence of a key whose hash is
+   uHash in oSymTable. The tag takes the low 7 bits of the hash, so
+   the group is chosen by the bits above them. */
+static size_t SymTable_firstGroup(SymTable_T oSymTable, size_t uHash)
+{
+   return (uHash >> 7) & (oSymTable->numSlots / GROUP_SIZE - 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the key of psSlot, which must hold a binding, unless it is
+   borrowed. */
+static void SymTable_freeKey(struct SymTableSlot *psSlot)
+{
+   assert(psSlot != NULL);
+
+   if ((psSlot->uLength & BORROWED_KEY) == 0)
+      free((char*)psSlot->pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the slot of oSymTable that holds the key pcKey, which is
+   uLength characters long and whose hash is uHash, or
+   oSymTable->numSlots if there is no such slot. */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+   size_t uLength, size_t uHash)
+{
+   size_t uGroupMask = oSymTable->numSlots / GROUP_SIZE - 1;
+   size_t uGroup = SymTable_firstGroup(oSymTable, uHash);
+   size_t uStep = 0;
+   unsigned char ucTag = SymTable_tag(uHash);
+   const unsigned char *pucGroup;
+   const struct SymTableSlot *psSlot;
+   unsigned uMatch;
+
+   for (;;) {
+      pucGroup = oSymTable->pucCtrl + uGroup * GROUP_SIZE;
+      for (uMatch = SymTable_matchByte(pucGroup, ucTag); uMatch != 0;
+           uMatch &= uMatch - 1) {
+         psSlot = &oSymTable->psSlots[uGroup * GROUP_SIZE
+            + (size_t)SymTable_lowestBit(uMatch)];
+         if (psSlot->uHash == uHash
+             && (psSlot->uLength & ~BORROWED_KEY) == uLength
+             && !memcmp(psSlot->pcKey, pcKey, uLength))
+            return (size_t)(psSlot - oSymTable->psSlots);
+      }
+      if (SymTable_matchByte(pucGroup, CTRL_EMPTY) != 0)
+         return oSymTable->numSlots;
+      uStep++;
+      uGroup = (uGroup + uStep) & uGroupMask;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first EMPTY or DELETED slot of oSymTable in the probe
+   sequence of a key whose hash is uHash. There must be one. */
+static size_t SymTable_findFree(SymTable_T oSymTable, size_t uHash)
+{
+   size_t uGroupMask = oSymTable->numSlots / GROUP_SIZE - 1;
+   size_t uGroup = SymTable_firstGroup(oSymTable, uHash);
+   size_t uStep = 0;
+   unsigned uFree;
+
+   for (;;) {
+      uFree = SymTable_matchFree(oSymTable->pucCtrl
+         + uGroup * GROUP_SIZE);
+      if (uFree != 0)
+         return uGroup * GROUP_SIZE + (size_t)SymTable_lowestBit(uFree);
+      uStep++;
+      uGroup = (uGroup + uStep) & uGroupMask;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSymTable into uNewCount new slots, a power of
+   two and a multiple of GROUP_SIZE with room for every binding, which
+   also clears every DELETED slot. Return 1 (TRUE) on success, or 0
+   (FALSE), leaving oSymTable unchanged, if insufficient memory is
+   available. */
+static int SymTable_resize(SymTable_T oSymTable, size_t uNewCount)
+{
+   unsigned char *pucOldCtrl = oSymTable->pucCtrl;
+   struct SymTableSlot *psOldSlots = oSymTable->psSlots;
+   size_t uOldCount = oSymTable->numSlots;
+   unsigned char *pucCtrl;
+   struct SymTableSlot *psSlots;
+   size_t uSlot;
+   size_t uNewSlot;
+
+   assert(oSymTable != NULL);
+   assert(SymTable_capacity(uNewCount) >= oSymTable->bindingCount);
+
+   pucCtrl = (unsigned char*)malloc(uNewCount);
+   psSlots = (struct SymTableSlot*)
+      malloc(uNewCount * sizeof(struct SymTableSlot));
+   if (pucCtrl == NULL || psSlots == NULL) {
+      free(pucCtrl);
+      free(psSlots);
+      return 0;
+   }
+   memset(pucCtrl, CTRL_EMPTY, uNewCount);
+
+   oSymTable->pucCtrl = pucCtrl;
+   oSymTable->psSlots = psSlots;
+   oSymTable->numSlots = uNewCount;
+   oSymTable->uGrowthLeft =
+      SymTable_capacity(uNewCount) - oSymTable->bindingCount;
+
+   for (uSlot = 0; uSlot < uOldCount; uSlot++) {
+      if ((pucOldCtrl[uSlot] & 0x80) != 0) continue;
+      uNewSlot = SymTable_findFree(oSymTable, psOldSlots[uSlot].uHash);
+      pucCtrl[uNewSlot] = pucOldCtrl[uSlot];
+      psSlots[uNewSlot] = psOldSlots[uSlot];
+   }
+
+   free(pucOldCtrl);
+   free(psOldSlots);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   return SymTable_newWithHash(SymHash_fast);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   SymTable_T oSymTable;
+
+   assert(pfHash != NULL);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   oSymTable->numSlots = 0;
+   oSymTable->bindingCount = 0;
+   oSymTable->pfHash = pfHash;
+   oSymTable->pucCtrl = NULL;
+   oSymTable->psSlots = NULL;
+   if (!SymTable_resize(oSymTable, INITIAL_SLOT_COUNT)) {
+      free(oSymTable);
+      return NULL;
+   }
+
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A key's slot is fixed by its hash and the slots filled before it,
+   so the table ignores iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if ((oSymTable->pucCtrl[uSlot] & 0x80) == 0)
+         SymTable_freeKey(&oSymTable->psSlots[uSlot]);
+   }
+
+   free(oSymTable->pucCtrl);
+   free(oSymTable->psSlots);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->bindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_findOrAdd is SymTable_findOrInsertN, except that if
+   iBorrow is 1 (TRUE), a binding that it adds borrows pcKey, which
+   must then be followed by '\0', instead of copying it. */
+static void **SymTable_findOrAdd(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int iBorrow, int *piInserted)
+{
+   size_t uHash;
+   size_t uSlot;
+   size_t uNewCount;
+   char *pcKeyCopy;
+   struct SymTableSlot *psSlot;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   uHash = SymTable_hash(oSymTable, pcKey, uLength);
+   uSlot = SymTable_find(oSymTable, pcKey, uLength, uHash);
+   if (uSlot != oSymTable->numSlots) {
+      *piInserted = 0;
+      return &oSymTable->psSlots[uSlot].pvValue;
+   }
+
+   /* Once no EMPTY slot may be filled, double the table, or rebuild it
+   at its size if DELETED slots make up most of its load. */
+   if (oSymTable->uGrowthLeft == 0) {
+      uNewCount = oSymTable->numSlots;
+      if (oSymTable->bindingCount * 2
+            >= SymTable_capacity(oSymTable->numSlots)) {
+         if (uNewCount > ((size_t)-1 / 2)
+               / sizeof(struct SymTableSlot))
+            return NULL;
+         uNewCount *= 2;
+      }
+      if (!SymTable_resize(oSymTable, uNewCount))
+         return NULL;
+   }
+
+   if (iBorrow)
+      pcKeyCopy = (char*)pcKey;
+   else {
+      pcKeyCopy = (char*)malloc(uLength + 1);
+      if (pcKeyCopy == NULL) return NULL;
+      memcpy(pcKeyCopy, pcKey, uLength);
+      pcKeyCopy[uLength] = '\0';
+   }
+
+   uSlot = SymTable_findFree(oSymTable, uHash);
+   if (oSymTable->pucCtrl[uSlot] == CTRL_EMPTY)
+      oSymTable->uGrowthLeft--;
+   oSymTable->pucCtrl[uSlot] = SymTable_tag(uHash);
+   psSlot = &oSymTable->psSlots[uSlot];
+   psSlot->uHash = uHash;
+   psSlot->pcKey = pcKeyCopy;
+   psSlot->uLength = iBorrow ? uLength | BORROWED_KEY : uLength;
+   psSlot->pvValue = NULL;
+   oSymTable->bindingCount++;
+
+   *piInserted = 1;
+   return &psSlot->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   return SymTable_findOrAdd(oSymTable, pcKey, uLength, 0, piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), 1,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   size_t uSlot;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->psSlots[uSlot].pvValue;
+   oSymTable->psSlots[uSlot].pvValue = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   size_t uSlot;
+   size_t uNewCount;
+   const unsigned char *pucGroup;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+
+   oldVal = oSymTable->psSlots[uSlot].pvValue;
+   SymTable_freeKey(&oSymTable->psSlots[uSlot]);
+
+   /* A group that has an EMPTY slot has never been full since the
+   last resize, so no probe sequence has passed through it, and the
+   slot can be EMPTY again. Otherwise some later key may lie beyond
+   it, and lookups must be told to keep probing. */
+   pucGroup = oSymTable->pucCtrl + uSlot / GROUP_SIZE * GROUP_SIZE;
+   if (SymTable_matchByte(pucGroup, CTRL_EMPTY) != 0) {
+      oSymTable->pucCtrl[uSlot] = CTRL_EMPTY;
+      oSymTable->uGrowthLeft++;
+   }
+   else
+      oSymTable->pucCtrl[uSlot] = CTRL_DELETED;
+
+   oSymTable->bindingCount--;
+
+   if (oSymTable->numSlots > INITIAL_SLOT_COUNT
+       && oSymTable->bindingCount * SHRINK_LOAD_DEN
+            < oSymTable->numSlots) {
+      uNewCount = INITIAL_SLOT_COUNT;
+      while (oSymTable->bindingCount * SHRINK_TARGET_DEN
+               > uNewCount * SHRINK_TARGET_NUM)
+         uNewCount *= 2;
+      (void)SymTable_resize(oSymTable, uNewCount);
+   }
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uSlot = SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength));
+   if (uSlot == oSymTable->numSlots) return NULL;
+   return oSymTable->psSlots[uSlot].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, uLength,
+      SymTable_hash(oSymTable, pcKey, uLength))
+      != oSymTable->numSlots;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the first binding in a slot at or after uSlot, or
+   finish psIter if there is none. */
+static void SymTable_iterFrom(SymTable_Iter *psIter, size_t uSlot)
+{
+   SymTable_T oSymTable;
+
+   assert(psIter != NULL);
+
+   oSymTable = psIter->oSymTable;
+   for (; uSlot < oSymTable->numSlots; uSlot++) {
+      if ((oSymTable->pucCtrl[uSlot] & 0x80) == 0) {
+         psIter->uIndex = uSlot;
+         psIter->pcKey = oSymTable->psSlots[uSlot].pcKey;
+         psIter->pvValue = oSymTable->psSlots[uSlot].pvValue;
+         return;
+      }
+   }
+   psIter->uIndex = oSymTable->numSlots;
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvPosition = NULL;
+   SymTable_iterFrom(psIter, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pcKey != NULL);
+
+   SymTable_iterFrom(psIter, psIter->uIndex + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration of the slots holds nothing that must be released. */
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   size_t uSlot;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (uSlot = 0; uSlot < oSymTable->numSlots; uSlot++) {
+      if ((oSymTable->pucCtrl[uSlot] & 0x80) == 0)
+         (*pfApply)(oSymTable->psSlots[uSlot].pcKey,
+            oSymTable->psSlots[uSlot].pvValue, (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTable, which is a run of
+   consecutive slots. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   SymTable_T oSymTable = (SymTable_T)pvTable;
+   size_t uSlot;
+   size_t uEnd;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uEnd = SymParallel_first(oSymTable->numSlots, iPart + 1,
+      iPartCount);
+
+   for (uSlot = SymParallel_first(oSymTable->numSlots, iPart,
+           iPartCount);
+        uSlot < uEnd; uSlot++)
+   {
+      if ((oSymTable->pucCtrl[uSlot] & 0x80) == 0)
+         (*pfApply)(oSymTable->psSlots[uSlot].pcKey,
+            oSymTable->psSlots[uSlot].pvValue, pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_map(oSymTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymParallel_mapEach(oSymTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iThreadCount);
+
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
@@ -0,0 +1,1019 @@
+/*A symbol table is an unordered collection of bindings.
+A binding consists of a key and a value. A key is a string that uniquely
+identifies its binding; a value is data that is somehow pertinent to
+its key. A symbol table, with these declarations allows the client
+to insert (put) new bindings, to retrieve (get) the values of bindings
+with specified keys, perform functions on all of the bindings (map)
+handle (free) memory, and to remove bindings with specified keys.
+This implementation specifically uses a compressed trie (a radix
+tree). Each node holds the run of characters that leads to it from its
+parent, so characters that many keys share are stored once, and a
+lookup compares each character of its key once and never hashes it.
+No key is stored whole: SymTable_map, SymTable_mapParallel,
+SymTable_mapReduce and iterations rebuild each key that they pass to
+the client in a buffer. Unlike the other implementations of
+symtable.h, this one therefore hands out keys that are valid only
+until the call of pfApply that receives them returns, or for an
+iteration, until the next SymTable_iterNext or SymTable_iterEnd; a
+client that needs a key afterwards must copy it. For the same reason,
+SymTable_putBorrowed copies its key like SymTable_put.*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symparallel.h"
+
+/*The number of children that a node first has room for*/
+enum {INITIAL_CHILD_CAPACITY = 2};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableNode is a node of the trie, which a key reaches if it
+begins with the labels of the nodes on the path to it. A node other
+than the root either holds a binding or has children, and every child
+of a node begins with a different character. */
+struct SymTableNode
+{
+   /*The parent, or NULL for the root*/
+   struct SymTableNode *psParent;
+
+   /*The children, in increasing order of their first character,
+   followed in the same block of memory by the first character of each
+   (see SymTable_firstChars), so that finding a child reads none of the
+   others*/
+   struct SymTableNode **ppsChildren;
+
+   /*The value, if the node holds a binding*/
+   void *pvValue;
+
+   /*The number of bindings in the subtree of the node, itself
+   included*/
+   size_t uBindingCount;
+
+   /*The number of characters in acLabel*/
+   size_t uLabelLength;
+
+   /*The number of children, and how many there is room for*/
+   unsigned short uChildCount;
+   unsigned short uChildCapacity;
+
+   /*1 (TRUE) if the node holds a binding, whose key is the labels
+   on the path to the node*/
+   unsigned char ucHasValue;
+
+   /*The characters that lead to the node from its parent. They are
+   never empty, except at the root*/
+   char acLabel[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is the root of its trie, and a buffer that any key of the
+trie fits in. */
+struct SymTable
+{
+   /*The root, which is reached by the empty key*/
+   struct SymTableNode *psRoot;
+
+   /*The length of the longest key ever added*/
+   size_t uMaxLength;
+
+   /*uMaxLength + 1 characters, for rebuilding a key when no other
+   buffer can be allocated*/
+   char *pcKeyBuffer;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new node with no children and no binding, whose label is
+   the uLabelLength characters at pcLabel, or NULL if insufficient
+   memory is available. */
+static struct SymTableNode *SymTable_newNode(const char *pcLabel,
+   size_t uLabelLength)
+{
+   struct SymTableNode *psNode;
+
+   psNode = (struct SymTableNode*)
+      malloc(sizeof(struct SymTableNode) + uLabelLength);
+   if (psNode == NULL) return NULL;
+
+   psNode->psParent = NULL;
+   psNode->ppsChildren = NULL;
+   psNode->pvValue = NULL;
+   psNode->uBindingCount = 0;
+   psNode->uLabelLength = uLabelLength;
+   psNode->uChildCount = 0;
+   psNode->uChildCapacity = 0;
+   psNode->ucHasValue = 0;
+   memcpy(psNode->acLabel, pcLabel, uLabelLength);
+   return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free psNode, but not its children. */
+static void SymTable_freeNode(struct SymTableNode *psNode)
+{
+   assert(psNode != NULL);
+
+   free(psNode->ppsChildren);
+   free(psNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first character of each child of psNode. */
+static unsigned char *SymTable_firstChars(
+   const struct SymTableNode *psNode)
+{
+   assert(psNode != NULL);
+
+   return (unsigned char*)(psNode->ppsChildren
+      + psNode->uChildCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make room in psNode for another child. Return 1 (TRUE) on success,
+   or 0 (FALSE), leaving psNode unchanged, if insufficient memory is
+   available. */
+static int SymTable_reserveChild(struct SymTableNode *psNode)
+{
+   struct SymTableNode **ppsChildren;
+   size_t uCapacity;
+
+   assert(psNode != NULL);
+
+   if (psNode->uChildCount < psNode->uChildCapacity) return 1;
+
+   /* A node has at most one child per character. */
+   uCapacity = psNode->uChildCapacity == 0 ? INITIAL_CHILD_CAPACITY
+      : (size_t)psNode->uChildCapacity * 2;
+   if (uCapacity > 256) uCapacity = 256;
+
+   ppsChildren = (struct SymTableNode**)malloc(uCapacity
+      * (sizeof(struct SymTableNode*) + sizeof(unsigned char)));
+   if (ppsChildren == NULL) return 0;
+
+   if (psNode->uChildCount > 0) {
+      memcpy(ppsChildren, psNode->ppsChildren,
+         psNode->uChildCount * sizeof(struct SymTableNode*));
+      memcpy(ppsChildren + uCapacity, SymTable_firstChars(psNode),
+         psNode->uChildCount);
+   }
+   free(psNode->ppsChildren);
+   psNode->ppsChildren = ppsChildren;
+   psNode->uChildCapacity = (unsigned short)uCapacity;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the child of psNode that begins with ucFirst, or
+   psNode->uChildCount if there is none. */
+static size_t SymTable_childIndex(const struct SymTableNode *psNode,
+   unsigned char ucFirst)
+{
+   const unsigned char *pucFound;
+
+   assert(psNode != NULL);
+
+   if (psNode->uChildCount == 0) return 0;
+   pucFound = (const unsigned char*)memchr(
+      SymTable_firstChars(psNode), ucFirst, psNode->uChildCount);
+   if (pucFound == NULL) return psNode->uChildCount;
+   return (size_t)(pucFound - SymTable_firstChars(psNode));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add psChild as a child of psNode, which must have room for it and no
+   child that begins with the same character. */
+static void SymTable_addChild(struct SymTableNode *psNode,
+   struct SymTableNode *psChild)
+{
+   unsigned char *pucFirst;
+   unsigned char ucFirst;
+   size_t uIndex;
+
+   assert(psNode != NULL);
+   assert(psChild != NULL);
+   assert(psChild->uLabelLength > 0);
+   assert(psNode->uChildCount < psNode->uChildCapacity);
+
+   pucFirst = SymTable_firstChars(psNode);
+   ucFirst = (unsigned char)psChild->acLabel[0];
+   for (uIndex = psNode->uChildCount;
+        uIndex > 0 && pucFirst[uIndex - 1] > ucFirst; uIndex--)
+   {
+      psNode->ppsChildren[uIndex] = psNode->ppsChildren[uIndex - 1];
+      pucFirst[uIndex] = pucFirst[uIndex - 1];
+   }
+   psNode->ppsChildren[uIndex] = psChild;
+   pucFirst[uIndex] = ucFirst;
+   psNode->uChildCount++;
+   psChild->psParent = psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove child uIndex of psNode, freeing the children of psNode once
+   it has none. */
+static void SymTable_removeChild(struct SymTableNode *psNode,
+   size_t uIndex)
+{
+   assert(psNode != NULL);
+   assert(uIndex < psNode->uChildCount);
+
+   psNode->uChildCount--;
+   memmove(&psNode->ppsChildren[uIndex],
+      &psNode->ppsChildren[uIndex + 1],
+      (psNode->uChildCount - uIndex) * sizeof(struct SymTableNode*));
+   memmove(SymTable_firstChars(psNode) + uIndex,
+      SymTable_firstChars(psNode) + uIndex + 1,
+      psNode->uChildCount - uIndex);
+   if (psNode->uChildCount == 0) {
+      free(psNode->ppsChildren);
+      psNode->ppsChildren = NULL;
+      psNode->uChildCapacity = 0;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add iDelta to the binding count of psNode and of every node above
+   it. */
+static void SymTable_countBindings(struct SymTableNode *psNode,
+   int iDelta)
+{
+   for (; psNode != NULL; psNode = psNode->psParent)
+      psNode->uBindingCount += (size_t)iDelta;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oSymTable that holds the binding whose key is
+   pcKey, which is uLength characters long, or NULL if there is
+   none. */
+static struct SymTableNode *SymTable_find(SymTable_T oSymTable,
+   const char *pcKey, size_t uLength)
+{
+   struct SymTableNode *psNode;
+   struct SymTableNode *psChild;
+   size_t uPosition = 0;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psNode = oSymTable->psRoot;
+   while (uPosition < uLength) {
+      uIndex = SymTable_childIndex(psNode,
+         (unsigned char)pcKey[uPosition]);
+      if (uIndex == psNode->uChildCount) return NULL;
+      psChild = psNode->ppsChildren[uIndex];
+      if (psChild->uLabelLength > uLength - uPosition
+          || memcmp(psChild->acLabel, pcKey + uPosition,
+                psChild->uLabelLength) != 0)
+         return NULL;
+      uPosition += psChild->uLabelLength;
+      psNode = psChild;
+   }
+   return psNode->ucHasValue ? psNode : NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the key of the binding of psNode, and a '\0', to pcBuffer.
+   The labels are met from the last to the first, so the length of the
+   key is found first. */
+static void SymTable_buildKey(const struct SymTableNode *psNode,
+   char *pcBuffer)
+{
+   const struct SymTableNode *psAbove;
+   size_t uLength = 0;
+
+   assert(psNode != NULL);
+   assert(pcBuffer != NULL);
+
+   for (psAbove = psNode; psAbove != NULL; psAbove = psAbove->psParent)
+      uLength += psAbove->uLabelLength;
+
+   pcBuffer[uLength] = '\0';
+   for (; psNode != NULL; psNode = psNode->psParent) {
+      uLength -= psNode->uLabelLength;
+      memcpy(pcBuffer + uLength, psNode->acLabel, psNode->uLabelLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first node in the subtree of psNode, itself included,
+   that holds a binding. There must be one. */
+static struct SymTableNode *SymTable_firstBinding(
+   struct SymTableNode *psNode)
+{
+   assert(psNode != NULL);
+   assert(psNode->uBindingCount > 0);
+
+   while (!psNode->ucHasValue)
+      psNode = psNode->ppsChildren[0];
+   return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node that holds the binding after that of psNode, or
+   NULL if there is none. A node's binding comes before the bindings of
+   its children, and the children come in order of their first
+   character. */
+static struct SymTableNode *SymTable_nextBinding(
+   struct SymTableNode *psNode)
+{
+   struct SymTableNode *psParent;
+   size_t uIndex;
+
+   assert(psNode != NULL);
+
+   if (psNode->uChildCount > 0)
+      return SymTable_firstBinding(psNode->ppsChildren[0]);
+
+   for (psParent = psNode->psParent; psParent != NULL;
+        psNode = psParent, psParent = psNode->psParent)
+   {
+      uIndex = SymTable_childIndex(psParent,
+         (unsigned char)psNode->acLabel[0]);
+      if (uIndex + 1 < psParent->uChildCount)
+         return SymTable_firstBinding(
+            psParent->ppsChildren[uIndex + 1]);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node that holds binding uOrdinal of oSymTable, counting
+   from 0 in the order of SymTable_nextBinding. There must be one. */
+static struct SymTableNode *SymTable_bindingAt(SymTable_T oSymTable,
+   size_t uOrdinal)
+{
+   struct SymTableNode *psNode;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(uOrdinal < oSymTable->psRoot->uBindingCount);
+
+   psNode = oSymTable->psRoot;
+   for (;;) {
+      if (psNode->ucHasValue) {
+         if (uOrdinal == 0) return psNode;
+         uOrdinal--;
+      }
+      for (uIndex = 0;
+           uOrdinal >= psNode->ppsChildren[uIndex]->uBindingCount;
+           uIndex++)
+         uOrdinal -= psNode->ppsChildren[uIndex]->uBindingCount;
+      psNode = psNode->ppsChildren[uIndex];
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a buffer that any key of oSymTable fits in: a new one if
+   possible, which the caller must free, and otherwise the buffer of
+   oSymTable. */
+static char *SymTable_newKeyBuffer(SymTable_T oSymTable)
+{
+   char *pcBuffer;
+
+   assert(oSymTable != NULL);
+
+   pcBuffer = (char*)malloc(oSymTable->uMaxLength + 1);
+   return pcBuffer != NULL ? pcBuffer : oSymTable->pcKeyBuffer;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pcBuffer, which SymTable_newKeyBuffer returned for
+   oSymTable. */
+static void SymTable_freeKeyBuffer(SymTable_T oSymTable, char *pcBuffer)
+{
+   assert(oSymTable != NULL);
+
+   if (pcBuffer != oSymTable->pcKeyBuffer)
+      free(pcBuffer);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   SymTable_T oSymTable;
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL) return NULL;
+
+   oSymTable->psRoot = SymTable_newNode("", 0);
+   oSymTable->uMaxLength = 0;
+   oSymTable->pcKeyBuffer = (char*)malloc(1);
+   if (oSymTable->psRoot == NULL || oSymTable->pcKeyBuffer == NULL) {
+      free(oSymTable->psRoot);
+      free(oSymTable->pcKeyBuffer);
+      free(oSymTable);
+      return NULL;
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The trie compares characters and never hashes keys, so it ignores
+   pfHash. */
+SymTable_T SymTable_newWithHash(
+     size_t (*pfHash)(const char *pcKey, size_t uLength))
+{
+   assert(pfHash != NULL);
+   (void)pfHash;
+
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A key's node is fixed by its characters, so the table ignores
+   iPolicy. */
+void SymTable_setReorder(SymTable_T oSymTable, int iPolicy)
+{
+   assert(oSymTable != NULL);
+   assert(iPolicy == SYMTABLE_REORDER_NONE
+      || iPolicy == SYMTABLE_REORDER_MOVE_TO_FRONT
+      || iPolicy == SYMTABLE_REORDER_TRANSPOSE);
+   (void)oSymTable;
+   (void)iPolicy;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   struct SymTableNode *psNode;
+   struct SymTableNode *psParent;
+
+   assert(oSymTable != NULL);
+
+   /* Free the nodes from the bottom up, each once its last child is
+   gone, so that a deep trie needs no stack. */
+   psNode = oSymTable->psRoot;
+   while (psNode != NULL) {
+      if (psNode->uChildCount > 0) {
+         psNode = psNode->ppsChildren[psNode->uChildCount - 1];
+         continue;
+      }
+      psParent = psNode->psParent;
+      SymTable_freeNode(psNode);
+      if (psParent != NULL) psParent->uChildCount--;
+      psNode = psParent;
+   }
+
+   free(oSymTable->pcKeyBuffer);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->psRoot->uBindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsertN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, int *piInserted)
+{
+   struct SymTableNode *psNode;
+   struct SymTableNode *psChild = NULL;
+   struct SymTableNode *psMiddle;
+   struct SymTableNode *psLeaf = NULL;
+   char *pcKeyBuffer;
+   size_t uPosition = 0;
+   size_t uCommon = 0;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piInserted != NULL);
+
+   /* Follow the key as far as the trie has it. */
+   psNode = oSymTable->psRoot;
+   while (uPosition < uLength) {
+      uIndex = SymTable_childIndex(psNode,
+         (unsigned char)pcKey[uPosition]);
+      if (uIndex == psNode->uChildCount) break;
+      psChild = psNode->ppsChildren[uIndex];
+      for (uCommon = 1; uCommon < psChild->uLabelLength
+              && uCommon < uLength - uPosition
+              && psChild->acLabel[uCommon]
+                 == pcKey[uPosition + uCommon];
+           uCommon++)
+         ;
+      if (uCommon < psChild->uLabelLength) break;
+      uPosition += uCommon;
+      psNode = psChild;
+      psChild = NULL;
+   }
+
+   if (uPosition == uLength && psNode->ucHasValue) {
+      *piInserted = 0;
+      return &psNode->pvValue;
+   }
+
+   if (uLength > oSymTable->uMaxLength) {
+      pcKeyBuffer = (char*)realloc(oSymTable->pcKeyBuffer, uLength + 1);
+      if (pcKeyBuffer == NULL) return NULL;
+      oSymTable->pcKeyBuffer = pcKeyBuffer;
+      oSymTable->uMaxLength = uLength;
+   }
+
+   if (uPosition == uLength) {
+      /* The key ends at a node that has children. */
+      psLeaf = psNode;
+   }
+   else if (psChild == NULL) {
+      /* No child begins with the rest of the key. */
+      if (!SymTable_reserveChild(psNode)) return NULL;
+      psLeaf = SymTable_newNode(pcKey + uPosition,
+         uLength - uPosition);
+      if (psLeaf == NULL) return NULL;
+      SymTable_addChild(psNode, psLeaf);
+   }
+   else {
+      /* The key leaves the label of psChild after uCommon characters,
+      so a new node takes over those characters, with psChild and the
+      rest of the key, if any, below it. */
+      psMiddle = SymTable_newNode(psChild->acLabel, uCommon);
+      if (psMiddle == NULL) return NULL;
+      if (!SymTable_reserveChild(psMiddle)) {
+         SymTable_freeNode(psMiddle);
+         return NULL;
+      }
+      if (uPosition + uCommon < uLength) {
+         psLeaf = SymTable_newNode(pcKey + uPosition + uCommon,
+            uLength - uPosition - uCommon);
+         if (psLeaf == NULL) {
+            SymTable_freeNode(psMiddle);
+            return NULL;
+         }
+      }
+
+      psNode->ppsChildren[SymTable_childIndex(psNode,
+         (unsigned char)psChild->acLabel[0])] = psMiddle;
+      psMiddle->psParent = psNode;
+      psMiddle->uBindingCount = psChild->uBindingCount;
+      psChild->uLabelLength -= uCommon;
+      memmove(psChild->acLabel, psChild->acLabel + uCommon,
+         psChild->uLabelLength);
+      SymTable_addChild(psMiddle, psChild);
+      if (psLeaf != NULL)
+         SymTable_addChild(psMiddle, psLeaf);
+      else
+         psLeaf = psMiddle;
+   }
+
+   psLeaf->ucHasValue = 1;
+   psLeaf->pvValue = NULL;
+   SymTable_countBindings(psLeaf, 1);
+
+   *piInserted = 1;
+   return &psLeaf->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_findOrInsert(SymTable_T oSymTable,
+     const char *pcKey, int *piInserted)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_findOrInsertN(oSymTable, pcKey, strlen(pcKey),
+      piInserted);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable,
+     const char *pcKey, size_t uLength, const void *pvValue)
+{
+   void **ppvValue;
+   int iInserted;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_findOrInsertN(oSymTable, pcKey, uLength,
+      &iInserted);
+   if (ppvValue == NULL || !iInserted) return 0;
+
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The trie keeps no whole keys, so it ignores borrowing: the
+   characters of a borrowed key are copied into labels like those of
+   any other key, and the client's pcKey is not used after the call
+   returns. */
+int SymTable_putBorrowed(SymTable_T oSymTable,
+     const char *pcKey, const void *pvValue)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue)
+{
+   struct SymTableNode *psNode;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psNode = SymTable_find(oSymTable, pcKey, uLength);
+   if (psNode == NULL) return NULL;
+
+   oldVal = psNode->pvValue;
+   psNode->pvValue = (void*)pvValue;
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge psNode, which holds no binding and has one child, into that
+   child, which then hangs from the parent of psNode with the labels of
+   both. psNode must not be the root. If insufficient memory is
+   available, leave psNode as it is, which only costs a lookup that
+   passes it one more step. */
+static void SymTable_mergeWithChild(struct SymTableNode *psNode)
+{
+   struct SymTableNode *psChild;
+   struct SymTableNode *psParent;
+   size_t uIndex;
+
+   assert(psNode != NULL);
+   assert(psNode->psParent != NULL);
+   assert(!psNode->ucHasValue);
+   assert(psNode->uChildCount == 1);
+
+   psChild = (struct SymTableNode*)realloc(psNode->ppsChildren[0],
+      sizeof(struct SymTableNode) + psNode->uLabelLength
+      + psNode->ppsChildren[0]->uLabelLength);
+   if (psChild == NULL) return;
+
+   memmove(psChild->acLabel + psNode->uLabelLength, psChild->acLabel,
+      psChild->uLabelLength);
+   memcpy(psChild->acLabel, psNode->acLabel, psNode->uLabelLength);
+   psChild->uLabelLength += psNode->uLabelLength;
+
+   /* The child may have moved, so its own children must be told. */
+   for (uIndex = 0; uIndex < psChild->uChildCount; uIndex++)
+      psChild->ppsChildren[uIndex]->psParent = psChild;
+
+   psParent = psNode->psParent;
+   psParent->ppsChildren[SymTable_childIndex(psParent,
+      (unsigned char)psNode->acLabel[0])] = psChild;
+   psChild->psParent = psParent;
+   SymTable_freeNode(psNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableNode *psNode;
+   struct SymTableNode *psParent;
+   void *oldVal;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psNode = SymTable_find(oSymTable, pcKey, uLength);
+   if (psNode == NULL) return NULL;
+
+   oldVal = psNode->pvValue;
+   psNode->ucHasValue = 0;
+   psNode->pvValue = NULL;
+   SymTable_countBindings(psNode, -1);
+
+   /* Remove the nodes that no longer lead to a binding, and then merge
+   the lowest node left into its child if it has only one. */
+   while (psNode != oSymTable->psRoot && psNode->uBindingCount == 0) {
+      psParent = psNode->psParent;
+      SymTable_removeChild(psParent, SymTable_childIndex(psParent,
+         (unsigned char)psNode->acLabel[0]));
+      SymTable_freeNode(psNode);
+      psNode = psParent;
+   }
+   if (psNode != oSymTable->psRoot && !psNode->ucHasValue
+       && psNode->uChildCount == 1)
+      SymTable_mergeWithChild(psNode);
+
+   return oldVal;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   struct SymTableNode *psNode;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psNode = SymTable_find(oSymTable, pcKey, uLength);
+   return psNode != NULL ? psNode->pvValue : NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, uLength) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point psIter at the binding of psNode, rebuilding its key in the
+   buffer of psIter, or finish psIter if psNode is NULL. */
+static void SymTable_iterAt(SymTable_Iter *psIter,
+   struct SymTableNode *psNode)
+{
+   assert(psIter != NULL);
+
+   psIter->pvPosition = psNode;
+   if (psNode == NULL) {
+      SymTable_iterEnd(psIter);
+      return;
+   }
+   SymTable_buildKey(psNode, (char*)psIter->pvContainer);
+   psIter->pcKey = (const char*)psIter->pvContainer;
+   psIter->pvValue = psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iteration rebuilds each key in a buffer of its own, so that
+   iterations of one table do not disturb each other, unless that
+   buffer cannot be allocated. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvContainer = NULL;
+   if (oSymTable->psRoot->uBindingCount == 0) {
+      SymTable_iterAt(psIter, NULL);
+      return;
+   }
+   psIter->pvContainer = SymTable_newKeyBuffer(oSymTable);
+   SymTable_iterAt(psIter, SymTable_firstBinding(oSymTable->psRoot));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterNext(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+   assert(psIter->pcKey != NULL);
+
+   SymTable_iterAt(psIter, SymTable_nextBinding(
+      (struct SymTableNode*)psIter->pvPosition));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter)
+{
+   assert(psIter != NULL);
+
+   if (psIter->pvContainer != NULL) {
+      SymTable_freeKeyBuffer(psIter->oSymTable,
+         (char*)psIter->pvContainer);
+      psIter->pvContainer = NULL;
+   }
+   psIter->pcKey = NULL;
+   psIter->pvValue = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra)
+{
+   struct SymTableNode *psNode;
+   char *pcBuffer;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   if (oSymTable->psRoot->uBindingCount == 0) return;
+
+   pcBuffer = SymTable_newKeyBuffer(oSymTable);
+   for (psNode = SymTable_firstBinding(oSymTable->psRoot);
+        psNode != NULL; psNode = SymTable_nextBinding(psNode)) {
+      SymTable_buildKey(psNode, pcBuffer);
+      (*pfApply)(pcBuffer, psNode->pvValue, (void*)pvExtra);
+   }
+   SymTable_freeKeyBuffer(oSymTable, pcBuffer);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableMapTable is a table being mapped in parallel, with a key
+buffer for each part. */
+struct SymTableMapTable
+{
+   /*The table being mapped*/
+   SymTable_T oSymTable;
+
+   /*A key buffer for each part, of oSymTable->uMaxLength + 1
+   characters each*/
+   char *pcBuffers;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, passing pvExtra, to the bindings of part iPart of the
+   iPartCount parts of pvTable, a SymTableMapTable, which is a run of
+   consecutive bindings in the order of SymTable_nextBinding. */
+static void SymTable_mapPart(void *pvTable, int iPart, int iPartCount,
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+   void *pvExtra)
+{
+   struct SymTableMapTable *psTable = (struct SymTableMapTable*)pvTable;
+   SymTable_T oSymTable;
+   struct SymTableNode *psNode;
+   char *pcBuffer;
+   size_t uFirst;
+   size_t uEnd;
+
+   assert(psTable != NULL);
+   assert(pfApply != NULL);
+
+   oSymTable = psTable->oSymTable;
+   pcBuffer = psTable->pcBuffers
+      + (size_t)iPart * (oSymTable->uMaxLength + 1);
+   uFirst = SymParallel_first(oSymTable->psRoot->uBindingCount, iPart,
+      iPartCount);
+   uEnd = SymParallel_first(oSymTable->psRoot->uBindingCount,
+      iPart + 1, iPartCount);
+   if (uFirst == uEnd) return;
+
+   psNode = SymTable_bindingAt(oSymTable, uFirst);
+   for (; uFirst < uEnd;
+        uFirst++, psNode = SymTable_nextBinding(psNode))
+   {
+      SymTable_buildKey(psNode, pcBuffer);
+      (*pfApply)(pcBuffer, psNode->pvValue, pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set *psTable to oSymTable with a key buffer for each of the
+   *piPartCount parts. If insufficient memory is available for them,
+   use the buffer of the table and set *piPartCount to 1 instead. */
+static void SymTable_startMap(struct SymTableMapTable *psTable,
+   SymTable_T oSymTable, int *piPartCount)
+{
+   assert(psTable != NULL);
+   assert(oSymTable != NULL);
+   assert(piPartCount != NULL);
+
+   psTable->oSymTable = oSymTable;
+   psTable->pcBuffers = (char*)malloc((size_t)*piPartCount
+      * (oSymTable->uMaxLength + 1));
+   if (psTable->pcBuffers == NULL) {
+      psTable->pcBuffers = oSymTable->pcKeyBuffer;
+      *piPartCount = 1;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the key buffers that SymTable_startMap allocated for
+   *psTable. */
+static void SymTable_endMap(struct SymTableMapTable *psTable)
+{
+   assert(psTable != NULL);
+
+   if (psTable->pcBuffers != psTable->oSymTable->pcKeyBuffer)
+      free(psTable->pcBuffers);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra, int iThreadCount)
+{
+   struct SymTableMapTable sTable;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(iThreadCount > 0);
+
+   SymTable_startMap(&sTable, oSymTable, &iThreadCount);
+   SymParallel_map(&sTable, SymTable_mapPart, pfApply, pvExtra,
+      iThreadCount);
+   SymTable_endMap(&sTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapReduce(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue,
+          void *pvAccumulator),
+     void (*pfMerge)(void *pvAccumulator, void *pvOther),
+     void *const apvAccumulators[], int iThreadCount)
+{
+   struct SymTableMapTable sTable;
+   int iPartCount = iThreadCount;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(pfMerge != NULL);
+   assert(apvAccumulators != NULL);
+   assert(iThreadCount > 0);
+
+   SymTable_startMap(&sTable, oSymTable, &iPartCount);
+   SymParallel_mapEach(&sTable, SymTable_mapPart, pfApply,
+      apvAccumulators, iPartCount);
+   SymTable_endMap(&sTable);
+
+   /* A map that ran as one part left the other accumulators as they
+   were, as for an empty table. */
+   SymParallel_merge(pfMerge, apvAccumulators, iThreadCount);
+}
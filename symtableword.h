@@ -0,0 +1,25 @@
+/*A SymTableWord is the table that both SymTableInt and SymTablePtr
+(see symtableint.h and symtableptr.h) are built on: the table that
+SYMTABLE_DEFINE (see symtabledefine.h) generates for uintptr_t keys
+and void pointer values, with each key hashed by SymHash_word. The
+probing, resizing and removal of all three therefore come from the
+one definition in symtabledefine.h. Only symtableint.c and
+symtableptr.c may include this header.*/
+
+#include <stdint.h>
+#include "symtabledefine.h"
+#include "symhash.h"
+
+#ifndef SYMTABLEWORD_INCLUDED
+#define SYMTABLEWORD_INCLUDED
+
+/*SYMTABLEWORD_HASH(uKey) is the hash code of the key uKey, and
+SYMTABLEWORD_EQUAL(uKey1, uKey2) is nonzero if uKey1 and uKey2 are the
+same key*/
+#define SYMTABLEWORD_HASH(uKey) SymHash_word((unsigned long long)(uKey))
+#define SYMTABLEWORD_EQUAL(uKey1, uKey2) ((uKey1) == (uKey2))
+
+SYMTABLE_DEFINE(SymTableWord, uintptr_t, void *, SYMTABLEWORD_HASH,
+   SYMTABLEWORD_EQUAL)
+
+#endif
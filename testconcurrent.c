@@ -0,0 +1,1014 @@
+/*--------------------------------------------------------------------*/
+/* testconcurrent.c                                                   */
+/*--------------------------------------------------------------------*/
+
+/* Request POSIX declarations, for threads and clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* The longest key that the tests write, including the '\0'. */
+enum {MAX_KEY_LENGTH = 24};
+
+/* The most threads that any test starts. */
+enum {MAX_THREAD_COUNT = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the next pseudo-random number of the sequence whose state
+   *puState holds. Each thread keeps its own state, since rand is not
+   thread-safe. */
+
+static unsigned long nextRandom(unsigned long *puState)
+{
+   assert(puState != NULL);
+
+   *puState = (*puState * 1103515245UL + 12345UL) & 0x7fffffffUL;
+   return *puState;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding whose key is pcKey and whose value is pvValue by
+   incrementing the size_t that pvExtra points to. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Worker describes the share of a test that one thread performs. */
+
+struct History;
+
+struct Worker
+{
+   /* The table that every thread of the test uses. */
+   SymTable_T oSymTable;
+
+   /* The index of this thread among those of the test. */
+   int iThread;
+
+   /* The number of keys, or of operations, per thread. */
+   int iCount;
+
+   /* The distinct values that keys are bound to; key i is bound to
+      &pcValues[i]. */
+   char *pcValues;
+
+   /* Guards oSymTable in the global mutex benchmark, or NULL. */
+   pthread_mutex_t *psMutex;
+
+   /* The history of the linearizability test, or NULL. */
+   struct History *psHistory;
+
+   /* A result that the thread reports to the test. */
+   long lResult;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Set up asWorkers[0..iThreadCount-1] for threads that use oSymTable,
+   each with iCount keys or operations and values pcValues. */
+
+static void initWorkers(struct Worker asWorkers[], int iThreadCount,
+   SymTable_T oSymTable, int iCount, char *pcValues)
+{
+   int iThread;
+
+   assert(iThreadCount <= MAX_THREAD_COUNT);
+
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+   {
+      asWorkers[iThread].oSymTable = oSymTable;
+      asWorkers[iThread].iThread = iThread;
+      asWorkers[iThread].iCount = iCount;
+      asWorkers[iThread].pcValues = pcValues;
+      asWorkers[iThread].psMutex = NULL;
+      asWorkers[iThread].psHistory = NULL;
+      asWorkers[iThread].lResult = 0;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run (*pfWork)(&asWorkers[i]) in a separate thread for each i below
+   iThreadCount, and wait for every thread to finish. Exit with
+   EXIT_FAILURE if a thread cannot be started. */
+
+static void runThreads(void *(*pfWork)(void *pvWorker),
+   struct Worker asWorkers[], int iThreadCount)
+{
+   pthread_t asThreads[MAX_THREAD_COUNT];
+   int i;
+
+   assert(pfWork != NULL);
+   assert(iThreadCount <= MAX_THREAD_COUNT);
+
+   for (i = 0; i < iThreadCount; i++)
+   {
+      if (pthread_create(&asThreads[i], NULL, pfWork,
+             &asWorkers[i]) != 0)
+      {
+         fprintf(stderr, "Cannot start a thread\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   for (i = 0; i < iThreadCount; i++)
+      pthread_join(asThreads[i], NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put, get, replace and remove keys that no other thread uses, as
+   described by pvWorker. */
+
+static void *disjointWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWorker->iThread, i);
+      pcValue = &psWorker->pcValues[i];
+      ASSURE(SymTable_put(psWorker->oSymTable, acKey, pcValue));
+      ASSURE(! SymTable_put(psWorker->oSymTable, acKey, pcValue));
+   }
+
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWorker->iThread, i);
+      pcValue = &psWorker->pcValues[i];
+      ASSURE(SymTable_get(psWorker->oSymTable, acKey) == pcValue);
+      ASSURE(SymTable_replace(psWorker->oSymTable, acKey, pcValue + 1)
+         == pcValue);
+      if (i % 2 == 0)
+         ASSURE(SymTable_remove(psWorker->oSymTable, acKey)
+            == pcValue + 1);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Let iThreadCount threads put, get, replace and remove iCount keys
+   each, no two threads using the same key, in a single SymTable
+   object. Check that every key ends up where its own thread left
+   it. */
+
+static void testDisjointKeys(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   SymTable_T oSymTable;
+   char *pcValues;
+   char acKey[MAX_KEY_LENGTH];
+   int iThread;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing threads that use disjoint keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pcValues = (char*)malloc((size_t)iCount + 1);
+   ASSURE(pcValues != NULL);
+   if (pcValues == NULL) return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   initWorkers(asWorkers, iThreadCount, oSymTable, iCount, pcValues);
+   runThreads(disjointWork, asWorkers, iThreadCount);
+
+   ASSURE(SymTable_getLength(oSymTable)
+      == (size_t)iThreadCount * (size_t)(iCount / 2));
+
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+   {
+      for (i = 0; i < iCount; i++)
+      {
+         sprintf(acKey, "%d.%d", iThread, i);
+         if (i % 2 == 0)
+            ASSURE(! SymTable_contains(oSymTable, acKey));
+         else
+            ASSURE(SymTable_get(oSymTable, acKey) == &pcValues[i + 1]);
+      }
+   }
+
+   SymTable_free(oSymTable);
+   free(pcValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Repeatedly remove and put back, or replace, the shared keys
+   described by pvWorker, always binding key i to &pcValues[i]. */
+
+static void *churnWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValues = psWorker->pcValues;
+   unsigned long uCount = (unsigned long)psWorker->iCount;
+   unsigned long uState = (unsigned long)psWorker->iThread + 1;
+   int iKey;
+   int i;
+   void *pvValue;
+
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      iKey = (int)(nextRandom(&uState) % uCount);
+      sprintf(acKey, "%d", iKey);
+      if (i % 2 == 0)
+      {
+         pvValue = SymTable_remove(psWorker->oSymTable, acKey);
+         ASSURE(pvValue == NULL || pvValue == &pcValues[iKey]);
+         (void)SymTable_put(psWorker->oSymTable, acKey,
+            &pcValues[iKey]);
+      }
+      else
+      {
+         pvValue = SymTable_replace(psWorker->oSymTable, acKey,
+            &pcValues[iKey]);
+         ASSURE(pvValue == NULL || pvValue == &pcValues[iKey]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Repeatedly get the shared keys described by pvWorker, which may be
+   missing but must never be bound to the wrong value. */
+
+static void *readWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValues = psWorker->pcValues;
+   unsigned long uCount = (unsigned long)psWorker->iCount;
+   unsigned long uState = (unsigned long)psWorker->iThread + 1;
+   int iKey;
+   int i;
+   void *pvValue;
+
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      iKey = (int)(nextRandom(&uState) % uCount);
+      sprintf(acKey, "%d", iKey);
+      pvValue = SymTable_get(psWorker->oSymTable, acKey);
+      ASSURE(pvValue == NULL || pvValue == &pcValues[iKey]);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run churnWork or readWork on pvWorker, so that threads with even
+   and odd indices, which start alternately, overlap. */
+
+static void *sharedWork(void *pvWorker)
+{
+   if (((struct Worker*)pvWorker)->iThread % 2 == 0)
+      return churnWork(pvWorker);
+   return readWork(pvWorker);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Let half of iThreadCount threads remove, put back and replace iCount
+   shared keys while the other half get them. Check that no thread
+   ever sees a key bound to the wrong value, and that every key is
+   back in place at the end. */
+
+static void testSharedKeys(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   SymTable_T oSymTable;
+   char *pcValues;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing readers and writers that share keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pcValues = (char*)malloc((size_t)iCount + 1);
+   ASSURE(pcValues != NULL);
+   if (pcValues == NULL) return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &pcValues[i]));
+   }
+
+   initWorkers(asWorkers, iThreadCount, oSymTable, iCount, pcValues);
+
+   runThreads(sharedWork, asWorkers, iThreadCount);
+
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iCount);
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &pcValues[i]);
+   }
+
+   SymTable_free(oSymTable);
+   free(pcValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Call SymTable_findOrInsert on every key of the shared key set
+   described by pvWorker, and count the keys that this thread
+   added. */
+
+static void *insertWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   int iInserted;
+   int i;
+
+   psWorker->lResult = 0;
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_findOrInsert(psWorker->oSymTable, acKey,
+         &iInserted) != NULL);
+      psWorker->lResult += iInserted;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Let iThreadCount threads call SymTable_findOrInsert on the same
+   iCount keys at once. Check that exactly one thread added each
+   key. */
+
+static void testRacingInserts(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   SymTable_T oSymTable;
+   long lInserted = 0;
+   int iThread;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing threads that insert the same keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   initWorkers(asWorkers, iThreadCount, oSymTable, iCount, NULL);
+   runThreads(insertWork, asWorkers, iThreadCount);
+
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+      lInserted += asWorkers[iThread].lResult;
+   ASSURE(lInserted == iCount);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iCount);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put every key of the range described by pvWorker, check it, and
+   remove it again, ROUND_COUNT times over, so that the table grows
+   and shrinks while other threads do the same. */
+
+static void *resizeWork(void *pvWorker)
+{
+   enum {ROUND_COUNT = 3};
+
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int iRound;
+   int i;
+
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = 0; i < psWorker->iCount; i++)
+      {
+         sprintf(acKey, "%d.%d", psWorker->iThread, i);
+         ASSURE(SymTable_put(psWorker->oSymTable, acKey,
+            &psWorker->pcValues[i]));
+      }
+      for (i = 0; i < psWorker->iCount; i++)
+      {
+         sprintf(acKey, "%d.%d", psWorker->iThread, i);
+         pcValue = &psWorker->pcValues[i];
+         ASSURE(SymTable_get(psWorker->oSymTable, acKey) == pcValue);
+         ASSURE(SymTable_remove(psWorker->oSymTable, acKey) == pcValue);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Let iThreadCount threads repeatedly fill a single SymTable object
+   with iCount keys each and drain it again, so that it resizes while
+   in use. Check that every key is found while present and that the
+   table ends up empty. */
+
+static void testResizeChurn(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   SymTable_T oSymTable;
+   char *pcValues;
+   size_t uCount = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing threads that make a table grow and shrink.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pcValues = (char*)malloc((size_t)iCount + 1);
+   ASSURE(pcValues != NULL);
+   if (pcValues == NULL) return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   initWorkers(asWorkers, iThreadCount, oSymTable, iCount, pcValues);
+   runThreads(resizeWork, asWorkers, iThreadCount);
+
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == 0);
+
+   SymTable_free(oSymTable);
+   free(pcValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The operations of the linearizability test. */
+enum OpType {OP_PUT, OP_GET, OP_CONTAINS, OP_REPLACE, OP_REMOVE,
+   OP_TYPE_COUNT};
+
+/* The linearizability test uses LIN_KEY_COUNT keys, and each of its
+   threads performs LIN_OPS_PER_THREAD operations per round. With at
+   most LIN_THREAD_COUNT threads, no key has more than 64 operations
+   per round. */
+enum {LIN_KEY_COUNT = 2, LIN_OPS_PER_THREAD = 4, LIN_THREAD_COUNT = 16};
+
+/* An Operation records one call of the linearizability test. */
+
+struct Operation
+{
+   /* The function called. */
+   enum OpType eType;
+
+   /* The index of the key passed. */
+   int iKey;
+
+   /* The value passed to SymTable_put or SymTable_replace. */
+   void *pvArgument;
+
+   /* The result of the call, as a pointer or as an integer. */
+   void *pvResult;
+   int iResult;
+
+   /* The monotonic time just before the call and just after it. */
+   long long llInvoked;
+   long long llReturned;
+};
+
+/* A History holds the operations of one round of the linearizability
+   test, and the state that the rounds share. */
+
+struct History
+{
+   /* Makes the threads start and finish each round together. */
+   pthread_barrier_t sBarrier;
+
+   /* The number of threads and of rounds. */
+   int iThreadCount;
+   int iRoundCount;
+
+   /* The operations of each thread in the current round. */
+   struct Operation aasOps[LIN_THREAD_COUNT][LIN_OPS_PER_THREAD];
+
+   /* The value of each key at the start of the round, or NULL if the
+      key is absent. */
+   void *apvInitial[LIN_KEY_COUNT];
+
+   /* The values put by the operations. The values of even and odd
+      rounds differ, so that a value never outlives its round. */
+   char acValues[2 * LIN_THREAD_COUNT * LIN_OPS_PER_THREAD];
+
+   /* The number of rounds found not to be linearizable. */
+   int iFailures;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the operation psOp to a key whose value is pvState, or that
+   is absent if pvState is NULL, as a sequential symbol table would.
+   Return 1 and set *ppvNewState to the value afterward if psOp got
+   the result that it recorded; otherwise return 0. */
+
+static int applyOperation(const struct Operation *psOp, void *pvState,
+   void **ppvNewState)
+{
+   assert(psOp != NULL);
+   assert(ppvNewState != NULL);
+
+   *ppvNewState = pvState;
+   switch (psOp->eType)
+   {
+      case OP_PUT:
+         if (pvState == NULL) *ppvNewState = psOp->pvArgument;
+         return psOp->iResult == (pvState == NULL);
+      case OP_GET:
+         return psOp->pvResult == pvState;
+      case OP_CONTAINS:
+         return psOp->iResult == (pvState != NULL);
+      case OP_REPLACE:
+         if (pvState != NULL) *ppvNewState = psOp->pvArgument;
+         return psOp->pvResult == pvState;
+      case OP_REMOVE:
+         *ppvNewState = NULL;
+         return psOp->pvResult == pvState;
+      default:
+         assert(0);
+         return 0;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the operations of apsOps[0..iCount-1] whose bits are
+   not set in uDone can be ordered so that each follows every
+   operation that returned before it was called, and each gets its
+   recorded result from a sequential symbol table whose key starts
+   with value pvState. Otherwise return 0. This is the search of Wing
+   and Gong. */
+
+static int isLinearizable(struct Operation *apsOps[], int iCount,
+   unsigned long long uDone, void *pvState)
+{
+   long long llFirstReturn = -1;
+   void *pvNewState;
+   int i;
+
+   assert(apsOps != NULL);
+
+   /* Only an operation called before every other remaining operation
+      returned can come first. */
+   for (i = 0; i < iCount; i++)
+   {
+      if ((uDone >> i) & 1) continue;
+      if (llFirstReturn < 0 || apsOps[i]->llReturned < llFirstReturn)
+         llFirstReturn = apsOps[i]->llReturned;
+   }
+   if (llFirstReturn < 0) return 1;
+
+   for (i = 0; i < iCount; i++)
+   {
+      if ((uDone >> i) & 1) continue;
+      if (apsOps[i]->llInvoked > llFirstReturn) continue;
+      if (applyOperation(apsOps[i], pvState, &pvNewState)
+          && isLinearizable(apsOps, iCount, uDone | (1ULL << i),
+                pvNewState))
+         return 1;
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Perform the rounds of the linearizability test described by
+   pvWorker, recording each operation. Thread 0 checks each round once
+   every thread has finished it. */
+
+static void *historyWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   struct History *psHistory = psWorker->psHistory;
+   struct Operation *psOp;
+   struct Operation *apsKeyOps[LIN_THREAD_COUNT * LIN_OPS_PER_THREAD];
+   SymTable_T oSymTable = psWorker->oSymTable;
+   unsigned long uState = (unsigned long)psWorker->iThread + 1;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int iOp;
+   int iKey;
+   int iThread;
+   int iKeyOps;
+
+   for (iRound = 0; iRound < psHistory->iRoundCount; iRound++)
+   {
+      pthread_barrier_wait(&psHistory->sBarrier);
+
+      for (iOp = 0; iOp < LIN_OPS_PER_THREAD; iOp++)
+      {
+         psOp = &psHistory->aasOps[psWorker->iThread][iOp];
+         psOp->eType = (enum OpType)
+            (nextRandom(&uState) % OP_TYPE_COUNT);
+         psOp->iKey = (int)(nextRandom(&uState) % LIN_KEY_COUNT);
+         psOp->pvArgument = &psHistory->acValues[
+            ((iRound % 2) * LIN_THREAD_COUNT + psWorker->iThread)
+            * LIN_OPS_PER_THREAD + iOp];
+         psOp->pvResult = NULL;
+         psOp->iResult = 0;
+         sprintf(acKey, "key%d", psOp->iKey);
+
+         psOp->llInvoked = getNanoseconds();
+         switch (psOp->eType)
+         {
+            case OP_PUT:
+               psOp->iResult =
+                  SymTable_put(oSymTable, acKey, psOp->pvArgument);
+               break;
+            case OP_GET:
+               psOp->pvResult = SymTable_get(oSymTable, acKey);
+               break;
+            case OP_CONTAINS:
+               psOp->iResult = SymTable_contains(oSymTable, acKey);
+               break;
+            case OP_REPLACE:
+               psOp->pvResult =
+                  SymTable_replace(oSymTable, acKey, psOp->pvArgument);
+               break;
+            default:
+               psOp->pvResult = SymTable_remove(oSymTable, acKey);
+               break;
+         }
+         psOp->llReturned = getNanoseconds();
+      }
+
+      pthread_barrier_wait(&psHistory->sBarrier);
+      if (psWorker->iThread != 0) continue;
+
+      /* Operations on different keys never constrain each other, so
+         each key is checked on its own. */
+      for (iKey = 0; iKey < LIN_KEY_COUNT; iKey++)
+      {
+         iKeyOps = 0;
+         for (iThread = 0; iThread < psHistory->iThreadCount; iThread++)
+            for (iOp = 0; iOp < LIN_OPS_PER_THREAD; iOp++)
+               if (psHistory->aasOps[iThread][iOp].iKey == iKey)
+                  apsKeyOps[iKeyOps++] =
+                     &psHistory->aasOps[iThread][iOp];
+
+         if (!isLinearizable(apsKeyOps, iKeyOps, 0,
+                psHistory->apvInitial[iKey]))
+            psHistory->iFailures++;
+
+         sprintf(acKey, "key%d", iKey);
+         psHistory->apvInitial[iKey] = SymTable_get(oSymTable, acKey);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Let up to iThreadCount threads, but no more than LIN_THREAD_COUNT,
+   call SymTable_put, SymTable_get, SymTable_contains,
+   SymTable_replace and SymTable_remove at random on a few shared keys,
+   for iRoundCount short rounds. Check that each round is linearizable:
+   that the results are those of some sequential order of the calls
+   that respects their real-time order. */
+
+static void testLinearizability(int iThreadCount, int iRoundCount)
+{
+   struct Worker asWorkers[LIN_THREAD_COUNT];
+   struct History *psHistory;
+   SymTable_T oSymTable;
+   int iKey;
+   int iThread;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the linearizability of concurrent calls.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   if (iThreadCount > LIN_THREAD_COUNT)
+      iThreadCount = LIN_THREAD_COUNT;
+
+   psHistory = (struct History*)malloc(sizeof(struct History));
+   ASSURE(psHistory != NULL);
+   if (psHistory == NULL) return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   pthread_barrier_init(&psHistory->sBarrier, NULL,
+      (unsigned)iThreadCount);
+   psHistory->iThreadCount = iThreadCount;
+   psHistory->iRoundCount = iRoundCount;
+   psHistory->iFailures = 0;
+   for (iKey = 0; iKey < LIN_KEY_COUNT; iKey++)
+      psHistory->apvInitial[iKey] = NULL;
+
+   initWorkers(asWorkers, iThreadCount, oSymTable, 0, NULL);
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+      asWorkers[iThread].psHistory = psHistory;
+   runThreads(historyWork, asWorkers, iThreadCount);
+
+   ASSURE(psHistory->iFailures == 0);
+
+   pthread_barrier_destroy(&psHistory->sBarrier);
+   SymTable_free(oSymTable);
+   free(psHistory);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Get pseudo-random keys of the shared key set described by pvWorker,
+   holding *psWorker->psMutex around each get if it is not NULL.
+   Count the keys found. */
+
+static void *benchmarkWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   unsigned long uState = (unsigned long)psWorker->iThread + 1;
+   int iKeyCount = psWorker->iCount;
+   int i;
+   void *pvValue;
+
+   psWorker->lResult = 0;
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      sprintf(acKey, "%d", (int)(nextRandom(&uState)
+         % (unsigned long)iKeyCount));
+      if (psWorker->psMutex != NULL)
+      {
+         pthread_mutex_lock(psWorker->psMutex);
+         pvValue = SymTable_get(psWorker->oSymTable, acKey);
+         pthread_mutex_unlock(psWorker->psMutex);
+      }
+      else
+         pvValue = SymTable_get(psWorker->oSymTable, acKey);
+      if (pvValue != NULL) psWorker->lResult++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iCount bindings into a SymTable object, then let 1, 2, 4, ...
+   up to iThreadCount threads get iCount pseudo-random keys each, both
+   directly and with every get serialized by one global mutex. Write
+   the throughput of each run to stdout. */
+
+static void benchmarkGets(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   pthread_mutex_t sMutex;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   int iThreads;
+   int iThread;
+   int iUseMutex;
+   int i;
+   long long llElapsed;
+
+   printf("------------------------------------------------------\n");
+   printf("Benchmarking concurrent gets (%d bindings).\n", iCount);
+   printf("No output except throughput should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   pthread_mutex_init(&sMutex, NULL);
+
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acValue));
+   }
+
+   for (iThreads = 1; iThreads <= iThreadCount; iThreads *= 2)
+   {
+      for (iUseMutex = 0; iUseMutex <= 1; iUseMutex++)
+      {
+         initWorkers(asWorkers, iThreads, oSymTable, iCount, NULL);
+         for (iThread = 0; iThread < iThreads; iThread++)
+            asWorkers[iThread].psMutex = iUseMutex ? &sMutex : NULL;
+
+         llElapsed = getNanoseconds();
+         runThreads(benchmarkWork, asWorkers, iThreads);
+         llElapsed = getNanoseconds() - llElapsed;
+
+         for (iThread = 0; iThread < iThreads; iThread++)
+            ASSURE(asWorkers[iThread].lResult == iCount);
+
+         printf("%2d threads, %s:  %.2f million gets/s\n", iThreads,
+            iUseMutex ? "global mutex" : "table only  ",
+            llElapsed == 0 ? 0.0 :
+            (double)iThreads * iCount * 1000.0 / (double)llElapsed);
+         fflush(stdout);
+      }
+   }
+
+   pthread_mutex_destroy(&sMutex);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iCount new keys if the thread described by pvWorker has an even
+   index, and get iCount pseudo-random keys of the preloaded key set
+   otherwise, holding *psWorker->psMutex around each call if it is not
+   NULL. */
+
+static void *ingestWork(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   if (psWorker->iThread % 2 != 0)
+      return benchmarkWork(pvWorker);
+
+   psWorker->lResult = 0;
+   for (i = 0; i < psWorker->iCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWorker->iThread, i);
+      if (psWorker->psMutex != NULL)
+      {
+         pthread_mutex_lock(psWorker->psMutex);
+         psWorker->lResult +=
+            SymTable_put(psWorker->oSymTable, acKey, psWorker);
+         pthread_mutex_unlock(psWorker->psMutex);
+      }
+      else
+         psWorker->lResult +=
+            SymTable_put(psWorker->oSymTable, acKey, psWorker);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iCount bindings into a SymTable object for each of 2, 4, ...
+   up to iThreadCount threads. Then let half of the threads put iCount
+   new keys each while the other half get iCount pseudo-random
+   preloaded keys each, both directly and with every call serialized
+   by one global mutex. Write the throughput of each run to stdout. */
+
+static void benchmarkIngest(int iThreadCount, int iCount)
+{
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   pthread_mutex_t sMutex;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   int iThreads;
+   int iUseMutex;
+   int i;
+   long long llElapsed;
+
+   printf("------------------------------------------------------\n");
+   printf("Benchmarking concurrent puts and gets (%d bindings).\n",
+      iCount);
+   printf("No output except throughput should appear here:\n");
+   fflush(stdout);
+
+   pthread_mutex_init(&sMutex, NULL);
+
+   for (iThreads = 2; iThreads <= iThreadCount; iThreads *= 2)
+   {
+      for (iUseMutex = 0; iUseMutex <= 1; iUseMutex++)
+      {
+         oSymTable = SymTable_new();
+         ASSURE(oSymTable != NULL);
+         for (i = 0; i < iCount; i++)
+         {
+            sprintf(acKey, "%d", i);
+            ASSURE(SymTable_put(oSymTable, acKey, acValue));
+         }
+
+         initWorkers(asWorkers, iThreads, oSymTable, iCount, NULL);
+         for (i = 0; i < iThreads; i++)
+            asWorkers[i].psMutex = iUseMutex ? &sMutex : NULL;
+
+         llElapsed = getNanoseconds();
+         runThreads(ingestWork, asWorkers, iThreads);
+         llElapsed = getNanoseconds() - llElapsed;
+
+         for (i = 0; i < iThreads; i++)
+            ASSURE(asWorkers[i].lResult == iCount);
+         ASSURE(SymTable_getLength(oSymTable)
+            == (size_t)iCount * (size_t)(1 + iThreads / 2));
+
+         printf("%2d threads, %s:  %.2f million calls/s\n", iThreads,
+            iUseMutex ? "global mutex" : "table only  ",
+            llElapsed == 0 ? 0.0 :
+            (double)iThreads * iCount * 1000.0 / (double)llElapsed);
+         fflush(stdout);
+
+         SymTable_free(oSymTable);
+      }
+   }
+
+   pthread_mutex_destroy(&sMutex);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Stress and benchmark a thread-safe SymTable implementation. Write
+   the output of the tests to stdout. argv[1] is the number of keys
+   that each thread uses, and argv[2] is the largest number of
+   threads to start. Exit with EXIT_FAILURE if either is missing or
+   out of range. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+   int iThreadCount;
+
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount threadcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1
+       || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[2], "%d", &iThreadCount) != 1
+       || iThreadCount < 1 || iThreadCount > MAX_THREAD_COUNT)
+   {
+      fprintf(stderr, "threadcount must be between 1 and %d\n",
+         MAX_THREAD_COUNT);
+      exit(EXIT_FAILURE);
+   }
+
+   testDisjointKeys(iThreadCount, iBindingCount);
+   testSharedKeys(iThreadCount, iBindingCount);
+   testRacingInserts(iThreadCount, iBindingCount);
+   testResizeChurn(iThreadCount, iBindingCount);
+   testLinearizability(iThreadCount, iBindingCount / 10);
+   benchmarkGets(iThreadCount, iBindingCount);
+   benchmarkIngest(iThreadCount, iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
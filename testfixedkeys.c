@@ -0,0 +1,414 @@
+/*--------------------------------------------------------------------*/
+/* testfixedkeys.c                                                    */
+/*--------------------------------------------------------------------*/
+
+/* Request POSIX declarations, for clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include "symtableint.h"
+#include "symtableptr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <limits.h>
+#include <assert.h>
+
+/* AddressSanitizer replaces malloc, so mallinfo2 does not see the
+   memory that it hands out. */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of heap memory in use, or 0 if the C
+   library cannot report it. */
+
+static size_t getHeapInUse(void)
+{
+#ifdef HAVE_MALLINFO2
+   struct mallinfo2 sInfo = mallinfo2();
+   return sInfo.uordblks + sInfo.hblkhd;
+#else
+   return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the int that pvExtra points to, and check that pvValue
+   points to the long lKey. */
+
+static void countIntBinding(long lKey, void *pvValue, void *pvExtra)
+{
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE(*(long*)pvValue == lKey);
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableInt functions. */
+
+static void testInt(void)
+{
+   enum {KEY_COUNT = 1000};
+
+   SymTableInt_T oSymTableInt;
+   long alKeys[KEY_COUNT];
+   int iCount = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTableInt object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTableInt = SymTableInt_new();
+   ASSURE(oSymTableInt != NULL);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 0);
+   ASSURE(SymTableInt_get(oSymTableInt, 0) == NULL);
+   ASSURE(! SymTableInt_contains(oSymTableInt, 0));
+   ASSURE(SymTableInt_remove(oSymTableInt, 0) == NULL);
+   ASSURE(SymTableInt_replace(oSymTableInt, 0, "Ruth") == NULL);
+
+   /* Zero, negative numbers and the extremes are ordinary keys. */
+   ASSURE(SymTableInt_put(oSymTableInt, 0, "Ruth"));
+   ASSURE(SymTableInt_put(oSymTableInt, -1, "Gehrig"));
+   ASSURE(SymTableInt_put(oSymTableInt, LONG_MIN, "Mantle"));
+   ASSURE(SymTableInt_put(oSymTableInt, LONG_MAX, NULL));
+   ASSURE(! SymTableInt_put(oSymTableInt, 0, "Jeter"));
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 4);
+   ASSURE(SymTableInt_get(oSymTableInt, 0) == (void*)"Ruth");
+   ASSURE(SymTableInt_get(oSymTableInt, -1) == (void*)"Gehrig");
+   ASSURE(SymTableInt_get(oSymTableInt, LONG_MIN) == (void*)"Mantle");
+   ASSURE(SymTableInt_get(oSymTableInt, LONG_MAX) == NULL);
+   ASSURE(SymTableInt_contains(oSymTableInt, LONG_MAX));
+   ASSURE(! SymTableInt_contains(oSymTableInt, 1));
+
+   ASSURE(SymTableInt_replace(oSymTableInt, -1, "Jeter")
+      == (void*)"Gehrig");
+   ASSURE(SymTableInt_get(oSymTableInt, -1) == (void*)"Jeter");
+   ASSURE(SymTableInt_remove(oSymTableInt, LONG_MIN)
+      == (void*)"Mantle");
+   ASSURE(! SymTableInt_contains(oSymTableInt, LONG_MIN));
+   ASSURE(SymTableInt_remove(oSymTableInt, LONG_MAX) == NULL);
+   ASSURE(SymTableInt_remove(oSymTableInt, 0) == (void*)"Ruth");
+   ASSURE(SymTableInt_remove(oSymTableInt, -1) == (void*)"Jeter");
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 0);
+
+   /* Enough keys, spaced like addresses, to expand the table several
+      times, then remove most of them so that it shrinks. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      alKeys[i] = (long)i * 64 - KEY_COUNT;
+      ASSURE(SymTableInt_put(oSymTableInt, alKeys[i], &alKeys[i]));
+   }
+   ASSURE(SymTableInt_getLength(oSymTableInt) == KEY_COUNT);
+   SymTableInt_map(oSymTableInt, countIntBinding, &iCount);
+   ASSURE(iCount == KEY_COUNT);
+
+   for (i = 0; i < KEY_COUNT; i++)
+      if (i % 10 != 0)
+         ASSURE(SymTableInt_remove(oSymTableInt, alKeys[i])
+            == &alKeys[i]);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == KEY_COUNT / 10);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTableInt_get(oSymTableInt, alKeys[i])
+         == (i % 10 == 0 ? &alKeys[i] : NULL));
+
+   SymTableInt_free(oSymTableInt);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the int that pvExtra points to, and check that pvKey is
+   the address of the int that pvValue points to. */
+
+static void countPtrBinding(const void *pvKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pvExtra != NULL);
+
+   ASSURE(pvKey == pvValue);
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTablePtr functions. */
+
+static void testPtr(void)
+{
+   enum {KEY_COUNT = 1000};
+
+   SymTablePtr_T oSymTablePtr;
+   int aiObjects[KEY_COUNT];
+   char acRuth[] = "Ruth";
+   char acRuth2[] = "Ruth";
+   int iCount = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTablePtr object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTablePtr = SymTablePtr_new();
+   ASSURE(oSymTablePtr != NULL);
+   ASSURE(SymTablePtr_getLength(oSymTablePtr) == 0);
+   ASSURE(SymTablePtr_get(oSymTablePtr, acRuth) == NULL);
+
+   /* Keys are compared by address, not by what they point to. */
+   ASSURE(SymTablePtr_put(oSymTablePtr, acRuth, "first"));
+   ASSURE(SymTablePtr_put(oSymTablePtr, acRuth2, "second"));
+   ASSURE(! SymTablePtr_put(oSymTablePtr, acRuth, "third"));
+   ASSURE(SymTablePtr_put(oSymTablePtr, NULL, "null"));
+   ASSURE(SymTablePtr_getLength(oSymTablePtr) == 3);
+   ASSURE(SymTablePtr_get(oSymTablePtr, acRuth) == (void*)"first");
+   ASSURE(SymTablePtr_get(oSymTablePtr, acRuth2) == (void*)"second");
+   ASSURE(SymTablePtr_get(oSymTablePtr, NULL) == (void*)"null");
+   ASSURE(SymTablePtr_replace(oSymTablePtr, acRuth2, NULL)
+      == (void*)"second");
+   ASSURE(SymTablePtr_contains(oSymTablePtr, acRuth2));
+   ASSURE(SymTablePtr_remove(oSymTablePtr, acRuth2) == NULL);
+   ASSURE(! SymTablePtr_contains(oSymTablePtr, acRuth2));
+   ASSURE(SymTablePtr_remove(oSymTablePtr, NULL) == (void*)"null");
+   ASSURE(SymTablePtr_remove(oSymTablePtr, acRuth) == (void*)"first");
+   ASSURE(SymTablePtr_getLength(oSymTablePtr) == 0);
+
+   /* Adjacent addresses differ only in their low bits, which the
+      table must still spread over its slots. */
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTablePtr_put(oSymTablePtr, &aiObjects[i],
+         &aiObjects[i]));
+   ASSURE(SymTablePtr_getLength(oSymTablePtr) == KEY_COUNT);
+   SymTablePtr_map(oSymTablePtr, countPtrBinding, &iCount);
+   ASSURE(iCount == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTablePtr_remove(oSymTablePtr, &aiObjects[i])
+         == &aiObjects[i]);
+   ASSURE(SymTablePtr_getLength(oSymTablePtr) == 0);
+
+   SymTablePtr_free(oSymTablePtr);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the elapsed time per operation of llNanoseconds spent on
+   iCount operations of the kind pcWhat, by pcHow, to stdout. */
+
+static void printRate(const char *pcWhat, const char *pcHow,
+   long long llNanoseconds, int iCount)
+{
+   assert(pcWhat != NULL);
+   assert(pcHow != NULL);
+
+   printf("%-8s by %-7s %7.1f ns\n", pcWhat, pcHow,
+      (double)llNanoseconds / (double)iCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put, get and remove the integers 0 through iCount-1, and then the
+   addresses of iCount objects, first in a SymTable keyed by their
+   formatted strings and then in a SymTableInt or SymTablePtr. Write
+   the elapsed time per operation, and the heap used by each table when
+   full, to stdout. */
+
+static void testFixedKeyThroughput(int iCount)
+{
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymTable_T oSymTable;
+   SymTableInt_T oSymTableInt;
+   SymTablePtr_T oSymTablePtr;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcObjects;
+   size_t uHeap;
+   size_t uStringHeap;
+   size_t uFixedHeap;
+   long long llStart;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the throughput of integer and address keys.\n");
+   printf("No output except elapsed time and heap use should appear "
+      "here:\n");
+   fflush(stdout);
+
+   if (iCount == 0) return;
+
+   /* Integer keys, formatted with "%d" as testLargeTable does. */
+   uHeap = getHeapInUse();
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acKey));
+   }
+   printRate("put int", "string", getNanoseconds() - llStart, iCount);
+   uStringHeap = getHeapInUse() - uHeap;
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) != NULL);
+   }
+   printRate("get int", "string", getNanoseconds() - llStart, iCount);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) != NULL);
+   }
+   printRate("remove", "string", getNanoseconds() - llStart, iCount);
+   SymTable_free(oSymTable);
+
+   uHeap = getHeapInUse();
+   oSymTableInt = SymTableInt_new();
+   ASSURE(oSymTableInt != NULL);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+      ASSURE(SymTableInt_put(oSymTableInt, i, acKey));
+   printRate("put int", "integer", getNanoseconds() - llStart, iCount);
+   uFixedHeap = getHeapInUse() - uHeap;
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+      ASSURE(SymTableInt_get(oSymTableInt, i) != NULL);
+   printRate("get int", "integer", getNanoseconds() - llStart, iCount);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+      ASSURE(SymTableInt_remove(oSymTableInt, i) != NULL);
+   printRate("remove", "integer", getNanoseconds() - llStart, iCount);
+   SymTableInt_free(oSymTableInt);
+#ifdef HAVE_MALLINFO2
+   printf("Heap for %d integer keys:  %lu bytes by string, %lu bytes "
+      "by integer\n", iCount, (unsigned long)uStringHeap,
+      (unsigned long)uFixedHeap);
+#endif
+
+   /* Address keys, formatted with "%p". */
+   pcObjects = (char*)malloc((size_t)iCount);
+   ASSURE(pcObjects != NULL);
+   if (pcObjects == NULL) return;
+
+   uHeap = getHeapInUse();
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%p", (void*)&pcObjects[i]);
+      ASSURE(SymTable_put(oSymTable, acKey, &pcObjects[i]));
+   }
+   printRate("put ptr", "string", getNanoseconds() - llStart, iCount);
+   uStringHeap = getHeapInUse() - uHeap;
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+   {
+      sprintf(acKey, "%p", (void*)&pcObjects[i]);
+      ASSURE(SymTable_get(oSymTable, acKey) == &pcObjects[i]);
+   }
+   printRate("get ptr", "string", getNanoseconds() - llStart, iCount);
+   SymTable_free(oSymTable);
+
+   uHeap = getHeapInUse();
+   oSymTablePtr = SymTablePtr_new();
+   ASSURE(oSymTablePtr != NULL);
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+      ASSURE(SymTablePtr_put(oSymTablePtr, &pcObjects[i],
+         &pcObjects[i]));
+   printRate("put ptr", "address", getNanoseconds() - llStart, iCount);
+   uFixedHeap = getHeapInUse() - uHeap;
+   llStart = getNanoseconds();
+   for (i = 0; i < iCount; i++)
+      ASSURE(SymTablePtr_get(oSymTablePtr, &pcObjects[i])
+         == &pcObjects[i]);
+   printRate("get ptr", "address", getNanoseconds() - llStart, iCount);
+   SymTablePtr_free(oSymTablePtr);
+#ifdef HAVE_MALLINFO2
+   printf("Heap for %d address keys:  %lu bytes by string, %lu bytes "
+      "by address\n", iCount, (unsigned long)uStringHeap,
+      (unsigned long)uFixedHeap);
+#endif
+   (void)uStringHeap;
+   (void)uFixedHeap;
+
+   fflush(stdout);
+   free(pcObjects);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableInt and SymTablePtr ADTs. As the first command-line
+   argument, argv[1], accept the number of keys that the timed test
+   should use. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "keycount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iKeyCount < 0)
+   {
+      fprintf(stderr, "keycount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testInt();
+   testPtr();
+   testFixedKeyThroughput(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
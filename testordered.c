@@ -0,0 +1,551 @@
+/*--------------------------------------------------------------------*/
+/* testordered.c                                                      */
+/*--------------------------------------------------------------------*/
+
+/* Request POSIX declarations, for clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include "symtableordered.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Visit records the bindings that a map of a SymTable object has
+   visited so far. */
+
+struct Visit
+{
+   /* The number of bindings visited. */
+   int iCount;
+
+   /* The key of the last binding visited, or NULL. */
+   const char *pcLastKey;
+
+   /* The key of the first binding visited, or NULL. */
+   const char *pcFirstKey;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Record the binding whose key is pcKey in pvExtra, which points to a
+   Visit, and check that pcKey comes after the key recorded before it
+   and that pvValue is a copy of pcKey. */
+
+static void visitBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct Visit *psVisit = (struct Visit*)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   if (psVisit->pcLastKey != NULL)
+      ASSURE(strcmp(psVisit->pcLastKey, pcKey) < 0);
+   if (psVisit->pcFirstKey == NULL)
+      psVisit->pcFirstKey = pcKey;
+   ASSURE(pvValue != NULL && strcmp((char*)pvValue, pcKey) == 0);
+   psVisit->pcLastKey = pcKey;
+   psVisit->iCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a Visit of no bindings. */
+
+static struct Visit newVisit(void)
+{
+   struct Visit sVisit;
+   sVisit.iCount = 0;
+   sVisit.pcLastKey = NULL;
+   sVisit.pcFirstKey = NULL;
+   return sVisit;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the bindings of oSymTable with SymTable_mapRange from pcLow to
+   pcHigh, checking their order, and return the Visit. */
+
+static struct Visit visitRange(SymTable_T oSymTable,
+   const char *pcLow, const char *pcHigh)
+{
+   struct Visit sVisit = newVisit();
+   SymTable_mapRange(oSymTable, pcLow, pcHigh, visitBinding, &sVisit);
+   return sVisit;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the bindings of oSymTable with SymTable_mapPrefix for
+   pcPrefix, checking their order, and return the Visit. */
+
+static struct Visit visitPrefix(SymTable_T oSymTable,
+   const char *pcPrefix)
+{
+   struct Visit sVisit = newVisit();
+   SymTable_mapPrefix(oSymTable, pcPrefix, visitBinding, &sVisit);
+   return sVisit;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that SymTable_map and an iteration visit the bindings of a
+   SymTable object in increasing order of key. */
+
+static void testOrder(void)
+{
+   static const char *const apcKeys[] = {"zz", "abd", "a", "\xe9t\xe9",
+      "", "abc", "b", "ab", "Z", "a b", "ab\x7f", "abc\x80"};
+   enum {KEY_COUNT = sizeof(apcKeys) / sizeof(apcKeys[0])};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   struct Visit sVisit = newVisit();
+   const char *pcLastKey = NULL;
+   size_t i;
+   int iCount = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the order of bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_put(oSymTable, apcKeys[i], apcKeys[i]));
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+   SymTable_map(oSymTable, visitBinding, &sVisit);
+   ASSURE(sVisit.iCount == KEY_COUNT);
+   ASSURE(sVisit.pcFirstKey != NULL && *sVisit.pcFirstKey == '\0');
+   ASSURE(sVisit.pcLastKey != NULL
+      && strcmp(sVisit.pcLastKey, "\xe9t\xe9") == 0);
+
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+   {
+      if (pcLastKey != NULL)
+         ASSURE(strcmp(pcLastKey, SymTable_iterKey(&sIter)) < 0);
+      pcLastKey = SymTable_iterKey(&sIter);
+      iCount++;
+   }
+   ASSURE(iCount == KEY_COUNT);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapRange with bounds that are keys, bounds that are
+   not, open bounds and empty ranges. */
+
+static void testRange(void)
+{
+   enum {KEY_COUNT = 1000, MAX_KEY_LENGTH = 8};
+
+   SymTable_T oSymTable;
+   char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   struct Visit sVisit;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapRange.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   sVisit = visitRange(oSymTable, NULL, NULL);
+   ASSURE(sVisit.iCount == 0);
+
+   /* Put the keys in a scrambled order. */
+   for (i = 0; i < KEY_COUNT; i++)
+      sprintf(aacKeys[i], "%04d", i);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_put(oSymTable, aacKeys[i * 7 % KEY_COUNT],
+         aacKeys[i * 7 % KEY_COUNT]));
+
+   sVisit = visitRange(oSymTable, "0100", "0200");
+   ASSURE(sVisit.iCount == 100);
+   ASSURE(sVisit.pcFirstKey != NULL
+      && strcmp(sVisit.pcFirstKey, "0100") == 0);
+   ASSURE(sVisit.pcLastKey != NULL
+      && strcmp(sVisit.pcLastKey, "0199") == 0);
+
+   sVisit = visitRange(oSymTable, NULL, NULL);
+   ASSURE(sVisit.iCount == KEY_COUNT);
+
+   sVisit = visitRange(oSymTable, "0990", NULL);
+   ASSURE(sVisit.iCount == 10);
+
+   sVisit = visitRange(oSymTable, NULL, "0005");
+   ASSURE(sVisit.iCount == 5);
+
+   /* Bounds that are not keys. */
+   sVisit = visitRange(oSymTable, "0100x", "0102x");
+   ASSURE(sVisit.iCount == 2);
+   ASSURE(sVisit.pcFirstKey != NULL
+      && strcmp(sVisit.pcFirstKey, "0101") == 0);
+
+   sVisit = visitRange(oSymTable, "", "1");
+   ASSURE(sVisit.iCount == KEY_COUNT);
+
+   /* Empty ranges. */
+   sVisit = visitRange(oSymTable, "0200", "0100");
+   ASSURE(sVisit.iCount == 0);
+   sVisit = visitRange(oSymTable, "0100", "0100");
+   ASSURE(sVisit.iCount == 0);
+   sVisit = visitRange(oSymTable, "1", NULL);
+   ASSURE(sVisit.iCount == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapPrefix with prefixes of many keys, of one key and
+   of none. */
+
+static void testPrefix(void)
+{
+   enum {MODULE_COUNT = 10, SYMBOL_COUNT = 100, MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   char aacKeys[MODULE_COUNT * SYMBOL_COUNT][MAX_KEY_LENGTH];
+   struct Visit sVisit;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapPrefix.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   sVisit = visitPrefix(oSymTable, "");
+   ASSURE(sVisit.iCount == 0);
+
+   for (i = 0; i < MODULE_COUNT * SYMBOL_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "mod%d.sym%d", i % MODULE_COUNT,
+         i / MODULE_COUNT);
+      ASSURE(SymTable_put(oSymTable, aacKeys[i], aacKeys[i]));
+   }
+
+   sVisit = visitPrefix(oSymTable, "mod3.");
+   ASSURE(sVisit.iCount == SYMBOL_COUNT);
+   sVisit = visitPrefix(oSymTable, "mod3");
+   ASSURE(sVisit.iCount == SYMBOL_COUNT);
+
+   /* sym1 and sym10 to sym19. */
+   sVisit = visitPrefix(oSymTable, "mod3.sym1");
+   ASSURE(sVisit.iCount == 11);
+   ASSURE(sVisit.pcFirstKey != NULL
+      && strcmp(sVisit.pcFirstKey, "mod3.sym1") == 0);
+
+   sVisit = visitPrefix(oSymTable, "");
+   ASSURE(sVisit.iCount == MODULE_COUNT * SYMBOL_COUNT);
+
+   sVisit = visitPrefix(oSymTable, "mod9.sym99");
+   ASSURE(sVisit.iCount == 1);
+   sVisit = visitPrefix(oSymTable, "mod9.sym99x");
+   ASSURE(sVisit.iCount == 0);
+   sVisit = visitPrefix(oSymTable, "mod");
+   ASSURE(sVisit.iCount == MODULE_COUNT * SYMBOL_COUNT);
+   sVisit = visitPrefix(oSymTable, "mod:");
+   ASSURE(sVisit.iCount == 0);
+   sVisit = visitPrefix(oSymTable, "a");
+   ASSURE(sVisit.iCount == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iKeyCount keys in a scrambled order, remove two in three of
+   them, and then the rest, checking the order and the bindings left
+   after each. */
+
+static void testRemoveInOrder(int iKeyCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   struct Visit sVisit;
+   int iStep;
+   int i;
+   int j;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the order of bindings after removals.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   if (iKeyCount == 0) return;
+
+   pcKeys = (char*)malloc((size_t)iKeyCount * MAX_KEY_LENGTH);
+   ASSURE(pcKeys != NULL);
+   if (pcKeys == NULL) return;
+
+   /* A step that is prime to iKeyCount visits each key once. */
+   iStep = 7919;
+   while (iKeyCount % iStep == 0) iStep++;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iKeyCount; i++)
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH, "%d", i);
+   for (i = 0, j = 0; i < iKeyCount; i++, j = (j + iStep) % iKeyCount)
+      ASSURE(SymTable_put(oSymTable,
+         pcKeys + (size_t)j * MAX_KEY_LENGTH,
+         pcKeys + (size_t)j * MAX_KEY_LENGTH));
+
+   for (i = 0, j = 0; i < iKeyCount; i++, j = (j + iStep) % iKeyCount)
+      if (j % 3 != 0)
+         ASSURE(SymTable_remove(oSymTable,
+            pcKeys + (size_t)j * MAX_KEY_LENGTH)
+            == pcKeys + (size_t)j * MAX_KEY_LENGTH);
+   ASSURE(SymTable_getLength(oSymTable)
+      == (size_t)((iKeyCount + 2) / 3));
+
+   sVisit = visitRange(oSymTable, NULL, NULL);
+   ASSURE(sVisit.iCount == (iKeyCount + 2) / 3);
+   for (i = 0; i < iKeyCount; i++)
+      ASSURE(SymTable_contains(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH) == (i % 3 == 0));
+
+   for (i = 0; i < iKeyCount; i += 3)
+      ASSURE(SymTable_remove(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH)
+         == pcKeys + (size_t)i * MAX_KEY_LENGTH);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   sVisit = visitRange(oSymTable, NULL, NULL);
+   ASSURE(sVisit.iCount == 0);
+
+   /* The emptied table is still usable. */
+   ASSURE(SymTable_put(oSymTable, pcKeys, pcKeys));
+   sVisit = visitPrefix(oSymTable, pcKeys);
+   ASSURE(sVisit.iCount == 1);
+
+   SymTable_free(oSymTable);
+   free(pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A KeyCopy collects the keys of a SymTable object. */
+
+struct KeyCopy
+{
+   /* The keys collected so far. */
+   const char **ppcKeys;
+
+   /* The number of keys collected so far. */
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Add pcKey to pvExtra, a KeyCopy. */
+
+static void copyKey(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct KeyCopy *psCopy = (struct KeyCopy*)pvExtra;
+
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   psCopy->ppcKeys[psCopy->uCount++] = pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the strings that pvKey1 and pvKey2 point to, for qsort. */
+
+static int compareKeys(const void *pvKey1, const void *pvKey2)
+{
+   return strcmp(*(const char *const*)pvKey1,
+      *(const char *const*)pvKey2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the int that pvExtra points to. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pvExtra != NULL);
+   (void)pcKey;
+   (void)pvValue;
+
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build a SymTable object of iKeyCount identifiers, NAMESPACE_COUNT
+   namespaces of iKeyCount / NAMESPACE_COUNT each, and find the
+   identifiers of one namespace with SymTable_mapPrefix, and then by
+   copying every key out, sorting them and searching the sorted keys.
+   Write the elapsed time of each to stdout. */
+
+static void testPrefixThroughput(int iKeyCount)
+{
+   enum {NAMESPACE_COUNT = 1000, MAX_KEY_LENGTH = 24};
+
+   static const char acPrefix[] = "ns042::";
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   struct KeyCopy sCopy;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMiddle;
+   size_t uPrefixLength = strlen(acPrefix);
+   long long llStart;
+   int iExpected;
+   int iCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing prefix scans of a large SymTable object.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   if (iKeyCount == 0) return;
+
+   pcKeys = (char*)malloc((size_t)iKeyCount * MAX_KEY_LENGTH);
+   sCopy.ppcKeys = (const char**)
+      malloc((size_t)iKeyCount * sizeof(const char*));
+   ASSURE(pcKeys != NULL && sCopy.ppcKeys != NULL);
+   if (pcKeys == NULL || sCopy.ppcKeys == NULL)
+   {
+      free(pcKeys);
+      free(sCopy.ppcKeys);
+      return;
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iExpected = 0;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH, "ns%03d::ident%d",
+         i % NAMESPACE_COUNT, i / NAMESPACE_COUNT);
+      ASSURE(SymTable_putBorrowed(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH, NULL));
+      if (i % NAMESPACE_COUNT == 42) iExpected++;
+   }
+
+   iCount = 0;
+   llStart = getNanoseconds();
+   SymTable_mapPrefix(oSymTable, acPrefix, countBinding, &iCount);
+   printf("Elapsed time of SymTable_mapPrefix (%d keys):  %.3f ms\n",
+      iCount, (double)(getNanoseconds() - llStart) / 1e6);
+   ASSURE(iCount == iExpected);
+
+   /* The same scan, as a client of an unordered table would do it. */
+   iCount = 0;
+   llStart = getNanoseconds();
+   sCopy.uCount = 0;
+   SymTable_map(oSymTable, copyKey, &sCopy);
+   qsort(sCopy.ppcKeys, sCopy.uCount, sizeof(const char*),
+      compareKeys);
+   uLow = 0;
+   uHigh = sCopy.uCount;
+   while (uLow < uHigh)
+   {
+      uMiddle = uLow + (uHigh - uLow) / 2;
+      if (strcmp(sCopy.ppcKeys[uMiddle], acPrefix) < 0)
+         uLow = uMiddle + 1;
+      else
+         uHigh = uMiddle;
+   }
+   for (; uLow < sCopy.uCount
+          && strncmp(sCopy.ppcKeys[uLow], acPrefix, uPrefixLength) == 0;
+        uLow++)
+      iCount++;
+   printf("Elapsed time of copying, sorting and searching (%d keys):  "
+      "%.3f ms\n", iCount, (double)(getNanoseconds() - llStart) / 1e6);
+   ASSURE(iCount == iExpected);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(sCopy.ppcKeys);
+   free(pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ordered SymTable functions. As always, argc is the
+   command-line argument count and argv contains the command-line
+   arguments. argv[1] is the number of keys for the larger tests.
+   Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "keycount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iKeyCount < 0)
+   {
+      fprintf(stderr, "keycount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testOrder();
+   testRange();
+   testPrefix();
+   testRemoveInOrder(iKeyCount);
+   testPrefixThroughput(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,422 @@
+/*--------------------------------------------------------------------*/
+/* testsymintern.c                                                    */
+/*--------------------------------------------------------------------*/
+
+/* Request POSIX declarations, for clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include "symintern.h"
+#include "symidmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+
+/* AddressSanitizer replaces malloc, so mallinfo2 does not see the
+   memory that it hands out. */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of heap memory in use, or 0 if the C
+   library cannot report it. */
+
+static size_t getHeapInUse(void)
+{
+#ifdef HAVE_MALLINFO2
+   struct mallinfo2 sInfo = mallinfo2();
+   return sInfo.uordblks + sInfo.hblkhd;
+#else
+   return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that interning gives equal strings one canonical copy and one
+   ID, and different strings different ones. */
+
+static void testIntern(void)
+{
+   enum {STRING_COUNT = 1000, MAX_STRING_LENGTH = 24};
+
+   SymIntern_T oSymIntern;
+   char acString[MAX_STRING_LENGTH];
+   char acJeter[] = "Jeter";
+   char acJeter2[] = "Jeter";
+   const char *pcJeter;
+   const char *pcCanonical;
+   const char *pcText = "Ruth Gehrig";
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing interning.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymIntern = SymIntern_new();
+   ASSURE(oSymIntern != NULL);
+   ASSURE(SymIntern_getLength(oSymIntern) == 0);
+   ASSURE(SymIntern_lookup(oSymIntern, "Jeter") == NULL);
+   ASSURE(SymIntern_string(oSymIntern, 0) == NULL);
+
+   pcJeter = SymIntern_intern(oSymIntern, acJeter);
+   ASSURE(pcJeter != NULL);
+   ASSURE(pcJeter != acJeter);
+   ASSURE(strcmp(pcJeter, "Jeter") == 0);
+   ASSURE(SymIntern_intern(oSymIntern, acJeter2) == pcJeter);
+   ASSURE(SymIntern_lookup(oSymIntern, "Jeter") == pcJeter);
+   ASSURE(SymIntern_id(oSymIntern, pcJeter) == 0);
+   ASSURE(SymIntern_string(oSymIntern, 0) == pcJeter);
+   ASSURE(SymIntern_getLength(oSymIntern) == 1);
+
+   /* The canonical copy does not depend on the caller's buffer. */
+   strcpy(acJeter, "xxx");
+   ASSURE(strcmp(pcJeter, "Jeter") == 0);
+
+   /* Slices of a larger string, and the empty string. */
+   pcCanonical = SymIntern_internN(oSymIntern, pcText, 4);
+   ASSURE(pcCanonical != NULL);
+   ASSURE(strcmp(pcCanonical, "Ruth") == 0);
+   ASSURE(SymIntern_intern(oSymIntern, "Ruth") == pcCanonical);
+   ASSURE(SymIntern_internN(oSymIntern, pcText + 5, 6)
+      == SymIntern_intern(oSymIntern, "Gehrig"));
+   pcCanonical = SymIntern_intern(oSymIntern, "");
+   ASSURE(pcCanonical != NULL);
+   ASSURE(*pcCanonical == '\0');
+   ASSURE(SymIntern_internN(oSymIntern, pcText, 0) == pcCanonical);
+   ASSURE(SymIntern_getLength(oSymIntern) == 4);
+
+   /* IDs are given out in order, and enough strings to fill several
+      blocks keep their copies. */
+   for (i = 0; i < STRING_COUNT; i++)
+   {
+      sprintf(acString, "identifier_%d", i);
+      pcCanonical = SymIntern_intern(oSymIntern, acString);
+      ASSURE(pcCanonical != NULL);
+      ASSURE(SymIntern_id(oSymIntern, pcCanonical) == (size_t)i + 4);
+   }
+   for (i = 0; i < STRING_COUNT; i++)
+   {
+      sprintf(acString, "identifier_%d", i);
+      pcCanonical = SymIntern_string(oSymIntern, (size_t)i + 4);
+      ASSURE(pcCanonical != NULL);
+      ASSURE(strcmp(pcCanonical, acString) == 0);
+      ASSURE(SymIntern_lookup(oSymIntern, acString) == pcCanonical);
+   }
+   ASSURE(SymIntern_getLength(oSymIntern) == STRING_COUNT + 4);
+   ASSURE(SymIntern_string(oSymIntern, STRING_COUNT + 4) == NULL);
+   ASSURE(SymIntern_string(oSymIntern, SYMINTERN_NONE) == NULL);
+
+   SymIntern_free(oSymIntern);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test strings too long for any block of canonical copies, between
+   strings that share blocks. */
+
+static void testLongStrings(void)
+{
+   enum {LONG_LENGTH = 100000};
+
+   SymIntern_T oSymIntern;
+   char *pcLong;
+   const char *pcLongCanonical;
+   const char *pcShortCanonical;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing long interned strings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pcLong = (char*)malloc(LONG_LENGTH + 1);
+   ASSURE(pcLong != NULL);
+   if (pcLong == NULL) return;
+   memset(pcLong, 'x', LONG_LENGTH);
+   pcLong[LONG_LENGTH] = '\0';
+
+   oSymIntern = SymIntern_new();
+   ASSURE(oSymIntern != NULL);
+
+   /* A long string first, and again after a short one. */
+   pcLongCanonical = SymIntern_intern(oSymIntern, pcLong);
+   ASSURE(pcLongCanonical != NULL);
+   pcShortCanonical = SymIntern_intern(oSymIntern, "Mantle");
+   ASSURE(pcShortCanonical != NULL);
+   pcLong[0] = 'y';
+   ASSURE(SymIntern_intern(oSymIntern, pcLong) != pcLongCanonical);
+   pcLong[0] = 'x';
+   ASSURE(SymIntern_intern(oSymIntern, pcLong) == pcLongCanonical);
+   ASSURE(strlen(pcLongCanonical) == LONG_LENGTH);
+   ASSURE(SymIntern_intern(oSymIntern, "Mantle") == pcShortCanonical);
+   ASSURE(SymIntern_id(oSymIntern, pcShortCanonical) == 1);
+   ASSURE(SymIntern_getLength(oSymIntern) == 3);
+
+   SymIntern_free(oSymIntern);
+   free(pcLong);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the value of each binding, which points to an int, to the int
+   that pvExtra points to, and check that it is the binding's ID. */
+
+static void sumBinding(size_t uId, void *pvValue, void *pvExtra)
+{
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE((size_t)*(int*)pvValue == uId);
+   *(int*)pvExtra += *(int*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymIdMap functions. */
+
+static void testIdMap(void)
+{
+   enum {ID_COUNT = 100};
+
+   SymIdMap_T oSymIdMap;
+   int aiValues[ID_COUNT];
+   int iSum = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing maps keyed by ID.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymIdMap = SymIdMap_new();
+   ASSURE(oSymIdMap != NULL);
+   ASSURE(SymIdMap_getLength(oSymIdMap) == 0);
+   ASSURE(SymIdMap_get(oSymIdMap, 0) == NULL);
+   ASSURE(! SymIdMap_contains(oSymIdMap, 5));
+   ASSURE(SymIdMap_remove(oSymIdMap, 5) == NULL);
+   ASSURE(SymIdMap_replace(oSymIdMap, 5, aiValues) == NULL);
+
+   /* Every third ID, out of order, so that the map grows. */
+   for (i = ID_COUNT - 1; i >= 0; i--)
+   {
+      aiValues[i] = i;
+      if (i % 3 == 0)
+         ASSURE(SymIdMap_put(oSymIdMap, (size_t)i, &aiValues[i]));
+   }
+   ASSURE(! SymIdMap_put(oSymIdMap, 3, &aiValues[4]));
+   ASSURE(SymIdMap_getLength(oSymIdMap) == (ID_COUNT + 2) / 3);
+   for (i = 0; i < ID_COUNT; i++)
+   {
+      ASSURE(SymIdMap_contains(oSymIdMap, (size_t)i) == (i % 3 == 0));
+      ASSURE(SymIdMap_get(oSymIdMap, (size_t)i)
+         == (i % 3 == 0 ? &aiValues[i] : NULL));
+   }
+
+   SymIdMap_map(oSymIdMap, sumBinding, &iSum);
+   ASSURE(iSum == 1683);
+
+   /* A NULL value is a binding like any other. */
+   ASSURE(SymIdMap_replace(oSymIdMap, 3, NULL) == &aiValues[3]);
+   ASSURE(SymIdMap_contains(oSymIdMap, 3));
+   ASSURE(SymIdMap_get(oSymIdMap, 3) == NULL);
+   ASSURE(SymIdMap_remove(oSymIdMap, 3) == NULL);
+   ASSURE(! SymIdMap_contains(oSymIdMap, 3));
+   ASSURE(SymIdMap_remove(oSymIdMap, 6) == &aiValues[6]);
+   ASSURE(SymIdMap_getLength(oSymIdMap) == (ID_COUNT + 2) / 3 - 2);
+
+   ASSURE(SymIdMap_put(oSymIdMap, 5000, &aiValues[0]));
+   ASSURE(SymIdMap_get(oSymIdMap, 5000) == &aiValues[0]);
+   ASSURE(! SymIdMap_put(oSymIdMap, SYMINTERN_NONE, &aiValues[0]));
+
+   SymIdMap_free(oSymIdMap);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give TABLE_COUNT components a table each over the same iKeyCount
+   identifiers, once as SymTables keyed by string and once as SymIdMaps
+   keyed by the IDs of the interned identifiers. Write the heap used by
+   each arrangement, and the elapsed time per lookup of each, to
+   stdout. */
+
+static void testSharedKeys(int iKeyCount)
+{
+   enum {TABLE_COUNT = 4, MAX_STRING_LENGTH = 24};
+
+   SymTable_T aoTables[TABLE_COUNT];
+   SymIdMap_T aoMaps[TABLE_COUNT];
+   SymIntern_T oSymIntern;
+   char acString[MAX_STRING_LENGTH];
+   const char **ppcCanonical;
+   size_t uCount = (size_t)iKeyCount;
+   size_t uStringHeap;
+   size_t uIdHeap;
+   size_t uHeap;
+   size_t uId;
+   size_t i;
+   int iTable;
+   long long llStart;
+   long long llString;
+   long long llId;
+   size_t uFound = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing tables that share interned keys.\n");
+   printf("No output except heap use and elapsed time should appear "
+      "here:\n");
+   fflush(stdout);
+
+   ppcCanonical = (const char**)malloc(uCount * sizeof(char*) + 1);
+   ASSURE(ppcCanonical != NULL);
+   if (ppcCanonical == NULL) return;
+
+   uHeap = getHeapInUse();
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      aoTables[iTable] = SymTable_new();
+      ASSURE(aoTables[iTable] != NULL);
+      for (i = 0; i < uCount; i++)
+      {
+         sprintf(acString, "identifier_%d", (int)i);
+         ASSURE(SymTable_put(aoTables[iTable], acString, acString));
+      }
+   }
+   uStringHeap = getHeapInUse() - uHeap;
+
+   uHeap = getHeapInUse();
+   oSymIntern = SymIntern_new();
+   ASSURE(oSymIntern != NULL);
+   for (i = 0; i < uCount; i++)
+   {
+      sprintf(acString, "identifier_%d", (int)i);
+      ppcCanonical[i] = SymIntern_intern(oSymIntern, acString);
+      ASSURE(ppcCanonical[i] != NULL);
+   }
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      aoMaps[iTable] = SymIdMap_new();
+      ASSURE(aoMaps[iTable] != NULL);
+      for (i = 0; i < uCount; i++)
+         ASSURE(SymIdMap_put(aoMaps[iTable],
+            SymIntern_id(oSymIntern, ppcCanonical[i]), acString));
+   }
+   uIdHeap = getHeapInUse() - uHeap;
+
+   /* Each component looks up every identifier that it holds: by string
+      in the first arrangement, and by the ID of its canonical copy in
+      the second. */
+   llStart = getNanoseconds();
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+      for (i = 0; i < uCount; i++)
+         uFound += SymTable_get(aoTables[iTable], ppcCanonical[i])
+            != NULL;
+   llString = getNanoseconds() - llStart;
+
+   llStart = getNanoseconds();
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+      for (i = 0; i < uCount; i++)
+      {
+         uId = SymIntern_id(oSymIntern, ppcCanonical[i]);
+         uFound += SymIdMap_get(aoMaps[iTable], uId) != NULL;
+      }
+   llId = getNanoseconds() - llStart;
+   ASSURE(uFound == 2 * TABLE_COUNT * uCount);
+
+   if (uCount > 0)
+   {
+#ifdef HAVE_MALLINFO2
+      printf("Heap for %d tables of %d keys:  %lu bytes by string, "
+         "%lu bytes by ID\n", TABLE_COUNT, iKeyCount,
+         (unsigned long)uStringHeap, (unsigned long)uIdHeap);
+#endif
+      printf("Elapsed time per lookup:  %.1f ns by string, "
+         "%.1f ns by ID\n",
+         (double)llString / (double)(TABLE_COUNT * uCount),
+         (double)llId / (double)(TABLE_COUNT * uCount));
+      fflush(stdout);
+   }
+   (void)uStringHeap;
+   (void)uIdHeap;
+
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      SymTable_free(aoTables[iTable]);
+      SymIdMap_free(aoMaps[iTable]);
+   }
+   SymIntern_free(oSymIntern);
+   free(ppcCanonical);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymIntern and SymIdMap ADTs. As the first command-line
+   argument, argv[1], accept the number of keys that each table of the
+   timed test should hold. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "keycount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iKeyCount < 0)
+   {
+      fprintf(stderr, "keycount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testIntern();
+   testLongStrings();
+   testIdMap();
+   testSharedKeys(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
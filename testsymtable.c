@@ -3,7 +3,11 @@
 /* Author: Bob Dondero                                                */
 /*--------------------------------------------------------------------*/
 
+/* Request POSIX declarations, for clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
 #include "symtable.h"
+#include "symhash.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -14,6 +18,16 @@
 #include <sys/resource.h>
 #endif
 
+/* AddressSanitizer replaces malloc, so mallinfo2 does not see the
+   memory that it hands out. */
+#if defined(__GLIBC__) && !defined(S_SPLINT_S) \
+   && !defined(__SANITIZE_ADDRESS__)
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+#endif
+
 /*--------------------------------------------------------------------*/
 
 #define ASSURE(i) assure(i, __LINE__)
@@ -51,6 +65,36 @@ static void setCpuTimeLimit(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Return the number of bytes of heap memory in use, or 0 if the C
+   library cannot report it. */
+
+static size_t getHeapInUse(void)
+{
+#ifdef HAVE_MALLINFO2
+   struct mallinfo2 sInfo = mallinfo2();
+   return sInfo.uordblks + sInfo.hblkhd;
+#else
+   return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding whose key is pcKey and whose value is pvValue by
+   incrementing the size_t that pvExtra points to. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Write the binding whose key is pcKey and whose string value is
    pvValue using format string pvExtra. */
 
@@ -299,6 +343,90 @@ static void testKeyOwnership(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test SymTable_putBorrowed. The borrowed keys are on the stack, so
+   that a table that freed one would be caught by a memory checker, and
+   enough of them are added and removed to make a table grow and
+   shrink. */
+
+static void testKeyBorrowing(void)
+{
+   enum {KEY_COUNT = 300, KEY_SIZE = 32};
+
+   SymTable_T oSymTable;
+   char aacKeys[KEY_COUNT][KEY_SIZE];
+   char acRuth[] = "Ruth";
+   char acRuth2[] = "Ruth";
+   char acLong[] = "a borrowed key longer than any inline key";
+   char acRightField[] = "RightField";
+   char acValue[] = "value";
+   SymTable_Iter sIter;
+   size_t uCount;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing borrowed keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_putBorrowed(oSymTable, acRuth, acRightField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putBorrowed(oSymTable, acRuth2, acValue);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", acValue);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_putBorrowed(oSymTable, acLong, acValue);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, acRuth2) == acRightField);
+   ASSURE(SymTable_get(oSymTable,
+      "a borrowed key longer than any inline key") == acValue);
+   ASSURE(! SymTable_containsN(oSymTable, acLong, 10));
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "borrowed key number %d", i);
+      iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[i],
+         aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT + 2);
+
+   uCount = 0;
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+   {
+      if (strcmp(SymTable_iterKey(&sIter), "Ruth") != 0
+          && strcmp(SymTable_iterKey(&sIter), acLong) != 0)
+         ASSURE(!strcmp(SymTable_iterKey(&sIter),
+            (char*)SymTable_iterValue(&sIter)));
+      uCount++;
+   }
+   ASSURE(uCount == KEY_COUNT + 2);
+
+   /* Removing most of the keys makes the table shrink with the rest
+      still borrowed. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      if (i % 10 != 0)
+         ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == aacKeys[i]);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      ASSURE(SymTable_get(oSymTable, aacKeys[i])
+         == (i % 10 == 0 ? aacKeys[i] : NULL));
+   }
+
+   ASSURE(SymTable_remove(oSymTable, "Ruth") == acRightField);
+   ASSURE(! SymTable_contains(oSymTable, acRuth));
+   ASSURE(SymTable_get(oSymTable, acLong) == acValue);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the SymTable_remove() function. */
 
 static void testRemove(void)
@@ -382,6 +510,189 @@ static void testRemove(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test the SymTable_findOrInsert() function. */
+
+static void testFindOrInsert(void)
+{
+   SymTable_T oSymTable;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   enum {GROWN_COUNT = 5000, SHRUNK_COUNT = 4000};
+
+   char acKey[16];
+   void **ppvValue;
+   void **ppvKept;
+   char *pcValue;
+   int i;
+   int iInserted;
+   size_t uLength;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_findOrInsert() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Insert a new key; its value starts out NULL. */
+   ppvValue = SymTable_findOrInsert(oSymTable, acJeter, &iInserted);
+   ASSURE(ppvValue != NULL);
+   ASSURE(iInserted);
+   ASSURE((ppvValue != NULL) && (*ppvValue == NULL));
+   if (ppvValue != NULL) *ppvValue = acShortstop;
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   pcValue = (char*)SymTable_get(oSymTable, acJeter);
+   ASSURE(pcValue == acShortstop);
+
+   /* Find the existing key without inserting. */
+   ppvValue = SymTable_findOrInsert(oSymTable, "Jeter", &iInserted);
+   ASSURE(ppvValue != NULL);
+   ASSURE(! iInserted);
+   ASSURE((ppvValue != NULL) && (*ppvValue == acShortstop));
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   /* A binding added by findOrInsert blocks a later put. */
+   ppvValue = SymTable_findOrInsert(oSymTable, acMantle, &iInserted);
+   ASSURE(ppvValue != NULL);
+   ASSURE(iInserted);
+
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(! iSuccessful);
+
+   ASSURE(SymTable_contains(oSymTable, acMantle));
+   pcValue = (char*)SymTable_remove(oSymTable, acMantle);
+   ASSURE(pcValue == NULL);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   SymTable_free(oSymTable);
+
+   /* Removing SHRUNK_COUNT of GROWN_COUNT bindings starts a shrink of
+      a hash table. Finding every remaining key adds no binding, so
+      the address first returned for the last key must stay
+      valid. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < GROWN_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < SHRUNK_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+
+   sprintf(acKey, "%d", GROWN_COUNT - 1);
+   ppvKept = SymTable_findOrInsert(oSymTable, acKey, &iInserted);
+   ASSURE(ppvKept != NULL);
+   ASSURE(! iInserted);
+   for (i = SHRUNK_COUNT; i < GROWN_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ppvValue = SymTable_findOrInsert(oSymTable, acKey, &iInserted);
+      ASSURE(ppvValue != NULL);
+      ASSURE(! iInserted);
+   }
+   ppvValue = SymTable_findOrInsert(oSymTable, acKey, &iInserted);
+   ASSURE(ppvValue == ppvKept);
+   ASSURE(! iInserted);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_getBatch(), SymTable_putBatch() and
+   SymTable_removeBatch() functions, with batches longer than any
+   internal step. */
+
+static void testBatch(void)
+{
+   enum {BATCH_COUNT = 40};
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char aacKeys[BATCH_COUNT + 1][MAX_KEY_LENGTH];
+   const char *apcKeys[BATCH_COUNT + 1];
+   void *apvValues[BATCH_COUNT + 1];
+   void *apvResults[BATCH_COUNT + 1];
+   char acValues[BATCH_COUNT + 1];
+   size_t uAdded;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable batch functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i <= BATCH_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "key%d", i);
+      apcKeys[i] = aacKeys[i];
+      apvValues[i] = &acValues[i];
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty batch touches nothing. */
+   SymTable_getBatch(oSymTable, 0, NULL, NULL);
+   ASSURE(SymTable_putBatch(oSymTable, 0, NULL, NULL) == 0);
+   SymTable_removeBatch(oSymTable, 0, NULL, NULL);
+
+   /* Nothing is found in an empty table. */
+   SymTable_getBatch(oSymTable, BATCH_COUNT, apcKeys, apvResults);
+   for (i = 0; i < BATCH_COUNT; i++)
+      ASSURE(apvResults[i] == NULL);
+
+   /* Key 7 appears twice; only its first binding is added. */
+   apcKeys[BATCH_COUNT - 1] = aacKeys[7];
+   uAdded = SymTable_putBatch(oSymTable, BATCH_COUNT, apcKeys,
+      apvValues);
+   ASSURE(uAdded == BATCH_COUNT - 1);
+   ASSURE(SymTable_getLength(oSymTable) == BATCH_COUNT - 1);
+   ASSURE(SymTable_get(oSymTable, "key7") == &acValues[7]);
+
+   /* Key BATCH_COUNT - 1 was never put, and key BATCH_COUNT is not
+      in the table either. */
+   apcKeys[BATCH_COUNT - 1] = aacKeys[BATCH_COUNT - 1];
+   SymTable_getBatch(oSymTable, BATCH_COUNT + 1, apcKeys, apvResults);
+   for (i = 0; i < BATCH_COUNT - 1; i++)
+      ASSURE(apvResults[i] == &acValues[i]);
+   ASSURE(apvResults[BATCH_COUNT - 1] == NULL);
+   ASSURE(apvResults[BATCH_COUNT] == NULL);
+
+   /* Removing key 3 twice in one batch finds it only the first
+      time. */
+   apcKeys[BATCH_COUNT] = aacKeys[3];
+   SymTable_removeBatch(oSymTable, BATCH_COUNT + 1, apcKeys,
+      apvResults);
+   for (i = 0; i < BATCH_COUNT - 1; i++)
+      ASSURE(apvResults[i] == &acValues[i]);
+   ASSURE(apvResults[BATCH_COUNT - 1] == NULL);
+   ASSURE(apvResults[BATCH_COUNT] == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the SymTable_map() function. */
 
 static void testMap(void)
@@ -430,6 +741,108 @@ static void testMap(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Iterate over oSymTable, each of whose bindings has a key that is a
+   number below uSeenCount and a value that points to the element of
+   acSeen indexed by that number. Return the number of bindings
+   visited, checking that none is visited twice. */
+
+static size_t iterateOnce(SymTable_T oSymTable, char acSeen[],
+   size_t uSeenCount)
+{
+   SymTable_Iter sIter;
+   size_t uCount = 0;
+   size_t i;
+   int iKey;
+
+   for (i = 0; i < uSeenCount; i++)
+      acSeen[i] = 0;
+
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+   {
+      ASSURE(sscanf(SymTable_iterKey(&sIter), "%d", &iKey) == 1);
+      ASSURE(iKey >= 0 && (size_t)iKey < uSeenCount);
+      ASSURE(SymTable_iterValue(&sIter) == &acSeen[iKey]);
+      ASSURE(acSeen[iKey] == 0);
+      acSeen[iKey] = 1;
+      uCount++;
+   }
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_Iter functions: iterations of an empty table, of
+   a full one, of one that is shrinking, and iterations ended
+   early. */
+
+static void testIter(void)
+{
+   enum {BINDING_COUNT = 520};
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   char acKey[MAX_KEY_LENGTH];
+   char acSeen[BINDING_COUNT];
+   size_t uCount;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_Iter functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   SymTable_iterBegin(oSymTable, &sIter);
+   ASSURE(SymTable_iterDone(&sIter));
+   SymTable_iterEnd(&sIter);
+
+   /* BINDING_COUNT is just past the point where the hash tables grow,
+      so they are still growing when the iteration begins. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &acSeen[i]);
+      ASSURE(iSuccessful);
+   }
+   uCount = iterateOnce(oSymTable, acSeen, BINDING_COUNT);
+   ASSURE(uCount == BINDING_COUNT);
+
+   /* Ending an iteration early must leave the table usable, and
+      ending it again must do nothing. */
+   uCount = 0;
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+   {
+      if (++uCount == 3)
+      {
+         SymTable_iterEnd(&sIter);
+         break;
+      }
+   }
+   ASSURE(SymTable_iterDone(&sIter));
+   SymTable_iterEnd(&sIter);
+
+   /* Removing all but a fifth of the bindings is just enough for the
+      hash tables to be shrinking when the iteration begins. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      if (i % 5 == 0) continue;
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &acSeen[i]);
+   }
+   uCount = iterateOnce(oSymTable, acSeen, BINDING_COUNT);
+   ASSURE(uCount == BINDING_COUNT / 5);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(acSeen[i] == (i % 5 == 0));
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test a SymTable object that contains no bindings. */
 
 static void testEmptyTable(void)
@@ -571,6 +984,181 @@ static void testNullValue(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test keys of every length up to MAX_KEY_LENGTH, in pairs that
+   differ only in their last character, so that keys on either side
+   of any length at which an implementation changes how it stores
+   them are told apart. */
+
+static void testKeyLengths(void)
+{
+   enum {MAX_KEY_LENGTH = 40};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH + 1];
+   char acValues[2][MAX_KEY_LENGTH + 1];
+   SymTable_Iter sIter;
+   size_t uLength;
+   size_t uCount;
+   int iSuccessful;
+   int iLast;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing keys of many lengths.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (uLength = 1; uLength <= MAX_KEY_LENGTH; uLength++)
+   {
+      memset(acKey, 'k', uLength - 1);
+      acKey[uLength] = '\0';
+      for (iLast = 0; iLast < 2; iLast++)
+      {
+         acKey[uLength - 1] = (char)('x' + iLast);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+            &acValues[iLast][uLength]);
+         ASSURE(iSuccessful);
+      }
+   }
+
+   for (uLength = 1; uLength <= MAX_KEY_LENGTH; uLength++)
+   {
+      memset(acKey, 'k', uLength - 1);
+      acKey[uLength] = '\0';
+      for (iLast = 0; iLast < 2; iLast++)
+      {
+         acKey[uLength - 1] = (char)('x' + iLast);
+         ASSURE(SymTable_get(oSymTable, acKey)
+            == &acValues[iLast][uLength]);
+      }
+      acKey[uLength - 1] = 'k';
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+
+   uCount = 0;
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+   {
+      uLength = strlen(SymTable_iterKey(&sIter));
+      iLast = SymTable_iterKey(&sIter)[uLength - 1] - 'x';
+      ASSURE(iLast == 0 || iLast == 1);
+      ASSURE(SymTable_iterValue(&sIter) == &acValues[iLast][uLength]);
+      uCount++;
+   }
+   ASSURE(uCount == 2 * MAX_KEY_LENGTH);
+
+   for (uLength = 1; uLength <= MAX_KEY_LENGTH; uLength++)
+   {
+      memset(acKey, 'k', uLength - 1);
+      acKey[uLength - 1] = 'x';
+      acKey[uLength] = '\0';
+      ASSURE(SymTable_remove(oSymTable, acKey)
+         == &acValues[0][uLength]);
+      ASSURE(SymTable_get(oSymTable, acKey) == NULL);
+      acKey[uLength - 1] = 'y';
+      ASSURE(SymTable_get(oSymTable, acKey) == &acValues[1][uLength]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == MAX_KEY_LENGTH);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that take a key as a length and characters that
+   need not be followed by '\0', looking keys up where they lie in a
+   larger buffer. */
+
+static void testKeySlices(void)
+{
+   /* "river" appears twice, and the long slices, which start at
+      acText, are longer than any key that an implementation might
+      store inline. */
+   const char acText[] =
+      "Mississippi river and Missouri river delta, downstream";
+   enum {LONG_LENGTH = 36};
+
+   SymTable_T oSymTable;
+   char acKey[LONG_LENGTH + 2];
+   char acMiss[] = "Miss";
+   char acMississippi[] = "Mississippi";
+   char acRiver[] = "river";
+   char acLong[] = "long";
+   char acLonger[] = "longer";
+   void **ppvValue;
+   int iInserted;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing keys given by length.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Keys that are prefixes of each other are different keys. */
+   iSuccessful = SymTable_putN(oSymTable, acText, 4, acMiss);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acText, 11, acMississippi);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acText, 4, acMississippi);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "Miss") == acMiss);
+   ASSURE(SymTable_get(oSymTable, "Mississippi") == acMississippi);
+   ASSURE(SymTable_getN(oSymTable, acText, 11) == acMississippi);
+   ASSURE(! SymTable_containsN(oSymTable, acText, 3));
+   ASSURE(! SymTable_containsN(oSymTable, acText, 5));
+   ASSURE(! SymTable_containsN(oSymTable, acText, 0));
+
+   /* The same characters at another place are the same key, and keys
+      added without a length are found by length. */
+   iSuccessful = SymTable_putN(oSymTable, acText + 12, 5, acRiver);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getN(oSymTable, acText + 31, 5) == acRiver);
+   ASSURE(SymTable_get(oSymTable, "river") == acRiver);
+   iSuccessful = SymTable_put(oSymTable, "delta", acText);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getN(oSymTable, acText + 37, 5) == acText);
+
+   /* Long keys that differ only in length are different keys. */
+   iSuccessful = SymTable_putN(oSymTable, acText, LONG_LENGTH, acLong);
+   ASSURE(iSuccessful);
+   ppvValue = SymTable_findOrInsertN(oSymTable, acText,
+      LONG_LENGTH + 1, &iInserted);
+   ASSURE(ppvValue != NULL);
+   ASSURE(iInserted);
+   *ppvValue = acLonger;
+   ppvValue = SymTable_findOrInsertN(oSymTable, acText, LONG_LENGTH,
+      &iInserted);
+   ASSURE(ppvValue != NULL);
+   ASSURE(! iInserted);
+   ASSURE(*ppvValue == acLong);
+   memcpy(acKey, acText, LONG_LENGTH + 1);
+   acKey[LONG_LENGTH + 1] = '\0';
+   ASSURE(SymTable_get(oSymTable, acKey) == acLonger);
+   ASSURE(! SymTable_containsN(oSymTable, acText, LONG_LENGTH - 1));
+   ASSURE(SymTable_getLength(oSymTable) == 6);
+
+   ASSURE(SymTable_replaceN(oSymTable, acText, LONG_LENGTH, acLonger)
+      == acLong);
+   ASSURE(SymTable_replaceN(oSymTable, acText, 2, acLong) == NULL);
+   ASSURE(SymTable_getN(oSymTable, acText, LONG_LENGTH) == acLonger);
+
+   ASSURE(SymTable_removeN(oSymTable, acText, LONG_LENGTH) == acLonger);
+   ASSURE(! SymTable_containsN(oSymTable, acText, LONG_LENGTH));
+   ASSURE(SymTable_contains(oSymTable, acKey));
+   ASSURE(SymTable_removeN(oSymTable, acText, 4) == acMiss);
+   ASSURE(SymTable_get(oSymTable, "Mississippi") == acMississippi);
+   ASSURE(SymTable_removeN(oSymTable, acText, 4) == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to contain long keys. */
 
 static void testLongKey(void)
@@ -635,19 +1223,202 @@ static void testLongKey(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of SymTable object to have values that are
-   other SymTable objects. */
+/* Test SymTable_get and SymTable_remove on a SymTable object that
+   reorders its bindings under each policy of SymTable_setReorder. */
 
-static void testTableOfTables(void)
+static void testReorder(void)
 {
-   SymTable_T oSymTable;
-   SymTable_T oSymTable1;
-   SymTable_T oSymTable2;
-   SymTable_T oSymTableRet;
-   char acShortstop[] = "Shortstop";
-   char acCenterField[] = "CenterField";
-   char *pcValue;
-   int iSuccessful;
+   enum {KEY_COUNT = 50, MAX_KEY_LENGTH = 12, ROUND_COUNT = 3};
+
+   static const int aiPolicies[] = {SYMTABLE_REORDER_NONE,
+      SYMTABLE_REORDER_MOVE_TO_FRONT, SYMTABLE_REORDER_TRANSPOSE};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[KEY_COUNT];
+   size_t uPolicy;
+   size_t uVisited;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that reorders its bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (uPolicy = 0;
+        uPolicy < sizeof(aiPolicies) / sizeof(aiPolicies[0]);
+        uPolicy++)
+   {
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      SymTable_setReorder(oSymTable, aiPolicies[uPolicy]);
+
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         aiValues[i] = i;
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_put(oSymTable, acKey, &aiValues[i]));
+      }
+
+      /* Look up the first, last and middle keys repeatedly, and every
+         key once per round, so that bindings move in all directions.
+         */
+      for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+      {
+         ASSURE(SymTable_get(oSymTable, "0") == &aiValues[0]);
+         ASSURE(SymTable_get(oSymTable, "49") == &aiValues[49]);
+         ASSURE(SymTable_get(oSymTable, "25") == &aiValues[25]);
+         ASSURE(SymTable_get(oSymTable, "25") == &aiValues[25]);
+         ASSURE(SymTable_get(oSymTable, "missing") == NULL);
+         for (i = KEY_COUNT - 1; i >= 0; i--)
+         {
+            sprintf(acKey, "%d", i);
+            ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+         }
+      }
+      ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+      uVisited = 0;
+      SYMTABLE_FOREACH(oSymTable, &sIter)
+      {
+         ASSURE(*(int*)SymTable_iterValue(&sIter)
+            == atoi(SymTable_iterKey(&sIter)));
+         uVisited++;
+      }
+      ASSURE(uVisited == KEY_COUNT);
+
+      /* Reordering leaves the bindings intact for removal. */
+      for (i = 0; i < KEY_COUNT; i += 2)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      }
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey)
+            == (i % 2 == 0 ? NULL : &aiValues[i]));
+      }
+      ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT / 2);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a SymTable object stays consistent while bindings with
+   keys of many different lengths are repeatedly removed and put, so
+   that memory released by removal is reused. */
+
+static void testChurn(void)
+{
+   enum {KEY_COUNT = 600};
+   enum {MAX_KEY_LENGTH = 400};
+   enum {ROUND_COUNT = 3};
+   enum {GROWN_COUNT = 5000, SHRUNK_COUNT = 4000};
+   enum {LONG_PREFIX_LENGTH = 300};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH + 1];
+   char acValue[] = "value";
+   char *pcValue;
+   int i;
+   int iPrefix;
+   int iRound;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object under repeated removal and\n");
+   printf("insertion.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Key i consists of a prefix of up to MAX_KEY_LENGTH - 8 copies
+      of a letter followed by the digits of i. */
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = iRound % 2; i < KEY_COUNT; i += 2)
+      {
+         iPrefix = i % (MAX_KEY_LENGTH - 8);
+         memset(acKey, 'a' + iRound, (size_t)iPrefix);
+         sprintf(acKey + iPrefix, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+         ASSURE(iSuccessful);
+      }
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == KEY_COUNT / 2);
+
+      for (i = iRound % 2; i < KEY_COUNT; i += 2)
+      {
+         iPrefix = i % (MAX_KEY_LENGTH - 8);
+         memset(acKey, 'a' + iRound, (size_t)iPrefix);
+         sprintf(acKey + iPrefix, "%d", i);
+         pcValue = (char*)SymTable_get(oSymTable, acKey);
+         ASSURE(pcValue == acValue);
+         pcValue = (char*)SymTable_remove(oSymTable, acKey);
+         ASSURE(pcValue == acValue);
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+      }
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == 0);
+   }
+
+   SymTable_free(oSymTable);
+
+   /* Removing SHRUNK_COUNT of GROWN_COUNT bindings starts a shrink of
+      a hash table. A long key put and removed while the shrink is in
+      progress must be released into the memory it came from, or
+      SymTable_free touches it again. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < GROWN_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < SHRUNK_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+
+   memset(acKey, 'b', LONG_PREFIX_LENGTH);
+   strcpy(acKey + LONG_PREFIX_LENGTH, "new");
+   iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_remove(oSymTable, acKey);
+   ASSURE(pcValue == acValue);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == GROWN_COUNT - SHRUNK_COUNT);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of SymTable object to have values that are
+   other SymTable objects. */
+
+static void testTableOfTables(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   SymTable_T oSymTableRet;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "CenterField";
+   char *pcValue;
+   int iSuccessful;
 
    printf("------------------------------------------------------\n");
    printf("Testing a SymTable object that contains other\n");
@@ -695,13 +1466,27 @@ static void testTableOfTables(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to handle collisions.  This
-   test assumes that a SymTable object is implemented as a hash table,
-   that there are 509 buckets in the hash table, and that the
-   implementation uses the hash function provided in the assignment
-   specification. */
+/* Return 0, regardless of pcKey and uLength, so that every key
+   collides with every other. */
+
+static size_t hashToZero(const char *pcKey, size_t uLength)
+{
+   assert(pcKey != NULL);
+   (void)uLength;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object that hashes keys with pfHash
+   to handle collisions.  With SymHash_compat, the hash function
+   provided in the assignment specification, the keys below all
+   collide in a hash table of 512 buckets, whose bucket is the hash
+   masked with 511; with hashToZero, they collide in any hash
+   table. */
 
-static void testCollisions(void)
+static void testCollisions(
+   size_t (*pfHash)(const char *pcKey, size_t uLength))
 {
    SymTable_T oSymTable;
    int iSuccessful;
@@ -713,61 +1498,60 @@ static void testCollisions(void)
 
    printf("------------------------------------------------------\n");
    printf("Testing the collision handling of a SymTable object\n");
-   printf("assuming a hash table implementation, and assuming that\n");
-   printf("the implementation uses the hash function from the\n");
-   printf("assignment specification.\n");
+   printf("with a client-supplied hash function.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
-   oSymTable = SymTable_new();
+   oSymTable = SymTable_newWithHash(pfHash);
    ASSURE(oSymTable != NULL);
 
-   /* Note that strings "250", "469", "947", "1303", and "2016" hash
-      to the same bucket -- bucket 123. */
+   /* Note that with SymHash_compat, strings "250", "371", "492",
+      "10051", and "10172" have hashes whose low 9 bits are equal, so
+      they share a bucket of 512 -- bucket 109. */
 
    iSuccessful = SymTable_put(oSymTable, "250", acCenterField);
    ASSURE(iSuccessful);
 
-   iSuccessful = SymTable_put(oSymTable, "469", acCatcher);
+   iSuccessful = SymTable_put(oSymTable, "371", acCatcher);
    ASSURE(iSuccessful);
 
-   iSuccessful = SymTable_put(oSymTable, "947", acFirstBase);
+   iSuccessful = SymTable_put(oSymTable, "492", acFirstBase);
    ASSURE(iSuccessful);
 
-   iSuccessful = SymTable_put(oSymTable, "1303", acRightField);
+   iSuccessful = SymTable_put(oSymTable, "10051", acRightField);
    ASSURE(iSuccessful);
 
-   iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
+   iSuccessful = SymTable_put(oSymTable, "10172", acRightField);
    ASSURE(iSuccessful);
 
    pcValue = SymTable_get(oSymTable, "250");
    ASSURE(pcValue == acCenterField);
 
-   pcValue = SymTable_get(oSymTable, "469");
+   pcValue = SymTable_get(oSymTable, "371");
    ASSURE(pcValue == acCatcher);
 
-   pcValue = SymTable_get(oSymTable, "947");
+   pcValue = SymTable_get(oSymTable, "492");
    ASSURE(pcValue == acFirstBase);
 
-   pcValue = SymTable_get(oSymTable, "1303");
+   pcValue = SymTable_get(oSymTable, "10051");
    ASSURE(pcValue == acRightField);
 
-   pcValue = SymTable_get(oSymTable, "2016");
+   pcValue = SymTable_get(oSymTable, "10172");
    ASSURE(pcValue == acRightField);
 
-   pcValue = SymTable_remove(oSymTable, "947");
+   pcValue = SymTable_remove(oSymTable, "492");
    ASSURE(pcValue == acFirstBase);
 
-   pcValue = SymTable_remove(oSymTable, "2016");
+   pcValue = SymTable_remove(oSymTable, "10172");
    ASSURE(pcValue == acRightField);
 
    pcValue = SymTable_remove(oSymTable, "250");
    ASSURE(pcValue == acCenterField);
 
-   pcValue = SymTable_get(oSymTable, "469");
+   pcValue = SymTable_get(oSymTable, "371");
    ASSURE(pcValue == acCatcher);
 
-   pcValue = SymTable_get(oSymTable, "1303");
+   pcValue = SymTable_get(oSymTable, "10051");
    ASSURE(pcValue == acRightField);
 
    SymTable_free(oSymTable);
@@ -780,7 +1564,8 @@ static void testCollisions(void)
 
 static void testLargeTable(int iBindingCount)
 {
-   enum {MAX_KEY_LENGTH = 10};
+   enum {MAX_KEY_LENGTH = 12};
+   enum {FIRST_CHECKPOINT = 1024};
 
    SymTable_T oSymTable;
    SymTable_T oSymTableSmall;
@@ -790,7 +1575,10 @@ static void testLargeTable(int iBindingCount)
    int iSmall;
    int iLarge;
    int iSuccessful;
+   int iCheckpoint;
+   int iSegmentStart;
    clock_t iInitialClock;
+   clock_t iSegmentClock;
    clock_t iFinalClock;
    size_t uLength = 0;
    size_t uLength2;
@@ -816,7 +1604,13 @@ static void testLargeTable(int iBindingCount)
    ASSURE(oSymTable != NULL);
 
    /* Put iBindingCount new bindings into oSymTable.  Each binding's
-      key and value contain the same characters. */
+      key and value contain the same characters.  Each time the
+      number of bindings doubles, write the mean CPU time per put
+      over the last doubling; it should stay roughly flat as the
+      table grows. */
+   iCheckpoint = FIRST_CHECKPOINT;
+   iSegmentStart = 0;
+   iSegmentClock = clock();
    for (i = 0; i < iBindingCount; i++)
    {
       sprintf(acKey, "%d", i);
@@ -827,6 +1621,17 @@ static void testLargeTable(int iBindingCount)
       ASSURE(iSuccessful);
       uLength = SymTable_getLength(oSymTable);
       ASSURE(uLength == (size_t)(i+1));
+      if (i + 1 == iCheckpoint)
+      {
+         printf("CPU time per put (%d to %d bindings):  %f us\n",
+            iSegmentStart, iCheckpoint,
+            ((double)(clock() - iSegmentClock)) * 1000000.0
+               / CLOCKS_PER_SEC / (iCheckpoint - iSegmentStart));
+         fflush(stdout);
+         iSegmentStart = iCheckpoint;
+         iSegmentClock = clock();
+         if (iCheckpoint <= iBindingCount / 2) iCheckpoint *= 2;
+      }
    }
 
    /* Get each binding's value, and make sure that it contains
@@ -916,6 +1721,797 @@ static void testLargeTable(int iBindingCount)
 
 /*--------------------------------------------------------------------*/
 
+/* Test that a SymTable object that grows to iBindingCount bindings
+   and is then drained gives back its memory, and that SymTable_map
+   no longer pays for the table's former size. Write the heap memory
+   in use and the CPU time of SymTable_map to stdout. */
+
+static void testShrink(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEPT_COUNT = 10};
+   enum {MIN_CHECKED_COUNT = 10000};
+   enum {MAP_REPETITIONS = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   char *pcValue;
+   int i;
+   int iFirstKept;
+   int iSuccessful;
+   size_t uCount;
+   size_t uInitialHeap;
+   size_t uFullHeap;
+   size_t uDrainedHeap;
+   clock_t iInitialClock;
+   clock_t iFullMapClocks;
+   clock_t iDrainedMapClocks;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that grows and then drains.\n");
+   printf("No output except memory use and CPU time consumed should\n");
+   printf("appear here:\n");
+   fflush(stdout);
+
+   uInitialHeap = getHeapInUse();
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+   }
+
+   uFullHeap = getHeapInUse();
+   iInitialClock = clock();
+   for (i = 0; i < MAP_REPETITIONS; i++)
+   {
+      uCount = 0;
+      SymTable_map(oSymTable, countBinding, &uCount);
+      ASSURE(uCount == (size_t)iBindingCount);
+   }
+   iFullMapClocks = clock() - iInitialClock;
+
+   /* Remove all but the last KEPT_COUNT bindings. */
+   iFirstKept = iBindingCount - KEPT_COUNT;
+   if (iFirstKept < 0) iFirstKept = 0;
+   for (i = 0; i < iFirstKept; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+
+   uDrainedHeap = getHeapInUse();
+   iInitialClock = clock();
+   for (i = 0; i < MAP_REPETITIONS; i++)
+   {
+      uCount = 0;
+      SymTable_map(oSymTable, countBinding, &uCount);
+      ASSURE(uCount == SymTable_getLength(oSymTable));
+   }
+   iDrainedMapClocks = clock() - iInitialClock;
+
+   /* The remaining bindings must have survived the shrinking. */
+   for (i = iFirstKept; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+
+   printf("Heap in use (%d bindings, drained to %d):  %lu, %lu bytes\n",
+      iBindingCount, KEPT_COUNT,
+      (unsigned long)(uFullHeap - uInitialHeap),
+      (unsigned long)(uDrainedHeap - uInitialHeap));
+   printf("CPU time of map (%d bindings, drained to %d):  %f, %f "
+      "seconds\n", iBindingCount, KEPT_COUNT,
+      ((double)iFullMapClocks) / CLOCKS_PER_SEC,
+      ((double)iDrainedMapClocks) / CLOCKS_PER_SEC);
+   fflush(stdout);
+
+   if (iBindingCount >= MIN_CHECKED_COUNT)
+   {
+      ASSURE(iDrainedMapClocks <= iFullMapClocks);
+#ifdef HAVE_MALLINFO2
+      ASSURE(uDrainedHeap - uInitialHeap
+         < (uFullHeap - uInitialHeap) / 8);
+#endif
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a SymTable object, timing each put
+   separately with the monotonic clock. Write a histogram of the
+   elapsed time per put, and the worst single put, to stdout. No put
+   should take much longer than the rest, even when it crosses a
+   resize threshold. */
+
+static void testPutLatency(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {HISTOGRAM_SIZE = 32};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   long alHistogram[HISTOGRAM_SIZE];
+   int i;
+   int iBucket;
+   int iSuccessful;
+   long long llStart;
+   long long llElapsed;
+   long long llWorst = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the latency of individual puts.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   for (iBucket = 0; iBucket < HISTOGRAM_SIZE; iBucket++)
+      alHistogram[iBucket] = 0;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      llStart = getNanoseconds();
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      llElapsed = getNanoseconds() - llStart;
+      ASSURE(iSuccessful);
+
+      if (llElapsed > llWorst) llWorst = llElapsed;
+
+      /* Histogram bucket b counts puts that took at least 2^(b-1)
+         nanoseconds but less than 2^b. */
+      for (iBucket = 0; iBucket < HISTOGRAM_SIZE - 1
+           && llElapsed >= (1LL << iBucket); iBucket++);
+      alHistogram[iBucket]++;
+   }
+
+   printf("Elapsed time per put (%d bindings):\n", iBindingCount);
+   for (iBucket = 1; iBucket < HISTOGRAM_SIZE; iBucket++)
+   {
+      if (alHistogram[iBucket] == 0) continue;
+      printf("   %lld to %lld ns:  %ld puts\n",
+         1LL << (iBucket - 1), (1LL << iBucket) - 1,
+         alHistogram[iBucket]);
+   }
+   printf("Worst single put:  %lld ns\n", llWorst);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up keys with a skewed distribution in a small SymTable object,
+   without reordering and under each policy of SymTable_setReorder.
+   Most lookups are for the few keys that were put first, which a list
+   keeps at its end. Write the elapsed time per lookup to stdout. */
+
+static void testSkewedLookups(int iLookupCount)
+{
+   enum {KEY_COUNT = 200, HOT_KEY_COUNT = 4, MAX_KEY_LENGTH = 12};
+
+   static const int aiPolicies[] = {SYMTABLE_REORDER_NONE,
+      SYMTABLE_REORDER_MOVE_TO_FRONT, SYMTABLE_REORDER_TRANSPOSE};
+   static const char *const apcNames[] = {"no reordering",
+      "move-to-front", "transpose"};
+
+   SymTable_T oSymTable;
+   char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   size_t uPolicy;
+   long long llStart;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing skewed lookups in a small SymTable object.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   if (iLookupCount == 0) return;
+
+   for (i = 0; i < KEY_COUNT; i++)
+      sprintf(aacKeys[i], "%d", i);
+
+   for (uPolicy = 0;
+        uPolicy < sizeof(aiPolicies) / sizeof(aiPolicies[0]);
+        uPolicy++)
+   {
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      SymTable_setReorder(oSymTable, aiPolicies[uPolicy]);
+      for (i = 0; i < KEY_COUNT; i++)
+         ASSURE(SymTable_put(oSymTable, aacKeys[i], acValue));
+
+      /* Nine lookups in ten are for one of the hot keys. */
+      llStart = getNanoseconds();
+      for (i = 0; i < iLookupCount; i++)
+      {
+         if (i % 10 != 0)
+            ASSURE(SymTable_get(oSymTable, aacKeys[i % HOT_KEY_COUNT])
+               == acValue);
+         else
+            ASSURE(SymTable_get(oSymTable,
+               aacKeys[(i / 10) % KEY_COUNT]) == acValue);
+      }
+      printf("Elapsed time per lookup, %s:  %.1f ns\n",
+         apcNames[uPolicy],
+         (double)(getNanoseconds() - llStart) / (double)iLookupCount);
+      fflush(stdout);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build TABLE_COUNT small SymTable objects of KEY_COUNT bindings each,
+   and look up every key of every table iLookupCount / KEY_COUNT times
+   in all. Write the heap used per table and the elapsed time per
+   lookup to stdout. */
+
+static void testSmallTables(int iLookupCount)
+{
+   enum {TABLE_COUNT = 1000, KEY_COUNT = 8, MAX_KEY_LENGTH = 12};
+
+   SymTable_T *poTables;
+   char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   size_t uHeap;
+   long long llStart;
+   int iTable;
+   int iKey;
+   int iRound;
+   int iRoundCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing many small SymTable objects.\n");
+   printf("No output except memory use and elapsed time should "
+      "appear here:\n");
+   fflush(stdout);
+
+   poTables = (SymTable_T*)malloc(TABLE_COUNT * sizeof(SymTable_T));
+   ASSURE(poTables != NULL);
+   if (poTables == NULL) return;
+
+   for (iKey = 0; iKey < KEY_COUNT; iKey++)
+      sprintf(aacKeys[iKey], "local%d", iKey);
+
+   uHeap = getHeapInUse();
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      poTables[iTable] = SymTable_new();
+      ASSURE(poTables[iTable] != NULL);
+      for (iKey = 0; iKey < KEY_COUNT; iKey++)
+         ASSURE(SymTable_put(poTables[iTable], aacKeys[iKey],
+            acValue));
+   }
+#ifdef HAVE_MALLINFO2
+   printf("Heap in use per table (%d bindings):  %lu bytes\n",
+      KEY_COUNT,
+      (unsigned long)((getHeapInUse() - uHeap) / TABLE_COUNT));
+#endif
+   (void)uHeap;
+
+   iRoundCount = iLookupCount / (TABLE_COUNT * KEY_COUNT) + 1;
+   llStart = getNanoseconds();
+   for (iRound = 0; iRound < iRoundCount; iRound++)
+      for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+         for (iKey = 0; iKey < KEY_COUNT; iKey++)
+            ASSURE(SymTable_get(poTables[iTable], aacKeys[iKey])
+               == acValue);
+   printf("Elapsed time per lookup (%d bindings):  %.1f ns\n",
+      KEY_COUNT, (double)(getNanoseconds() - llStart)
+         / ((double)iRoundCount * TABLE_COUNT * KEY_COUNT));
+   fflush(stdout);
+
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+      SymTable_free(poTables[iTable]);
+   free(poTables);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build a SymTable object of iBindingCount bindings and look up each
+   of its keys, then as many absent keys, then the absent keys again
+   after half of the bindings are removed. Write the elapsed time per
+   lookup of each to stdout. */
+
+static void testMissThroughput(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   char *pcMisses;
+   char acValue[] = "value";
+   long long llStart;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing lookups of absent keys.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   if (iBindingCount == 0) return;
+
+   pcKeys = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH);
+   pcMisses = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH);
+   ASSURE(pcKeys != NULL && pcMisses != NULL);
+   if (pcKeys == NULL || pcMisses == NULL)
+   {
+      free(pcKeys);
+      free(pcMisses);
+      return;
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH, "%d", i);
+      sprintf(pcMisses + (size_t)i * MAX_KEY_LENGTH, "miss%d", i);
+      ASSURE(SymTable_put(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH, acValue));
+   }
+
+   llStart = getNanoseconds();
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTable_get(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH) == acValue);
+   printf("Elapsed time per lookup, present keys:  %.1f ns\n",
+      (double)(getNanoseconds() - llStart) / (double)iBindingCount);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(! SymTable_contains(oSymTable,
+         pcMisses + (size_t)i * MAX_KEY_LENGTH));
+   printf("Elapsed time per lookup, absent keys:  %.1f ns\n",
+      (double)(getNanoseconds() - llStart) / (double)iBindingCount);
+
+   /* Removing every other key leaves the table half full, which
+      tables that mark removed slots must still probe past. */
+   for (i = 0; i < iBindingCount; i += 2)
+      ASSURE(SymTable_remove(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH) == acValue);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(! SymTable_contains(oSymTable,
+         pcMisses + (size_t)i * MAX_KEY_LENGTH));
+   printf("Elapsed time per lookup, absent keys after removals:  "
+      "%.1f ns\n",
+      (double)(getNanoseconds() - llStart) / (double)iBindingCount);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(pcKeys);
+   free(pcMisses);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build a SymTable object of iBindingCount namespaced identifiers,
+   such as "org::project3::module17::Class5::method2", which share
+   long prefixes, and look up each of them. Write the heap used per
+   binding and the elapsed time per lookup to stdout. */
+
+static void testNamespacedKeys(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 64};
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   char acValue[] = "value";
+   size_t uHeap;
+   long long llStart;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing namespaced keys.\n");
+   printf("No output except memory use and elapsed time should "
+      "appear here:\n");
+   fflush(stdout);
+
+   if (iBindingCount == 0) return;
+
+   pcKeys = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH);
+   ASSURE(pcKeys != NULL);
+   if (pcKeys == NULL) return;
+
+   for (i = 0; i < iBindingCount; i++)
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH,
+         "org::project%d::module%d::Class%d::method%d", i % 4,
+         i / 4 % 32, i / 128 % 64, i / 8192);
+
+   uHeap = getHeapInUse();
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTable_put(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH, acValue));
+#ifdef HAVE_MALLINFO2
+   printf("Heap in use per binding:  %.1f bytes\n",
+      (double)(getHeapInUse() - uHeap) / (double)iBindingCount);
+#endif
+   (void)uHeap;
+
+   llStart = getNanoseconds();
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTable_get(oSymTable,
+         pcKeys + (size_t)i * MAX_KEY_LENGTH) == acValue);
+   printf("Elapsed time per lookup:  %.1f ns\n",
+      (double)(getNanoseconds() - llStart) / (double)iBindingCount);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put, get and remove iBindingCount keys in a pseudo-random order,
+   once one key per call and once BATCH_SIZE keys per call of the
+   batch functions. Write the elapsed time per key of each to
+   stdout. */
+
+static void testBatchThroughput(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {BATCH_SIZE = 1024};
+
+   SymTable_T oScalarTable;
+   SymTable_T oBatchTable;
+   char *pcKeys;
+   const char **ppcKeys;
+   void **ppvResults;
+   char acValue[] = "value";
+   void *apvValues[BATCH_SIZE];
+   const char *pcSwap;
+   unsigned long uState = 1;
+   size_t uCount = (size_t)iBindingCount;
+   size_t uFirst;
+   size_t uStep;
+   size_t uAdded = 0;
+   size_t i;
+   size_t j;
+   long long llStart;
+   long long llScalar[3];
+   long long llBatch[3];
+   int iOp;
+   static const char *apcOpNames[3] = {"put", "get", "remove"};
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the throughput of the batch functions.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   pcKeys = (char*)malloc(uCount * MAX_KEY_LENGTH + 1);
+   ppcKeys = (const char**)malloc(uCount * sizeof(char*) + 1);
+   ppvResults = (void**)malloc(uCount * sizeof(void*) + 1);
+   ASSURE(pcKeys != NULL && ppcKeys != NULL && ppvResults != NULL);
+   if (pcKeys == NULL || ppcKeys == NULL || ppvResults == NULL)
+   {
+      free(pcKeys);
+      free(ppcKeys);
+      free(ppvResults);
+      return;
+   }
+
+   for (i = 0; i < BATCH_SIZE; i++)
+      apvValues[i] = acValue;
+
+   /* Shuffle the keys, so that consecutive keys share no cache
+      lines. */
+   for (i = 0; i < uCount; i++)
+   {
+      sprintf(&pcKeys[i * MAX_KEY_LENGTH], "%lu", (unsigned long)i);
+      ppcKeys[i] = &pcKeys[i * MAX_KEY_LENGTH];
+   }
+   for (i = uCount; i > 1; i--)
+   {
+      uState = (uState * 1103515245UL + 12345UL) & 0x7fffffffUL;
+      j = (size_t)(uState % i);
+      pcSwap = ppcKeys[i - 1];
+      ppcKeys[i - 1] = ppcKeys[j];
+      ppcKeys[j] = pcSwap;
+   }
+
+   oScalarTable = SymTable_new();
+   oBatchTable = SymTable_new();
+   ASSURE(oScalarTable != NULL && oBatchTable != NULL);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < uCount; i++)
+      ASSURE(SymTable_put(oScalarTable, ppcKeys[i], acValue));
+   llScalar[0] = getNanoseconds() - llStart;
+
+   llStart = getNanoseconds();
+   for (uFirst = 0; uFirst < uCount; uFirst += uStep)
+   {
+      uStep = uCount - uFirst < BATCH_SIZE ? uCount - uFirst
+         : BATCH_SIZE;
+      uAdded += SymTable_putBatch(oBatchTable, uStep, &ppcKeys[uFirst],
+         apvValues);
+   }
+   llBatch[0] = getNanoseconds() - llStart;
+   ASSURE(uAdded == uCount);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < uCount; i++)
+      ppvResults[i] = SymTable_get(oScalarTable, ppcKeys[i]);
+   llScalar[1] = getNanoseconds() - llStart;
+   for (i = 0; i < uCount; i++)
+      ASSURE(ppvResults[i] == acValue);
+
+   llStart = getNanoseconds();
+   for (uFirst = 0; uFirst < uCount; uFirst += BATCH_SIZE)
+      SymTable_getBatch(oBatchTable,
+         uCount - uFirst < BATCH_SIZE ? uCount - uFirst : BATCH_SIZE,
+         &ppcKeys[uFirst], &ppvResults[uFirst]);
+   llBatch[1] = getNanoseconds() - llStart;
+   for (i = 0; i < uCount; i++)
+      ASSURE(ppvResults[i] == acValue);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < uCount; i++)
+      ppvResults[i] = SymTable_remove(oScalarTable, ppcKeys[i]);
+   llScalar[2] = getNanoseconds() - llStart;
+   for (i = 0; i < uCount; i++)
+      ASSURE(ppvResults[i] == acValue);
+
+   llStart = getNanoseconds();
+   for (uFirst = 0; uFirst < uCount; uFirst += BATCH_SIZE)
+      SymTable_removeBatch(oBatchTable,
+         uCount - uFirst < BATCH_SIZE ? uCount - uFirst : BATCH_SIZE,
+         &ppcKeys[uFirst], &ppvResults[uFirst]);
+   llBatch[2] = getNanoseconds() - llStart;
+   for (i = 0; i < uCount; i++)
+      ASSURE(ppvResults[i] == acValue);
+
+   ASSURE(SymTable_getLength(oScalarTable) == 0);
+   ASSURE(SymTable_getLength(oBatchTable) == 0);
+
+   for (iOp = 0; iOp < 3; iOp++)
+      printf("Elapsed time per %s (%d bindings):  %.1f ns scalar, "
+         "%.1f ns batched\n", apcOpNames[iOp], iBindingCount,
+         uCount == 0 ? 0.0 : (double)llScalar[iOp] / (double)uCount,
+         uCount == 0 ? 0.0 : (double)llBatch[iOp] / (double)uCount);
+   fflush(stdout);
+
+   SymTable_free(oScalarTable);
+   SymTable_free(oBatchTable);
+   free(pcKeys);
+   free(ppcKeys);
+   free(ppvResults);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Visit every binding of a SymTable object of iBindingCount bindings
+   once with SymTable_map and once with SYMTABLE_FOREACH. Write the
+   elapsed time per binding of each to stdout. */
+
+static void testIterThroughput(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   size_t uMapCount = 0;
+   size_t uIterCount = 0;
+   long long llStart;
+   long long llMap;
+   long long llIter;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the throughput of iteration.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+   }
+
+   llStart = getNanoseconds();
+   SymTable_map(oSymTable, countBinding, &uMapCount);
+   llMap = getNanoseconds() - llStart;
+   ASSURE(uMapCount == (size_t)iBindingCount);
+
+   llStart = getNanoseconds();
+   SYMTABLE_FOREACH(oSymTable, &sIter)
+      uIterCount += SymTable_iterValue(&sIter) == acValue;
+   llIter = getNanoseconds() - llStart;
+   ASSURE(uIterCount == (size_t)iBindingCount);
+
+   printf("Elapsed time per binding (%d bindings):  %.1f ns map, "
+      "%.1f ns iterator\n", iBindingCount,
+      iBindingCount == 0 ? 0.0 : (double)llMap / iBindingCount,
+      iBindingCount == 0 ? 0.0 : (double)llIter / iBindingCount);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Mark the binding whose value pvValue points to a char by setting
+   that char to 1, checking that it was not already set. */
+
+static void markBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+
+   (void)pvExtra;
+   ASSURE(*(char*)pvValue == 0);
+   *(char*)pvValue = 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the number that the key pcKey spells to the long that
+   pvAccumulator points to. */
+
+static void sumBinding(const char *pcKey, void *pvValue,
+   void *pvAccumulator)
+{
+   assert(pcKey != NULL);
+   assert(pvAccumulator != NULL);
+
+   (void)pvValue;
+   *(long*)pvAccumulator += atol(pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the long that pvOther points to to the long that pvAccumulator
+   points to. */
+
+static void mergeSum(void *pvAccumulator, void *pvOther)
+{
+   assert(pvAccumulator != NULL);
+   assert(pvOther != NULL);
+
+   *(long*)pvAccumulator += *(long*)pvOther;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_mapParallel() and SymTable_mapReduce() functions
+   on a SymTable object of iBindingCount bindings with several thread
+   counts, and time SymTable_mapReduce() against SymTable_map(). Write
+   the elapsed time per binding of each to stdout. */
+
+static void testMapParallel(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {MAX_THREAD_COUNT = 100};
+
+   static const int aiThreadCounts[] = {1, 2, 3, 8, MAX_THREAD_COUNT};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcMarks;
+   long alSums[MAX_THREAD_COUNT];
+   void *apvSums[MAX_THREAD_COUNT];
+   long lExpected;
+   long long llStart;
+   long long llSerial;
+   long long llParallel;
+   size_t uCount;
+   size_t i;
+   int iThreadCount;
+   int iSuccessful;
+   int iRun;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapParallel() and SymTable_mapReduce() "
+      "functions.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   uCount = (size_t)iBindingCount;
+   pcMarks = (char*)calloc(uCount + 1, 1);
+   ASSURE(pcMarks != NULL);
+   if (pcMarks == NULL) return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   lExpected = 0;
+   for (i = 0; i < uCount; i++)
+   {
+      sprintf(acKey, "%d", (int)i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &pcMarks[i]);
+      ASSURE(iSuccessful);
+      lExpected += (long)i;
+   }
+
+   for (iRun = 0; iRun < (int)(sizeof(aiThreadCounts)
+           / sizeof(aiThreadCounts[0])); iRun++)
+   {
+      iThreadCount = aiThreadCounts[iRun];
+
+      /* Every binding must be applied exactly once. */
+      for (i = 0; i < uCount; i++)
+         pcMarks[i] = 0;
+      SymTable_mapParallel(oSymTable, markBinding, NULL, iThreadCount);
+      for (i = 0; i < uCount; i++)
+         ASSURE(pcMarks[i] == 1);
+
+      for (i = 0; i < (size_t)iThreadCount; i++)
+      {
+         alSums[i] = 0;
+         apvSums[i] = &alSums[i];
+      }
+      SymTable_mapReduce(oSymTable, sumBinding, mergeSum, apvSums,
+         iThreadCount);
+      ASSURE(alSums[0] == lExpected);
+   }
+
+   alSums[0] = 0;
+   llStart = getNanoseconds();
+   SymTable_map(oSymTable, sumBinding, &alSums[0]);
+   llSerial = getNanoseconds() - llStart;
+   ASSURE(alSums[0] == lExpected);
+
+   for (i = 0; i < 4; i++)
+   {
+      alSums[i] = 0;
+      apvSums[i] = &alSums[i];
+   }
+   llStart = getNanoseconds();
+   SymTable_mapReduce(oSymTable, sumBinding, mergeSum, apvSums, 4);
+   llParallel = getNanoseconds() - llStart;
+   ASSURE(alSums[0] == lExpected);
+
+   printf("Elapsed time per binding (%d bindings):  %.1f ns map, "
+      "%.1f ns mapReduce on 4 threads\n", iBindingCount,
+      uCount == 0 ? 0.0 : (double)llSerial / (double)uCount,
+      uCount == 0 ? 0.0 : (double)llParallel / (double)uCount);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(pcMarks);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the SymTable ADT.  Write the output of the tests to stdout.
    As always, argc is the command-line argument count, argv contains
    the command-line arguments, and argv[0] is the name of the
@@ -951,15 +2547,33 @@ int main(int argc, char *argv[])
    testBasics();
    testKeyComparison();
    testKeyOwnership();
+   testKeyBorrowing();
    testRemove();
+   testFindOrInsert();
+   testBatch();
    testMap();
+   testIter();
    testEmptyTable();
    testEmptyKey();
    testNullValue();
    testLongKey();
+   testKeyLengths();
+   testKeySlices();
+   testReorder();
+   testChurn();
    testTableOfTables();
-   testCollisions();
+   testCollisions(SymHash_compat);
+   testCollisions(hashToZero);
    testLargeTable(iBindingCount);
+   testShrink(iBindingCount);
+   testPutLatency(iBindingCount);
+   testSkewedLookups(iBindingCount);
+   testSmallTables(iBindingCount);
+   testMissThroughput(iBindingCount);
+   testNamespacedKeys(iBindingCount);
+   testBatchThroughput(iBindingCount);
+   testIterThroughput(iBindingCount);
+   testMapParallel(iBindingCount);
 
    printf("------------------------------------------------------\n");
    printf("End of %s.\n", argv[0]);
@@ -0,0 +1,515 @@
+/*--------------------------------------------------------------------*/
+/* testsymtabletyped.c                                                */
+/*--------------------------------------------------------------------*/
+
+/* Request POSIX declarations, for clock_gettime. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtabledefine.h"
+#include "symtableint.h"
+#include "symhash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time of the monotonic clock in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Player is the small struct that the tables below store inline. */
+
+struct Player
+{
+   int iNumber;
+   char acPosition[16];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of the string pcKey. */
+
+static size_t hashString(const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymHash_fast(pcKey, strlen(pcKey));
+}
+
+#define EQUAL_STRINGS(pcKey1, pcKey2) (strcmp(pcKey1, pcKey2) == 0)
+#define EQUAL_LONGS(lKey1, lKey2) ((lKey1) == (lKey2))
+#define HASH_LONG(lKey) SymHash_word((unsigned long long)(lKey))
+#define HASH_TO_ZERO(lKey) ((void)(lKey), (size_t)0)
+
+/* PlayerTable maps borrowed strings to Players; LongTable maps longs
+   to Players; ZeroTable is LongTable with every key in one chain. */
+SYMTABLE_DEFINE(PlayerTable, const char *, struct Player, hashString,
+   EQUAL_STRINGS)
+SYMTABLE_DEFINE(LongTable, long, struct Player, HASH_LONG, EQUAL_LONGS)
+SYMTABLE_DEFINE(ZeroTable, long, long, HASH_TO_ZERO, EQUAL_LONGS)
+
+/*--------------------------------------------------------------------*/
+
+/* Return a Player with number iNumber and position pcPosition. */
+
+static struct Player makePlayer(int iNumber, const char *pcPosition)
+{
+   struct Player sPlayer;
+
+   assert(pcPosition != NULL);
+   assert(strlen(pcPosition) < sizeof(sPlayer.acPosition));
+
+   sPlayer.iNumber = iNumber;
+   strcpy(sPlayer.acPosition, pcPosition);
+   return sPlayer;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the most basic functions of a generated table. */
+
+static void testBasics(void)
+{
+   PlayerTable_T oTable;
+   struct Player *psPlayer;
+   struct Player sOld;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the most basic generated table functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = PlayerTable_new();
+   ASSURE(oTable != NULL);
+
+   iSuccessful = PlayerTable_put(oTable, "Jeter",
+      makePlayer(2, "Shortstop"));
+   ASSURE(iSuccessful);
+   iSuccessful = PlayerTable_put(oTable, "Mantle",
+      makePlayer(7, "Center Field"));
+   ASSURE(iSuccessful);
+   iSuccessful = PlayerTable_put(oTable, "Gehrig",
+      makePlayer(4, "First Base"));
+   ASSURE(iSuccessful);
+   iSuccessful = PlayerTable_put(oTable, "Ruth",
+      makePlayer(3, "Right Field"));
+   ASSURE(iSuccessful);
+   uLength = PlayerTable_getLength(oTable);
+   ASSURE(uLength == 4);
+
+   /* Try to insert duplicates of the first and last keys. */
+   iSuccessful = PlayerTable_put(oTable, "Jeter",
+      makePlayer(7, "Center Field"));
+   ASSURE(! iSuccessful);
+   iSuccessful = PlayerTable_put(oTable, "Ruth",
+      makePlayer(7, "Center Field"));
+   ASSURE(! iSuccessful);
+   uLength = PlayerTable_getLength(oTable);
+   ASSURE(uLength == 4);
+
+   ASSURE(PlayerTable_contains(oTable, "Jeter"));
+   ASSURE(PlayerTable_contains(oTable, "Ruth"));
+   ASSURE(! PlayerTable_contains(oTable, "Clemens"));
+
+   psPlayer = PlayerTable_get(oTable, "Jeter");
+   ASSURE(psPlayer != NULL);
+   ASSURE(psPlayer != NULL && psPlayer->iNumber == 2);
+   ASSURE(psPlayer != NULL
+      && strcmp(psPlayer->acPosition, "Shortstop") == 0);
+   psPlayer = PlayerTable_get(oTable, "Gehrig");
+   ASSURE(psPlayer != NULL && psPlayer->iNumber == 4);
+   ASSURE(PlayerTable_get(oTable, "Maris") == NULL);
+
+   /* Values live in the table, so they can be changed in place. */
+   psPlayer = PlayerTable_get(oTable, "Ruth");
+   ASSURE(psPlayer != NULL);
+   if (psPlayer != NULL) psPlayer->iNumber = 5;
+   psPlayer = PlayerTable_get(oTable, "Ruth");
+   ASSURE(psPlayer != NULL && psPlayer->iNumber == 5);
+
+   iSuccessful = PlayerTable_replace(oTable, "Mantle",
+      makePlayer(4, "First Base"), &sOld);
+   ASSURE(iSuccessful);
+   ASSURE(sOld.iNumber == 7);
+   ASSURE(strcmp(sOld.acPosition, "Center Field") == 0);
+   psPlayer = PlayerTable_get(oTable, "Mantle");
+   ASSURE(psPlayer != NULL
+      && strcmp(psPlayer->acPosition, "First Base") == 0);
+   iSuccessful = PlayerTable_replace(oTable, "Clemens",
+      makePlayer(4, "First Base"), NULL);
+   ASSURE(! iSuccessful);
+   uLength = PlayerTable_getLength(oTable);
+   ASSURE(uLength == 4);
+
+   PlayerTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the remove function of a generated table. */
+
+static void testRemove(void)
+{
+   PlayerTable_T oTable;
+   struct Player sOld;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the generated remove function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = PlayerTable_new();
+   ASSURE(oTable != NULL);
+
+   ASSURE(PlayerTable_put(oTable, "Jeter", makePlayer(2, "Shortstop")));
+   ASSURE(PlayerTable_put(oTable, "Mantle", makePlayer(7, "Center")));
+   ASSURE(PlayerTable_put(oTable, "Gehrig", makePlayer(4, "First")));
+   ASSURE(PlayerTable_put(oTable, "Ruth", makePlayer(3, "Right")));
+
+   iSuccessful = PlayerTable_remove(oTable, "Jeter", &sOld);
+   ASSURE(iSuccessful);
+   ASSURE(sOld.iNumber == 2);
+   ASSURE(PlayerTable_getLength(oTable) == 3);
+   ASSURE(! PlayerTable_contains(oTable, "Jeter"));
+
+   iSuccessful = PlayerTable_remove(oTable, "Ruth", NULL);
+   ASSURE(iSuccessful);
+   ASSURE(PlayerTable_getLength(oTable) == 2);
+   ASSURE(! PlayerTable_contains(oTable, "Ruth"));
+
+   iSuccessful = PlayerTable_remove(oTable, "Clemens", &sOld);
+   ASSURE(! iSuccessful);
+   iSuccessful = PlayerTable_remove(oTable, "Ruth", &sOld);
+   ASSURE(! iSuccessful);
+   ASSURE(PlayerTable_getLength(oTable) == 2);
+   ASSURE(PlayerTable_contains(oTable, "Mantle"));
+   ASSURE(PlayerTable_contains(oTable, "Gehrig"));
+
+   PlayerTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the number of the Player that psPlayer points to into the int
+   that pvExtra points to. */
+
+static void sumNumbers(const char *pcKey, struct Player *psPlayer,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(psPlayer != NULL);
+   assert(pvExtra != NULL);
+
+   *(int*)pvExtra += psPlayer->iNumber;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Multiply the number of the Player that psPlayer points to by 10. */
+
+static void scaleNumber(const char *pcKey, struct Player *psPlayer,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(psPlayer != NULL);
+
+   (void)pvExtra;
+   psPlayer->iNumber *= 10;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the map function of a generated table, and the empty table. */
+
+static void testMap(void)
+{
+   PlayerTable_T oTable;
+   int iSum = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the generated map function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = PlayerTable_new();
+   ASSURE(oTable != NULL);
+
+   PlayerTable_map(oTable, sumNumbers, &iSum);
+   ASSURE(iSum == 0);
+   ASSURE(PlayerTable_getLength(oTable) == 0);
+   ASSURE(PlayerTable_get(oTable, "") == NULL);
+   ASSURE(! PlayerTable_remove(oTable, "", NULL));
+
+   ASSURE(PlayerTable_put(oTable, "Jeter", makePlayer(2, "Shortstop")));
+   ASSURE(PlayerTable_put(oTable, "Mantle", makePlayer(7, "Center")));
+   ASSURE(PlayerTable_put(oTable, "", makePlayer(1, "Empty")));
+
+   PlayerTable_map(oTable, sumNumbers, &iSum);
+   ASSURE(iSum == 10);
+
+   /* The function may change the values it is given. */
+   PlayerTable_map(oTable, scaleNumber, NULL);
+   iSum = 0;
+   PlayerTable_map(oTable, sumNumbers, &iSum);
+   ASSURE(iSum == 100);
+
+   PlayerTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a generated table under repeated removal and insertion, and
+   a generated table whose keys all collide. */
+
+static void testChurnAndCollisions(void)
+{
+   enum {KEY_COUNT = 600, ROUND_COUNT = 3, COLLIDING_COUNT = 50};
+
+   LongTable_T oTable;
+   ZeroTable_T oZeroTable;
+   struct Player *psPlayer;
+   long lOld;
+   long *plValue;
+   int i;
+   int iRound;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing generated tables under churn and collisions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = LongTable_new();
+   ASSURE(oTable != NULL);
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = iRound % 2; i < KEY_COUNT; i += 2)
+         ASSURE(LongTable_put(oTable, (long)i * 1000 + iRound,
+            makePlayer(i, "Bench")));
+      ASSURE(LongTable_getLength(oTable) == KEY_COUNT / 2);
+      for (i = iRound % 2; i < KEY_COUNT; i += 2)
+      {
+         psPlayer = LongTable_get(oTable, (long)i * 1000 + iRound);
+         ASSURE(psPlayer != NULL && psPlayer->iNumber == i);
+         ASSURE(LongTable_remove(oTable, (long)i * 1000 + iRound,
+            NULL));
+         ASSURE(! LongTable_contains(oTable,
+            (long)i * 1000 + iRound));
+      }
+      ASSURE(LongTable_getLength(oTable) == 0);
+   }
+   LongTable_free(oTable);
+
+   oZeroTable = ZeroTable_new();
+   ASSURE(oZeroTable != NULL);
+   for (i = 0; i < COLLIDING_COUNT; i++)
+      ASSURE(ZeroTable_put(oZeroTable, i, -i));
+   for (i = 0; i < COLLIDING_COUNT; i += 3)
+   {
+      ASSURE(ZeroTable_remove(oZeroTable, i, &lOld));
+      ASSURE(lOld == -i);
+   }
+   for (i = 0; i < COLLIDING_COUNT; i++)
+   {
+      plValue = ZeroTable_get(oZeroTable, i);
+      if (i % 3 == 0)
+         ASSURE(plValue == NULL);
+      else
+         ASSURE(plValue != NULL && *plValue == -i);
+   }
+   ZeroTable_free(oZeroTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a generated table, checking its
+   length as it grows, then get and remove each of them. Write the
+   elapsed time to stdout. */
+
+static void testLargeTable(int iBindingCount)
+{
+   LongTable_T oTable;
+   struct Player *psPlayer;
+   long long llStart;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a potentially large generated table.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   llStart = getNanoseconds();
+   oTable = LongTable_new();
+   ASSURE(oTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ASSURE(LongTable_put(oTable, i, makePlayer(i, "Bench")));
+      ASSURE(LongTable_getLength(oTable) == (size_t)(i + 1));
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      psPlayer = LongTable_get(oTable, i);
+      ASSURE(psPlayer != NULL && psPlayer->iNumber == i);
+   }
+   for (i = iBindingCount - 1; i >= 0; i--)
+      ASSURE(LongTable_remove(oTable, i, NULL));
+   ASSURE(LongTable_getLength(oTable) == 0);
+   LongTable_free(oTable);
+
+   printf("Elapsed time:  %.3f seconds\n",
+      (double)(getNanoseconds() - llStart) / 1e9);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up each of iBindingCount Players by integer key, first in a
+   SymTableInt whose values point to separately allocated Players and
+   then in a generated table that stores the Players inline, summing a
+   field of each. Write the elapsed time per lookup to stdout. Storing
+   the Players inline saves a cache miss per lookup only once the
+   Players no longer fit in the caches; at 20000 bindings, the two
+   times are about equal. */
+
+static void testLookupCost(int iBindingCount)
+{
+   enum {PASS_COUNT = 4};
+
+   SymTableInt_T oSymTableInt;
+   LongTable_T oTable;
+   struct Player **ppsPlayers;
+   struct Player *psPlayer;
+   long long llStart;
+   long long llPointer;
+   long long llInline;
+   long lSum1 = 0;
+   long lSum2 = 0;
+   int iPass;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the cost of looking up struct values.\n");
+   printf("No output except elapsed time should appear here:\n");
+   fflush(stdout);
+
+   if (iBindingCount == 0) return;
+
+   ppsPlayers = (struct Player**)
+      malloc((size_t)iBindingCount * sizeof(struct Player*));
+   ASSURE(ppsPlayers != NULL);
+   if (ppsPlayers == NULL) return;
+
+   oSymTableInt = SymTableInt_new();
+   oTable = LongTable_new();
+   ASSURE(oSymTableInt != NULL && oTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ppsPlayers[i] = (struct Player*)malloc(sizeof(struct Player));
+      ASSURE(ppsPlayers[i] != NULL);
+      *ppsPlayers[i] = makePlayer(i, "Bench");
+      ASSURE(SymTableInt_put(oSymTableInt, i, ppsPlayers[i]));
+      ASSURE(LongTable_put(oTable, i, *ppsPlayers[i]));
+   }
+
+   /* Look the keys up in a scattered order, as a workload would. */
+   llStart = getNanoseconds();
+   for (iPass = 0; iPass < PASS_COUNT; iPass++)
+      for (i = 0; i < iBindingCount; i++)
+      {
+         psPlayer = (struct Player*)SymTableInt_get(oSymTableInt,
+            (long)(((size_t)i * 40503u) % (size_t)iBindingCount));
+         lSum1 += psPlayer->iNumber;
+      }
+   llPointer = getNanoseconds() - llStart;
+
+   llStart = getNanoseconds();
+   for (iPass = 0; iPass < PASS_COUNT; iPass++)
+      for (i = 0; i < iBindingCount; i++)
+      {
+         psPlayer = LongTable_get(oTable,
+            (long)(((size_t)i * 40503u) % (size_t)iBindingCount));
+         lSum2 += psPlayer->iNumber;
+      }
+   llInline = getNanoseconds() - llStart;
+   ASSURE(lSum1 == lSum2);
+
+   printf("Elapsed time per lookup:  %.1f ns by pointer, "
+      "%.1f ns inline\n",
+      (double)llPointer / ((double)iBindingCount * PASS_COUNT),
+      (double)llInline / ((double)iBindingCount * PASS_COUNT));
+   fflush(stdout);
+
+   for (i = 0; i < iBindingCount; i++)
+      free(ppsPlayers[i]);
+   free(ppsPlayers);
+   SymTableInt_free(oSymTableInt);
+   LongTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the tables that SYMTABLE_DEFINE generates. As the first
+   command-line argument, argv[1], accept the number of bindings that
+   the large tables should hold. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
+   {
+      fprintf(stderr, "bindingcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testRemove();
+   testMap();
+   testChurnAndCollisions();
+   testLargeTable(iBindingCount);
+   testLookupCost(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}